@@ -0,0 +1,231 @@
+// Parallel Apply Permutation: gather and scatter of a column by a permutation of indexes, such as one returned by argsort,
+// both not-in-place and in-place
+
+#ifndef _ApplyPermutation_h
+#define _ApplyPermutation_h
+
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#if defined(_M_X64) || defined(_M_IX86)
+#include <xmmintrin.h>
+#endif
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "SmallParallel.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // How many elements ahead the random-access side of gather and scatter is prefetched
+    const size_t PermutationPrefetchDistance = 16;
+
+    inline void permutation_prefetch(const void* p)
+    {
+#if defined(_MSC_VER)
+#if defined(_M_X64) || defined(_M_IX86)
+        _mm_prefetch((const char*)p, _MM_HINT_T0);
+#endif
+#else
+        __builtin_prefetch(p);
+#endif
+    }
+
+    // Runs f(startIndex, endIndex) over blocks of [0, size) in parallel
+    template< class _Function >
+    inline void permutation_for_each_block(size_t size, size_t blockSize, _Function f)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t startIndex = 0; startIndex < size; startIndex += blockSize)
+        {
+            size_t endIndex = std::min(startIndex + blockSize, size);       // non-inclusive
+            g.run([=, &f] { f(startIndex, endIndex); });
+        }
+        g.wait();
+    }
+
+    // Gather: dst[i] = src[perm[i]]
+    // Each task processes a block of perm and dst sequentially, which keeps the pages of the sequential streams few and resident in the TLB,
+    // while the random reads of src are prefetched a distance ahead.
+    template< class _Type, class _Index >
+    inline void gather_par(const _Type* src, const _Index* perm, size_t size, _Type* dst, size_t parallelThreshold = 16 * 1024)
+    {
+        permutation_for_each_block(size, parallelThreshold, [&](size_t startIndex, size_t endIndex) {
+            size_t prefetchEnd = endIndex > PermutationPrefetchDistance ? std::max(endIndex - PermutationPrefetchDistance, startIndex) : startIndex;
+            size_t i = startIndex;
+            for (; i < prefetchEnd; i++)
+            {
+                permutation_prefetch(src + perm[i + PermutationPrefetchDistance]);
+                dst[i] = src[perm[i]];
+            }
+            for (; i < endIndex; i++)
+                dst[i] = src[perm[i]];
+        });
+    }
+
+    // Scatter: dst[perm[i]] = src[i], which is the inverse of gather
+    // Each task processes a block of src and perm sequentially, while the random writes to dst are prefetched a distance ahead.
+    template< class _Type, class _Index >
+    inline void scatter_par(const _Type* src, const _Index* perm, size_t size, _Type* dst, size_t parallelThreshold = 16 * 1024)
+    {
+        permutation_for_each_block(size, parallelThreshold, [&](size_t startIndex, size_t endIndex) {
+            size_t prefetchEnd = endIndex > PermutationPrefetchDistance ? std::max(endIndex - PermutationPrefetchDistance, startIndex) : startIndex;
+            size_t i = startIndex;
+            for (; i < prefetchEnd; i++)
+            {
+                permutation_prefetch(dst + perm[i + PermutationPrefetchDistance]);
+                dst[perm[i]] = src[i];
+            }
+            for (; i < endIndex; i++)
+                dst[perm[i]] = src[i];
+        });
+    }
+
+    // Part of a permutation cycle walked by one task, which ended when the walk reached the start of a part claimed by another task
+    template< class _Type >
+    struct PermutationArc
+    {
+        size_t start;       // first position of this arc
+        size_t end;         // last position of this arc
+        size_t next;        // start of the arc that follows, claimed by another task
+        _Type  value;       // gather: original value at start. scatter: value carried past end, which belongs at next
+    };
+
+    // In-place parallel cycle-following. Each position is claimed in a visited bitset by an atomic OR, by whichever task reaches it first.
+    // A task starts a walk at each unclaimed position of its range and follows the cycle through perm, claiming positions as it goes.
+    // When a walk returns to its start, the whole cycle has been permuted by that task. When a walk reaches a position claimed by another
+    // task, that position must be the start of another task's walk of the same cycle, and the arc fix-up is recorded, to be applied once all tasks are done.
+    template< class _Type, class _Index, bool _Gather >
+    inline void permute_in_place_par(_Type* a, const _Index* perm, size_t size)
+    {
+        if (size < 2)
+            return;
+        const size_t BitsPerWord = 64;
+        std::vector< std::atomic<unsigned long long> > visited((size + BitsPerWord - 1) / BitsPerWord);
+        auto claim = [&visited](size_t i) -> bool {
+            unsigned long long bit = 1ULL << (i % BitsPerWord);
+            return (visited[i / BitsPerWord].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+        };
+        auto is_claimed = [&visited](size_t i) -> bool {
+            return (visited[i / BitsPerWord].load(std::memory_order_relaxed) >> (i % BitsPerWord)) & 1;
+        };
+
+        size_t processor_count = small_parallel_processor_count();
+        size_t number_of_ranges = std::max(processor_count, (size_t)1) * 4;
+        number_of_ranges = std::max(std::min(number_of_ranges, size / (64 * 1024)), (size_t)1);
+        size_t range_size = (size + number_of_ranges - 1) / number_of_ranges;
+        std::vector< std::vector< PermutationArc<_Type> > > arcs(number_of_ranges);
+
+        permutation_for_each_block(size, range_size, [&](size_t startIndex, size_t endIndex) {
+            std::vector< PermutationArc<_Type> >& arcs_of_range = arcs[startIndex / range_size];
+            for (size_t start = startIndex; start < endIndex; start++)
+            {
+                if ((size_t)perm[start] == start || is_claimed(start) || !claim(start))
+                    continue;
+                _Type value = a[start];
+                size_t j = start;
+                while (true)
+                {
+                    size_t k = (size_t)perm[j];
+                    permutation_prefetch(a + k);
+                    permutation_prefetch(perm + k);
+                    if (k == start)
+                    {
+                        if (_Gather) a[j] = value;
+                        else         a[k] = value;
+                        break;
+                    }
+                    if (!claim(k))
+                    {
+                        arcs_of_range.push_back(PermutationArc<_Type>{ start, j, k, value });
+                        break;
+                    }
+                    if (_Gather) a[j] = a[k];
+                    else         std::swap(value, a[k]);
+                    j = k;
+                }
+            }
+        });
+
+        std::vector< PermutationArc<_Type> > all_arcs;
+        for (auto& arcs_of_range : arcs)
+            all_arcs.insert(all_arcs.end(), arcs_of_range.begin(), arcs_of_range.end());
+        if (_Gather)
+        {
+            // the last position of each arc takes the original value at the start of the arc that follows it
+            std::sort(all_arcs.begin(), all_arcs.end(), [](const PermutationArc<_Type>& x, const PermutationArc<_Type>& y) { return x.start < y.start; });
+            for (auto& arc : all_arcs)
+            {
+                auto following = std::lower_bound(all_arcs.begin(), all_arcs.end(), arc.next,
+                                                  [](const PermutationArc<_Type>& x, size_t start) { return x.start < start; });
+                a[arc.end] = following->value;
+            }
+        }
+        else
+        {
+            // the value carried past the end of each arc goes to the start of the arc that follows it
+            for (auto& arc : all_arcs)
+                a[arc.next] = arc.value;
+        }
+    }
+
+    // In-place gather: a[i] = original a[perm[i]]. perm must be a permutation of 0 .. size-1
+    template< class _Type, class _Index >
+    inline void gather_in_place_par(_Type* a, const _Index* perm, size_t size)
+    {
+        permute_in_place_par< _Type, _Index, true >(a, perm, size);
+    }
+
+    // In-place scatter: a[perm[i]] = original a[i]. perm must be a permutation of 0 .. size-1
+    template< class _Type, class _Index >
+    inline void scatter_in_place_par(_Type* a, const _Index* perm, size_t size)
+    {
+        permute_in_place_par< _Type, _Index, false >(a, perm, size);
+    }
+
+    // Reorder a column into the order given by argsort: dst[i] = src[perm[i]]
+    template< class _Type, class _Index >
+    inline void apply_permutation_par(const _Type* src, const _Index* perm, size_t size, _Type* dst)
+    {
+        gather_par(src, perm, size, dst);
+    }
+
+    // Reorder a column in-place into the order given by argsort, using a visited bitset of one bit per element
+    // Cycle-following is a chain of dependent random reads, which is several times slower than the not-in-place gather, and is for when memory is short
+    template< class _Type, class _Index >
+    inline void apply_permutation_par(std::vector<_Type>& a, const std::vector<_Index>& perm)
+    {
+        gather_in_place_par(a.data(), perm.data(), std::min(a.size(), perm.size()));
+    }
+
+    // Gather, scatter and apply permutation, with the threads given by options
+    template< class... _Args >
+    inline decltype(auto) gather_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::gather_par(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) scatter_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::scatter_par(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) apply_permutation_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::apply_permutation_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
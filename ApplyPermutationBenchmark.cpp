@@ -0,0 +1,79 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+
+#include "ArgSort.h"
+#include "ApplyPermutation.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Argsort of a key column, then reordering of a payload column by the permutation: naive serial gather, versus parallel gather, and in-place parallel gather
+int ApplyPermutationBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned> keys(ulongs.size());
+	for (size_t i = 0; i < ulongs.size(); i++)
+		keys[i] = (unsigned)ulongs[i];
+	vector<unsigned long> sorted_reference(ulongs.size());
+	vector<unsigned long> payload(ulongs.size());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		auto startTime = high_resolution_clock::now();
+		vector<size_t> perm = ParallelAlgorithms::argsort_par(keys);
+		auto endTime = high_resolution_clock::now();
+		print_results("Parallel Argsort          ", ulongs.data(), ulongs.size(), startTime, endTime);
+		for (size_t j = 1; j < perm.size(); j++)
+		{
+			if (keys[perm[j - 1]] > keys[perm[j]])
+			{
+				printf("Argsort permutation does not sort the keys\n");
+				exit(1);
+			}
+		}
+
+		startTime = high_resolution_clock::now();
+		for (size_t j = 0; j < ulongs.size(); j++)
+			sorted_reference[j] = ulongs[perm[j]];
+		endTime = high_resolution_clock::now();
+		print_results("Serial Gather             ", sorted_reference.data(), ulongs.size(), startTime, endTime);
+
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::apply_permutation_par(ulongs.data(), perm.data(), ulongs.size(), payload.data());
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Gather           ", payload.data(), ulongs.size(), startTime, endTime);
+		if (!std::equal(payload.begin(), payload.end(), sorted_reference.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), payload.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::apply_permutation_par(payload, perm);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel In-Place Gather  ", payload.data(), ulongs.size(), startTime, endTime);
+		if (!std::equal(payload.begin(), payload.end(), sorted_reference.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	return 0;
+}
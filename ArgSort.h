@@ -0,0 +1,145 @@
+// Parallel Argsort: sort that returns the permutation of indexes that sorts the keys, instead of moving the keys,
+// so that one key column can be used to reorder many other columns
+
+#ifndef _ArgSort_h
+#define _ArgSort_h
+
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "RadixSortLsdParallel.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // Key and its index, ordered by key, with equal keys ordered by index, which makes argsort stable
+    template< class _Key >
+    struct KeyIndexPair
+    {
+        _Key   key;
+        size_t index;
+
+        bool operator< (const KeyIndexPair& other) const { return key < other.key || (!(other.key < key) && index < other.index); }
+        bool operator<=(const KeyIndexPair& other) const { return !(other < *this); }
+    };
+
+    // 32-bit (or narrower) integer and float keys mapped to unsigned integers with the same order, to be sorted by Radix Sort
+    template< class _Key >
+    inline unsigned long argsort_key_to_ordered_bits(_Key key)
+    {
+        if constexpr (std::is_floating_point<_Key>::value)
+        {
+            static_assert(sizeof(_Key) == 4, "only 32-bit floating-point keys can be mapped into 32 bits");
+            unsigned int bits;
+            memcpy(&bits, &key, sizeof(bits));
+            return (bits & 0x80000000u) ? (unsigned long)(~bits) : (unsigned long)(bits | 0x80000000u);   // negatives in reverse order, below positives
+        }
+        else if constexpr (std::is_signed<_Key>::value)
+        {
+            typedef typename std::make_unsigned<_Key>::type _UnsignedKey;
+            return (unsigned long)((_UnsignedKey)key ^ ((_UnsignedKey)1 << (sizeof(_Key) * 8 - 1)));       // flip the sign bit
+        }
+        else
+            return (unsigned long)key;
+    }
+
+    // Runs f(startIndex, endIndex) over quanta of [0, size) in parallel
+    template< class _Function >
+    inline void argsort_for_each_quantum(size_t size, _Function f, size_t parallelThreshold = 64 * 1024)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t startIndex = 0; startIndex < size; startIndex += parallelThreshold)
+        {
+            size_t endIndex = std::min(startIndex + parallelThreshold, size);       // non-inclusive
+            g.run([=, &f] { f(startIndex, endIndex); });
+        }
+        g.wait();
+    }
+
+    // Packed path for keys of 32-bits or fewer, with fewer than 2^32 of them: (key << 32 | index) is sorted as a 64-bit unsigned long by LSD Radix Sort,
+    // skipping the digits of the index, which are already in order
+    template< class _Key >
+    inline void argsort_packed_radix_par(const _Key* keys, size_t size, size_t* indices)
+    {
+        std::vector<unsigned long> packed(size);
+        std::vector<unsigned long> work_buffer(size);
+        argsort_for_each_quantum(size, [&](size_t startIndex, size_t endIndex) {
+            for (size_t i = startIndex; i < endIndex; i++)
+                packed[i] = (argsort_key_to_ordered_bits(keys[i]) << 32) | (unsigned long)i;
+        });
+        SortRadixPar(packed.data(), work_buffer.data(), size, 512 * 1024, 4);     // index is in the lower 4 digits
+        argsort_for_each_quantum(size, [&](size_t startIndex, size_t endIndex) {
+            for (size_t i = startIndex; i < endIndex; i++)
+                indices[i] = (size_t)(packed[i] & 0xffffffffUL);
+        });
+    }
+
+    // Key-index pairs sorted by Parallel Merge Sort, for keys of any comparable type
+    template< class _Key >
+    inline void argsort_pairs_par(const _Key* keys, size_t size, size_t* indices)
+    {
+        std::vector< KeyIndexPair<_Key> > pairs(size);
+        std::vector< KeyIndexPair<_Key> > work_buffer(size);
+        argsort_for_each_quantum(size, [&](size_t startIndex, size_t endIndex) {
+            for (size_t i = startIndex; i < endIndex; i++)
+            {
+                pairs[i].key   = keys[i];
+                pairs[i].index = i;
+            }
+        });
+        parallel_merge_sort_hybrid_rh_2(pairs.data(), (size_t)0, size - 1, work_buffer.data(), false, false);  // index breaks ties, so stable leaf sorting is not needed
+        argsort_for_each_quantum(size, [&](size_t startIndex, size_t endIndex) {
+            for (size_t i = startIndex; i < endIndex; i++)
+                indices[i] = pairs[i].index;
+        });
+    }
+
+    // Stable parallel argsort: fills indices[0 .. size-1] with the permutation that sorts keys, so that keys[indices[0]] <= keys[indices[1]] <= ...
+    // Keys are not modified. 32-bit and narrower integer and float keys use the packed Radix Sort path, when unsigned long is 64-bits
+    // and there are fewer than 2^32 keys. All other keys use the key-index pair Merge Sort path.
+    template< class _Key >
+    inline void argsort_par(const _Key* keys, size_t size, size_t* indices)
+    {
+        if (size == 0)
+            return;
+        constexpr bool packable = sizeof(unsigned long) == 8 && sizeof(_Key) <= 4 && (std::is_integral<_Key>::value || std::is_floating_point<_Key>::value);
+        if constexpr (packable)
+        {
+            if ((unsigned long long)size <= 0xffffffffULL)
+            {
+                argsort_packed_radix_par(keys, size, indices);
+                return;
+            }
+        }
+        argsort_pairs_par(keys, size, indices);
+    }
+
+    template< class _Key >
+    inline std::vector<size_t> argsort_par(const std::vector<_Key>& keys)
+    {
+        std::vector<size_t> indices(keys.size());
+        argsort_par(keys.data(), keys.size(), indices.data());
+        return indices;
+    }
+
+    template< class... _Args >
+    inline decltype(auto) argsort_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::argsort_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
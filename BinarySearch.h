@@ -7,6 +7,7 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 
 // There are several ways to implement a modified binary search for insertion sort.  One way is to compare with the middle array
 // element in the first step.  Another way is to compare with the largest element in the first step and then the smallest element.
@@ -30,15 +31,16 @@
 // It would be cool if the routine worked automagically for the condition of right < left  (i.e. no  elements) - return left
 // It would be cool if the routine worked automagically for the condition of left == right (i.e. one element )
 // This version is borrowed from "Introduction to Algorithms" 3rd edition, p. 799.
-template< class _Type >
-inline size_t my_binary_search( _Type value, const _Type* a, size_t left, size_t right )
+// The order is given by comp, with value <= a[ mid ] being !comp( a[ mid ], value ).
+template< class _Type, class _Compare >
+inline size_t my_binary_search( const _Type& value, const _Type* a, size_t left, size_t right, _Compare comp )
 {
 	size_t low  = left;
 	size_t high = std::max( left, right + 1 );
 	while( low < high )
 	{
 		size_t mid = low + ((high - low) / 2);		// overflow-free average calculation, since high > low is the condition for entering while-loop body
-		if ( value <= a[ mid ] )	high = mid;
+		if ( !comp( a[ mid ], value ) )	high = mid;
 		else						low  = mid + 1;	// because we compared to a[mid] and the value was larger than a[mid].
 													// Thus, the next array element to the right from mid is the next possible
 													// candidate for low, and a[mid] can not possibly be that candidate.
@@ -46,4 +48,10 @@ inline size_t my_binary_search( _Type value, const _Type* a, size_t left, size_t
 	return high;
 }
 
+template< class _Type >
+inline size_t my_binary_search( _Type value, const _Type* a, size_t left, size_t right )
+{
+	return my_binary_search( value, a, left, right, std::less<>() );
+}
+
 #endif	// _BinarySearch_h
@@ -0,0 +1,90 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "ParallelMergeSort.h"
+#include "BoundedBufferMergeSort.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Stable merge sorts with a buffer of N elements, of 1% of N, of sqrt(N), and with no buffer, which shows how much of the speed of the
+// not-in-place merge sort is kept by the bounded buffer, next to the truly in-place merge sort and std::stable_sort
+int BoundedBufferBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	vector<unsigned long> work(ulongs.size());
+	sort(sorted_reference.begin(), sorted_reference.end());
+
+	size_t buffer_sizes[] = { ulongs.size() / 100, (size_t)sqrt((double)ulongs.size()), 0 };
+	char tag[128];
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		auto startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(ulongsCopy.data(), 0, ulongsCopy.size() - 1, work.data(), false);
+		auto endTime = high_resolution_clock::now();
+		print_results("Parallel Merge Sort, buffer of N            ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		for (size_t buffer_size : buffer_sizes)
+		{
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_bounded_buffer_merge_sort(ulongsCopy.data(), 0, ulongsCopy.size() - 1, work.data(), buffer_size);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Parallel Merge Sort, buffer of %-10zu   ", buffer_size);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+		}
+
+		ParallelAlgorithms::MemoryBudget no_memory(0);
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort(ulongsCopy.data(), 0, ulongsCopy.size() - 1, true, no_memory);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Merge Sort, truly in-place         ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		std::stable_sort(ulongsCopy.begin(), ulongsCopy.end());
+		endTime = high_resolution_clock::now();
+		print_results("std::stable_sort                            ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,320 @@
+// Stable parallel merge and merge sort which use an auxiliary buffer of a caller-specified size, such as sqrt(N) or 1% of N, in between
+// the not-in-place merge sort with its buffer of N elements and the truly in-place merge sort, which has no buffer at all
+
+#ifndef _BoundedBufferMergeSort_h
+#define _BoundedBufferMergeSort_h
+
+#include <stddef.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/parallel_invoke.h>
+#endif
+
+#include "SmallParallel.h"
+#include "SortingNetwork.h"
+#include "ParallelRotate.h"
+#include "WorkBufferPool.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    const size_t BoundedBufferParallelThreshold = 32 * 1024;   // merges and sorts smaller than this run serially
+    const size_t BoundedBufferSortThreshold     = 32;          // sorted by Insertion Sort or a sorting network
+    const size_t BoundedBufferSortsPerCore      = 4;           // parallel sorts at the bottom of the parallel recursion, each with its own part of the buffer
+
+    // A bounded buffer size for sorting or merging size elements: the larger of sqrt(size) and 1% of size
+    inline size_t bounded_buffer_size(size_t size)
+    {
+        size_t square_root = (size_t)sqrt((double)size) + 1;
+        return std::min(size, std::max(square_root, size / 100));
+    }
+
+    // Exchanges [first, middle) and [middle, last), through the buffer when either of them fits in it, and by rotate_par otherwise.
+    // Returns the new position of the element at first
+    template< class _Type >
+    inline _Type* rotate_bounded_buffer(_Type* first, _Type* middle, _Type* last, _Type* buffer, size_t buffer_size)
+    {
+        size_t length1 = middle - first;
+        size_t length2 = last - middle;
+        if (length1 == 0 || length2 == 0)
+            return first + length2;
+        if (length2 <= length1 && length2 <= buffer_size)
+        {
+            std::move(middle, last, buffer);
+            std::move_backward(first, middle, last);
+            std::move(buffer, buffer + length2, first);
+        }
+        else if (length1 <= buffer_size)
+        {
+            std::move(first, middle, buffer);
+            std::move(middle, last, first);
+            std::move(buffer, buffer + length1, first + length2);
+        }
+        else
+            rotate_par(first, middle, last, BoundedBufferParallelThreshold);
+        return first + length2;
+    }
+
+    // Stable merge of a[0 .. length1-1] and a[length1 .. length1+length2-1], with the shorter of the two moved into the buffer, which must hold it
+    template< class _Type, class _Compare >
+    inline void merge_through_buffer(_Type* a, size_t length1, size_t length2, _Type* buffer, _Compare comp)
+    {
+        if (length1 <= length2)
+        {
+            _Type* buffer_end = std::move(a, a + length1, buffer);
+            _Type* b     = a + length1;
+            _Type* b_end = b + length2;
+            _Type* buff  = buffer;
+            _Type* dst   = a;
+            while (buff != buffer_end && b != b_end)
+                *dst++ = comp(*b, *buff) ? std::move(*b++) : std::move(*buff++);     // equal elements are taken from the first array first
+            std::move(buff, buffer_end, dst);                                       // the rest of the second array is in place already
+        }
+        else
+        {
+            _Type* buffer_end = std::move(a + length1, a + length1 + length2, buffer);
+            _Type* a_end = a + length1;
+            _Type* dst   = a + length1 + length2;
+            while (buffer_end != buffer && a_end != a)
+                *--dst = comp(*(buffer_end - 1), *(a_end - 1)) ? std::move(*--a_end) : std::move(*--buffer_end);
+            std::move_backward(buffer, buffer_end, dst);
+        }
+    }
+
+    // Stable merge of the array in buffer[0 .. buffer_end-1] with [b, b_end), into dst, which is buffer_end - buffer elements before b
+    template< class _Type, class _Compare >
+    inline void merge_from_buffer(_Type* dst, _Type* buffer, _Type* buffer_end, _Type* b, _Type* b_end, _Compare comp)
+    {
+        while (buffer != buffer_end && b != b_end)
+            *dst++ = comp(*b, *buffer) ? std::move(*b++) : std::move(*buffer++);
+        std::move(buffer, buffer_end, dst);
+    }
+
+    // Stable block merge of [first, middle) and [middle, last), with the blocks of block_size elements and block_size <= buffer_size, as in WikiSort
+    // with its external buffer. The first array, A, is cut into blocks, with an uneven one at its front, and the A blocks are rolled through
+    // the second array, B, by swapping the leftmost A block with the next B block. Once the last B value before the A blocks is not less than
+    // the first value of the next A block, in the order of A, that A block is dropped behind it, the previous A block is merged through
+    // the buffer with the B values after it, and the dropped A block is moved into the buffer for its own merge. Takes a constant number
+    // of passes over the arrays, and (length1 / block_size)^2 steps for finding the next A block, which are few with block_size of sqrt(length1) or more
+    template< class _Type, class _Compare >
+    inline void block_merge_bounded_buffer(_Type* first, _Type* middle, _Type* last, _Type* buffer, size_t buffer_size, size_t block_size, _Compare comp)
+    {
+        size_t length1 = middle - first;
+        _Type* a_start = first + length1 % block_size;     // the A blocks are [a_start, a_end)
+        _Type* a_end   = middle;
+        _Type* b_start = middle;                            // the next B block is [b_start, b_end)
+        _Type* b_end   = middle + std::min(block_size, (size_t)(last - middle));
+        size_t number_of_a_blocks = (a_end - a_start) / block_size;
+
+        // Original index of each A block, in a ring in the order of the blocks in [a_start, a_end), so that the next one is found whatever the values
+        std::unique_ptr<size_t[]> a_block_index(new size_t[number_of_a_blocks]);
+        for (size_t j = 0; j < number_of_a_blocks; j++)
+            a_block_index[j] = j;
+        size_t front = 0, count = number_of_a_blocks, next_a_block = 0;
+
+        _Type* last_a = first;                              // the previous A block, whose values are in the buffer
+        size_t last_a_length = a_start - first;
+        size_t last_b_length = 0;                           // the previous B block is [a_start - last_b_length, a_start)
+        std::move(first, a_start, buffer);
+
+        while (true)
+        {
+            size_t j_next = 0;
+            while (a_block_index[(front + j_next) % number_of_a_blocks] != next_a_block)
+                j_next++;
+            _Type* next_a = a_start + j_next * block_size;
+
+            if ((last_b_length > 0 && !comp(*(a_start - 1), *next_a)) || b_start == b_end)
+            {
+                // drop the next A block behind the B values that are less than its first value
+                _Type* b_split = std::lower_bound(a_start - last_b_length, a_start, *next_a, comp);
+                size_t b_remaining = a_start - b_split;
+                if (j_next > 0)
+                {
+                    std::swap_ranges(a_start, a_start + block_size, next_a);
+                    std::swap(a_block_index[front], a_block_index[(front + j_next) % number_of_a_blocks]);
+                }
+                merge_from_buffer(last_a, buffer, buffer + last_a_length, last_a + last_a_length, b_split, comp);
+
+                std::move(a_start, a_start + block_size, buffer);                          // the buffer now holds the dropped A block
+                std::move(b_split, a_start, a_start + block_size - b_remaining);            // and its place is taken by the rest of the B block
+                last_a = b_split;
+                last_a_length = block_size;
+                last_b_length = b_remaining;
+
+                a_start += block_size;
+                front = (front + 1) % number_of_a_blocks;
+                next_a_block++;
+                if (--count == 0)
+                    break;
+            }
+            else if ((size_t)(b_end - b_start) < block_size)
+            {
+                // move the last B block, which is shorter than the others, in front of the A blocks
+                size_t b_length = b_end - b_start;
+                rotate_bounded_buffer(a_start, a_end, b_end, buffer + block_size, buffer_size - block_size);   // the buffer holds the previous A block
+                last_b_length = b_length;
+                a_start += b_length;
+                a_end   += b_length;
+                b_start = b_end;
+            }
+            else
+            {
+                // roll the leftmost A block to the end of the A blocks, by swapping it with the next B block
+                std::swap_ranges(a_start, a_start + block_size, b_start);
+                a_block_index[(front + count) % number_of_a_blocks] = a_block_index[front];
+                front = (front + 1) % number_of_a_blocks;
+                last_b_length = block_size;
+                a_start += block_size;
+                a_end   += block_size;
+                b_start += block_size;
+                b_end = std::min(b_end + block_size, last);
+            }
+        }
+        merge_from_buffer(last_a, buffer, buffer + last_a_length, last_a + last_a_length, last, comp);
+    }
+
+    // Stable merge of [first, middle) and [middle, last), with buffer_size elements of buffer. Merges with a shorter array than the buffer
+    // are done through it, and those with a first array of no more than buffer_size^2 by a block merge. Larger ones are split at the middle
+    // of their output by a merge path split, and the parts of the two arrays which are on the wrong side of the split are exchanged,
+    // leaving two independent merges of half the size each, in parallel when parallel is set, with the buffer shared between them
+    // in proportion to their sizes
+    template< class _Type, class _Compare >
+    inline void merge_bounded_buffer_inner(_Type* first, _Type* middle, _Type* last, _Type* buffer, size_t buffer_size, _Compare comp, bool parallel)
+    {
+        size_t length1 = middle - first;
+        size_t length2 = last - middle;
+        if (length1 == 0 || length2 == 0 || !comp(*middle, *(middle - 1)))     // already in order
+            return;
+        if (std::min(length1, length2) <= buffer_size)
+        {
+            merge_through_buffer(first, length1, length2, buffer, comp);
+            return;
+        }
+        bool split_for_parallel = parallel && (length1 + length2) >= BoundedBufferParallelThreshold;
+        if (!split_for_parallel && buffer_size > 0 && length1 / buffer_size <= buffer_size)
+        {
+            block_merge_bounded_buffer(first, middle, last, buffer, buffer_size, buffer_size, comp);
+            return;
+        }
+        size_t k = (length1 + length2) / 2;
+        size_t i = small_parallel_merge_split(first, length1, middle, length2, k, comp);    // first k of the merge are first[0 .. i-1] and middle[0 .. k-i-1]
+        _Type* first_cut  = first  + i;
+        _Type* second_cut = middle + (k - i);
+        _Type* new_middle = rotate_bounded_buffer(first_cut, middle, second_cut, buffer, buffer_size);
+
+        if (split_for_parallel)
+        {
+            size_t buffer_size_left = (size_t)((double)buffer_size * (double)k / (double)(length1 + length2));
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            Concurrency::parallel_invoke(
+#else
+            tbb::parallel_invoke(
+#endif
+                [&] { merge_bounded_buffer_inner(first,      first_cut,  new_middle, buffer,                    buffer_size_left,               comp, true); },
+                [&] { merge_bounded_buffer_inner(new_middle, second_cut, last,       buffer + buffer_size_left, buffer_size - buffer_size_left, comp, true); }
+            );
+        }
+        else
+        {
+            merge_bounded_buffer_inner(first,      first_cut,  new_middle, buffer, buffer_size, comp, parallel);
+            merge_bounded_buffer_inner(new_middle, second_cut, last,       buffer, buffer_size, comp, parallel);
+        }
+    }
+
+    // Stable merge of src[l .. m] and src[m+1 .. r], using buffer[0 .. buffer_size-1] as auxiliary memory. buffer_size may be zero
+    template< class _Type, class _Compare = std::less<> >
+    inline void merge_bounded_buffer(_Type* src, size_t l, size_t m, size_t r, _Type* buffer, size_t buffer_size, _Compare comp = _Compare())
+    {
+        if (r <= l || m >= r)
+            return;
+        merge_bounded_buffer_inner(src + l, src + m + 1, src + r + 1, buffer, buffer_size, comp, false);
+    }
+
+    // Parallel stable merge of src[l .. m] and src[m+1 .. r], using buffer[0 .. buffer_size-1] as auxiliary memory. buffer_size may be zero
+    template< class _Type, class _Compare = std::less<> >
+    inline void p_merge_bounded_buffer(_Type* src, size_t l, size_t m, size_t r, _Type* buffer, size_t buffer_size, _Compare comp = _Compare())
+    {
+        if (r <= l || m >= r)
+            return;
+        merge_bounded_buffer_inner(src + l, src + m + 1, src + r + 1, buffer, buffer_size, comp, true);
+    }
+
+    template< class _Type, class _Compare >
+    inline void parallel_bounded_buffer_merge_sort_inner(_Type* first, _Type* last, _Type* buffer, size_t buffer_size, _Compare comp, size_t parallelThreshold)
+    {
+        size_t length = last - first;
+        if (length <= BoundedBufferSortThreshold)
+        {
+            small_sort_hybrid_stable(first, length, comp);
+            return;
+        }
+        _Type* middle = first + length / 2;
+        bool parallel = length >= parallelThreshold;
+        if (parallel)
+        {
+            size_t buffer_size_left = buffer_size / 2;      // each half gets its own part of the buffer, as they are sorted at the same time
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            Concurrency::parallel_invoke(
+#else
+            tbb::parallel_invoke(
+#endif
+                [&] { parallel_bounded_buffer_merge_sort_inner(first,  middle, buffer,                    buffer_size_left,               comp, parallelThreshold); },
+                [&] { parallel_bounded_buffer_merge_sort_inner(middle, last,   buffer + buffer_size_left, buffer_size - buffer_size_left, comp, parallelThreshold); }
+            );
+        }
+        else
+        {
+            parallel_bounded_buffer_merge_sort_inner(first,  middle, buffer, buffer_size, comp, parallelThreshold);
+            parallel_bounded_buffer_merge_sort_inner(middle, last,   buffer, buffer_size, comp, parallelThreshold);
+        }
+        merge_bounded_buffer_inner(first, middle, last, buffer, buffer_size, comp, parallel);
+    }
+
+    // Stable Parallel Merge Sort of src[l .. r], using buffer[0 .. buffer_size-1] as its only auxiliary memory. With a buffer of sqrt(N)
+    // or 1% of N elements, the merges of the upper levels of the recursion are block merges, and the lower levels merge through the buffer.
+    // buffer_size may be zero, which is truly in-place. The buffer is split between the sorts that run in parallel, so parallelThreshold
+    // is raised to leave a few of them per core, each with a part of the buffer in proportion to its part of the array
+    template< class _Type, class _Compare = std::less<> >
+    inline void parallel_bounded_buffer_merge_sort(_Type* src, size_t l, size_t r, _Type* buffer, size_t buffer_size, _Compare comp = _Compare(), size_t parallelThreshold = BoundedBufferParallelThreshold)
+    {
+        if (r <= l)
+            return;
+        parallelThreshold = std::max(parallelThreshold, (r - l + 1) / (BoundedBufferSortsPerCore * small_parallel_processor_count()));
+        parallel_bounded_buffer_merge_sort_inner(src + l, src + r + 1, buffer, buffer_size, comp, parallelThreshold);
+    }
+
+    // Stable Parallel Merge Sort of src[l .. r], with a buffer of buffer_size elements from the work buffer pool, or truly in-place when
+    // it can not be allocated. bounded_buffer_size(r - l + 1) is the default size
+    template< class _Type, class _Compare = std::less<> >
+    inline void parallel_bounded_buffer_merge_sort(_Type* src, size_t l, size_t r, size_t buffer_size, _Compare comp = _Compare())
+    {
+        if (r <= l)
+            return;
+        WorkBuffer<_Type> buffer(std::min(buffer_size, r - l + 1));
+        parallel_bounded_buffer_merge_sort(src, l, r, buffer.data(), buffer ? buffer.size() : 0, comp);
+    }
+
+    template< class _Type >
+    inline void parallel_bounded_buffer_merge_sort(_Type* src, size_t l, size_t r)
+    {
+        if (r <= l)
+            return;
+        parallel_bounded_buffer_merge_sort(src, l, r, bounded_buffer_size(r - l + 1));
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_bounded_buffer_merge_sort(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_bounded_buffer_merge_sort(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
@@ -0,0 +1,255 @@
+// Parallel Columnar Sort: sort of a table held as separate column arrays (struct-of-arrays), by a lexicographic list of fixed-width key columns,
+// with all key and payload columns permuted to match. Uses LSD Radix Sort passes only, with no comparisons.
+
+#ifndef _ColumnarSort_h
+#define _ColumnarSort_h
+
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "RadixSortLsdParallel.h"
+#include "ApplyPermutation.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // One column of a table: an array of number_of_rows fixed-width elements
+    struct SortColumn
+    {
+        void*  data;
+        size_t element_size;        // 1, 2, 4 or 8 bytes for key columns. Any size for payload columns
+        bool   is_signed;           // signed integer, ordered with negatives first
+        bool   is_float;            // IEEE floating-point of 4 or 8 bytes, ordered with negatives first
+    };
+
+    template< class _Type >
+    inline SortColumn make_sort_column(_Type* data)
+    {
+        return SortColumn{ (void*)data, sizeof(_Type), std::is_signed<_Type>::value && std::is_integral<_Type>::value, std::is_floating_point<_Type>::value };
+    }
+
+    // Bits of the element at row i of a key column, as an unsigned integer with the same order as the element
+    inline unsigned long long columnar_sort_ordered_bits(const SortColumn& column, size_t i)
+    {
+        unsigned long long bits;
+        switch (column.element_size)
+        {
+        case 1: bits = ((const unsigned char*     )column.data)[i]; break;
+        case 2: bits = ((const unsigned short*    )column.data)[i]; break;
+        case 4: bits = ((const unsigned int*      )column.data)[i]; break;
+        default: bits = ((const unsigned long long*)column.data)[i]; break;
+        }
+        unsigned long long sign_bit = 1ULL << (column.element_size * 8 - 1);
+        if (column.is_float)
+            return (bits & sign_bit) ? (~bits & (sign_bit | (sign_bit - 1))) : (bits | sign_bit);     // negatives in reverse order, below positives
+        if (column.is_signed)
+            return bits ^ sign_bit;
+        return bits;
+    }
+
+    // Bytes [byte_offset, byte_offset + number_of_bytes) of a key column. Columns wider than an unsigned long are split into several parts
+    struct ColumnarSortKeyPart
+    {
+        size_t   column;
+        unsigned byte_offset;
+        unsigned number_of_bytes;
+    };
+
+    // Packs key parts, listed from the least significant, into radix keys of at most sizeof(unsigned long) bytes, the first packed in the lowest bytes
+    inline std::vector< std::vector<ColumnarSortKeyPart> > columnar_sort_key_groups(const std::vector<SortColumn>& key_columns)
+    {
+        std::vector< std::vector<ColumnarSortKeyPart> > groups;
+        unsigned bytes_in_group = (unsigned)sizeof(unsigned long);
+        for (size_t c = key_columns.size(); c-- > 0; )
+        {
+            size_t element_size = key_columns[c].element_size;
+            if (element_size != 1 && element_size != 2 && element_size != 4 && element_size != 8)
+                throw std::invalid_argument("key columns must have an element_size of 1, 2, 4 or 8 bytes");
+            if ((key_columns[c].is_float) && element_size != 4 && element_size != 8)
+                throw std::invalid_argument("floating-point key columns must have an element_size of 4 or 8 bytes");
+            for (unsigned offset = 0; offset < (unsigned)element_size; )
+            {
+                if (bytes_in_group == (unsigned)sizeof(unsigned long))
+                {
+                    groups.push_back(std::vector<ColumnarSortKeyPart>());
+                    bytes_in_group = 0;
+                }
+                unsigned number_of_bytes = std::min((unsigned)element_size - offset, (unsigned)sizeof(unsigned long) - bytes_in_group);
+                if (number_of_bytes < (unsigned)element_size - offset && bytes_in_group > 0)
+                {
+                    bytes_in_group = (unsigned)sizeof(unsigned long);   // column does not fit in the rest of this group, and goes to the next group whole
+                    continue;
+                }
+                groups.back().push_back(ColumnarSortKeyPart{ c, offset, number_of_bytes });
+                bytes_in_group += number_of_bytes;
+                offset += number_of_bytes;
+            }
+        }
+        return groups;
+    }
+
+    // keys[i] = radix key of a group for row perm[i], or for row i when perm is null. Returns the bits that vary across the keys
+    inline unsigned long columnar_sort_gather_keys(const std::vector<SortColumn>& key_columns, const std::vector<ColumnarSortKeyPart>& group,
+                                                   const size_t* perm, size_t number_of_rows, unsigned long* keys, size_t parallelThreshold)
+    {
+        size_t number_of_blocks = (number_of_rows + parallelThreshold - 1) / parallelThreshold;
+        std::vector<unsigned long> or_of_block(number_of_blocks, 0), and_of_block(number_of_blocks, ~0UL);
+        permutation_for_each_block(number_of_rows, parallelThreshold, [&](size_t startIndex, size_t endIndex) {
+            unsigned long or_of_keys = 0, and_of_keys = ~0UL;
+            for (size_t i = startIndex; i < endIndex; i++)
+            {
+                size_t row = perm ? perm[i] : i;
+                unsigned long key = 0;
+                unsigned shift = 0;
+                for (const ColumnarSortKeyPart& part : group)
+                {
+                    unsigned long long bits = columnar_sort_ordered_bits(key_columns[part.column], row) >> (part.byte_offset * 8);
+                    if (part.number_of_bytes < 8)
+                        bits &= (1ULL << (part.number_of_bytes * 8)) - 1;
+                    key |= (unsigned long)bits << shift;
+                    shift += part.number_of_bytes * 8;
+                }
+                keys[i] = key;
+                or_of_keys  |= key;
+                and_of_keys &= key;
+            }
+            or_of_block[startIndex / parallelThreshold]  = or_of_keys;
+            and_of_block[startIndex / parallelThreshold] = and_of_keys;
+        });
+        unsigned long or_of_keys = 0, and_of_keys = ~0UL;
+        for (size_t b = 0; b < number_of_blocks; b++)
+        {
+            or_of_keys  |= or_of_block[b];
+            and_of_keys &= and_of_block[b];
+        }
+        return or_of_keys ^ and_of_keys;
+    }
+
+    // One stable LSD Radix Sort pass on a digit, moving keys and their row indexes together
+    inline void columnar_sort_permute_pass(const unsigned long* keys, const size_t* perm, unsigned long* keys_out, size_t* perm_out,
+                                           size_t number_of_rows, size_t** startOfBin, size_t workQuantum, size_t numberOfQuantas, unsigned digit)
+    {
+        const unsigned long bitMask = 0xffUL << (digit * 8);
+        const unsigned long shiftRightAmount = digit * 8;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t q = 0; q < numberOfQuantas; q++)
+        {
+            g.run([=] {
+                size_t* startOfBinLoc = startOfBin[q];
+                size_t endIndex = std::min((q + 1) * workQuantum, number_of_rows);
+                for (size_t i = q * workQuantum; i < endIndex; i++)
+                {
+                    size_t outIndex = startOfBinLoc[extractDigit(keys[i], bitMask, shiftRightAmount)]++;
+                    keys_out[outIndex] = keys[i];
+                    perm_out[outIndex] = perm[i];
+                }
+            });
+        }
+        g.wait();
+    }
+
+    // Row order of a table sorted by key_columns, the first being most significant. Stable: rows with equal keys stay in their original order.
+    // Key columns are grouped into radix keys of an unsigned long, least significant group first. For each group the keys are gathered
+    // through the order so far, then sorted by LSD Radix Sort passes, which carry the row indexes along. Digits that are the same in all rows are skipped.
+    inline std::vector<size_t> argsort_columns_par(const std::vector<SortColumn>& key_columns, size_t number_of_rows, size_t parallelThreshold = 64 * 1024)
+    {
+        std::vector<size_t> perm(number_of_rows);
+        for (size_t i = 0; i < number_of_rows; i++)
+            perm[i] = i;
+        if (number_of_rows < 2)
+            return perm;
+
+        std::vector< std::vector<ColumnarSortKeyPart> > groups = columnar_sort_key_groups(key_columns);
+        std::vector<unsigned long> keys(number_of_rows), keys_work(number_of_rows);
+        std::vector<size_t> perm_work(number_of_rows);
+        size_t numberOfQuantas = (number_of_rows + parallelThreshold - 1) / parallelThreshold;
+        bool perm_is_identity = true;
+
+        for (const std::vector<ColumnarSortKeyPart>& group : groups)
+        {
+            unsigned long varying_bits = columnar_sort_gather_keys(key_columns, group, perm_is_identity ? nullptr : perm.data(), number_of_rows, keys.data(), parallelThreshold);
+            for (unsigned digit = 0; digit < (unsigned)sizeof(unsigned long); digit++)
+            {
+                if (((varying_bits >> (digit * 8)) & 0xff) == 0)       // constant digit, which would not change the order
+                    continue;
+                size_t** startOfBin = ComputeStartOfBinsPar<256, 8>(keys.data(), number_of_rows, parallelThreshold, numberOfQuantas, digit);
+                columnar_sort_permute_pass(keys.data(), perm.data(), keys_work.data(), perm_work.data(), number_of_rows, startOfBin, parallelThreshold, numberOfQuantas, digit);
+                keys.swap(keys_work);
+                perm.swap(perm_work);
+                perm_is_identity = false;
+                for (size_t q = 0; q < numberOfQuantas; q++)
+                    delete[] startOfBin[q];
+                delete[] startOfBin;
+            }
+        }
+        return perm;
+    }
+
+    // Reorder a column in place by perm, from the result of argsort_columns_par, using a work buffer of at least number_of_rows * element_size bytes
+    inline void columnar_sort_apply_permutation(const SortColumn& column, const size_t* perm, size_t number_of_rows, unsigned char* work_buffer)
+    {
+        switch (column.element_size)
+        {
+        case 1: gather_par((const unsigned char*     )column.data, perm, number_of_rows, (unsigned char*     )work_buffer); break;
+        case 2: gather_par((const unsigned short*    )column.data, perm, number_of_rows, (unsigned short*    )work_buffer); break;
+        case 4: gather_par((const unsigned int*      )column.data, perm, number_of_rows, (unsigned int*      )work_buffer); break;
+        case 8: gather_par((const unsigned long long*)column.data, perm, number_of_rows, (unsigned long long*)work_buffer); break;
+        default:
+            permutation_for_each_block(number_of_rows, 16 * 1024, [&](size_t startIndex, size_t endIndex) {
+                for (size_t i = startIndex; i < endIndex; i++)
+                    memcpy(work_buffer + i * column.element_size, (const unsigned char*)column.data + perm[i] * column.element_size, column.element_size);
+            });
+        }
+        permutation_for_each_block(number_of_rows * column.element_size, 1024 * 1024, [&](size_t startIndex, size_t endIndex) {
+            memcpy((unsigned char*)column.data + startIndex, work_buffer + startIndex, endIndex - startIndex);
+        });
+    }
+
+    // Sort a table of number_of_rows rows, held as separate column arrays, by key_columns in lexicographic order, the first being most significant.
+    // All key columns and payload columns are permuted to the sorted row order. The sort is stable.
+    // For example, a table ordered by (tenant, ts, seq), carrying a value column:
+    //     sort_columns_par({ make_sort_column(tenant), make_sort_column(ts), make_sort_column(seq) }, { make_sort_column(value) }, number_of_rows);
+    inline void sort_columns_par(const std::vector<SortColumn>& key_columns, const std::vector<SortColumn>& payload_columns, size_t number_of_rows)
+    {
+        if (number_of_rows < 2)
+            return;
+        std::vector<size_t> perm = argsort_columns_par(key_columns, number_of_rows);
+
+        size_t largest_element_size = 0;
+        for (const SortColumn& column : key_columns)     largest_element_size = std::max(largest_element_size, column.element_size);
+        for (const SortColumn& column : payload_columns) largest_element_size = std::max(largest_element_size, column.element_size);
+        std::vector<unsigned long long> work_buffer((number_of_rows * largest_element_size + sizeof(unsigned long long) - 1) / sizeof(unsigned long long));
+
+        for (const SortColumn& column : key_columns)
+            columnar_sort_apply_permutation(column, perm.data(), number_of_rows, (unsigned char*)work_buffer.data());
+        for (const SortColumn& column : payload_columns)
+            columnar_sort_apply_permutation(column, perm.data(), number_of_rows, (unsigned char*)work_buffer.data());
+    }
+
+    template< class... _Args >
+    inline decltype(auto) argsort_columns_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::argsort_columns_par(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) sort_columns_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::sort_columns_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
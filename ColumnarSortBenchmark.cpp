@@ -0,0 +1,74 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+#include <tuple>
+
+#include "ApplyPermutation.h"
+#include "ColumnarSort.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Table of (tenant, ts, seq) key columns and a payload column, sorted lexicographically: parallel stable sort of row indexes with a comparator,
+// then reordering of all columns, versus the Columnar Radix Sort
+int ColumnarSortBenchmark(vector<unsigned long>& ulongs)
+{
+	size_t number_of_rows = ulongs.size();
+	vector<unsigned short>     tenant(number_of_rows), tenant_sorted(number_of_rows);
+	vector<unsigned long long> ts(number_of_rows),     ts_sorted(number_of_rows);
+	vector<unsigned>           seq(number_of_rows),    seq_sorted(number_of_rows);
+	vector<unsigned long>      payload(number_of_rows), payload_sorted(number_of_rows);
+	vector<size_t>             rows(number_of_rows);
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		for (size_t j = 0; j < number_of_rows; j++)
+		{
+			tenant[j]  = (unsigned short)(ulongs[j] % 100);
+			ts[j]      = 1700000000000ULL + (ulongs[j] >> 8) % 1000000;
+			seq[j]     = (unsigned)((ulongs[j] >> 40) % 16);
+			payload[j] = ulongs[j];
+		}
+		auto startTime = high_resolution_clock::now();
+		for (size_t j = 0; j < number_of_rows; j++)
+			rows[j] = j;
+		std::stable_sort(std::execution::par_unseq, rows.begin(), rows.end(), [&](size_t a, size_t b) {
+			return std::make_tuple(tenant[a], ts[a], seq[a]) < std::make_tuple(tenant[b], ts[b], seq[b]);
+		});
+		ParallelAlgorithms::gather_par(tenant.data(),  rows.data(), number_of_rows, tenant_sorted.data());
+		ParallelAlgorithms::gather_par(ts.data(),      rows.data(), number_of_rows, ts_sorted.data());
+		ParallelAlgorithms::gather_par(seq.data(),     rows.data(), number_of_rows, seq_sorted.data());
+		ParallelAlgorithms::gather_par(payload.data(), rows.data(), number_of_rows, payload_sorted.data());
+		auto endTime = high_resolution_clock::now();
+		print_results("Parallel Comparison Table Sort", payload_sorted.data(), number_of_rows, startTime, endTime);
+
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::sort_columns_par({ ParallelAlgorithms::make_sort_column(tenant.data()), ParallelAlgorithms::make_sort_column(ts.data()),
+		                                       ParallelAlgorithms::make_sort_column(seq.data()) },
+		                                     { ParallelAlgorithms::make_sort_column(payload.data()) }, number_of_rows);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Columnar Radix Sort  ", payload.data(), number_of_rows, startTime, endTime);
+		if (!std::equal(payload.begin(), payload.end(), payload_sorted.begin()) || !std::equal(ts.begin(), ts.end(), ts_sorted.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <ratio>
+#include <string>
+#include <vector>
+
+#include "ParallelMergeSort.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+struct ComparatorBenchmarkRecord
+{
+	unsigned long key;
+	unsigned long value;
+};
+
+static bool case_insensitive_less(const std::string& a, const std::string& b)
+{
+	return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+		[](unsigned char x, unsigned char y) { return tolower(x) < tolower(y); });
+}
+
+// Parallel Merge Sort of unsigned longs with the default operator<, with std::less, and with std::greater for descending order,
+// to show that the comparison argument costs nothing for builtin types. Also sorts records by a member through a projection,
+// and strings case-insensitively
+int ComparatorBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs.size());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	vector<unsigned long> work(ulongs.size());
+
+	std::copy(ulongs.begin(), ulongs.end(), sorted_reference.begin());
+	sort(sorted_reference.begin(), sorted_reference.end());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		auto startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(ulongsCopy.data(), 0, ulongsCopy.size() - 1, work.data(), false);
+		auto endTime = high_resolution_clock::now();
+		print_results("Parallel Merge Sort, operator<     ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+		if (sorted_reference != ulongsCopy)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(ulongsCopy.data(), 0, ulongsCopy.size() - 1, work.data(), false, std::less<unsigned long>());
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Merge Sort, std::less     ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+		if (sorted_reference != ulongsCopy)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(ulongsCopy.data(), 0, ulongsCopy.size() - 1, work.data(), false, std::greater<unsigned long>());
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Merge Sort, std::greater  ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+		if (!std::equal(sorted_reference.rbegin(), sorted_reference.rend(), ulongsCopy.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+
+	// Records sorted by key, through a projection
+	vector<ComparatorBenchmarkRecord> records(ulongs.size());
+	vector<ComparatorBenchmarkRecord> recordsWork(ulongs.size());
+	vector<unsigned long> keys(ulongs.size());
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		for (size_t j = 0; j < ulongs.size(); j++)
+			records[j] = ComparatorBenchmarkRecord{ ulongs[j], j };
+		auto startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(records.data(), 0, records.size() - 1, recordsWork.data(), false,
+			std::less<>(), &ComparatorBenchmarkRecord::key);
+		auto endTime = high_resolution_clock::now();
+		for (size_t j = 0; j < records.size(); j++)
+			keys[j] = records[j].key;
+		print_results("Parallel Merge Sort of records by key", keys.data(), keys.size(), startTime, endTime);
+		if (sorted_reference != keys)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+
+	// Strings of mixed case, fewer of them as they are much larger than unsigned longs
+	size_t numberOfStrings = std::min(ulongs.size(), (size_t)1000000);
+	vector<std::string> strings(numberOfStrings);
+	vector<std::string> stringsWork(numberOfStrings);
+	vector<std::string> stringsReference(numberOfStrings);
+	for (size_t j = 0; j < numberOfStrings; j++)
+	{
+		const char* digits = "abcdefghijklmnopABCDEFGHIJKLMNOP";
+		for (unsigned long value = ulongs[j]; value != 0; value /= 32)
+			strings[j] += digits[value % 32];
+	}
+	std::copy(strings.begin(), strings.end(), stringsReference.begin());
+	sort(stringsReference.begin(), stringsReference.end(), case_insensitive_less);
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		vector<std::string> stringsCopy(strings);
+		auto startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(stringsCopy.data(), 0, stringsCopy.size() - 1, stringsWork.data(), false, case_insensitive_less);
+		auto endTime = high_resolution_clock::now();
+		printf("Parallel Merge Sort of strings, case-insensitive: %zu strings, runtime: %f ms\n", numberOfStrings,
+			duration_cast<duration<double, milli>>(endTime - startTime).count());
+		for (size_t j = 0; j < numberOfStrings; j++)
+		{
+			if (case_insensitive_less(stringsCopy[j], stringsReference[j]) || case_insensitive_less(stringsReference[j], stringsCopy[j]))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+		}
+	}
+	return 0;
+}
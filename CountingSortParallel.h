@@ -30,6 +30,7 @@
 
 #include "RadixSortMsdParallel.h"
 #include "FillParallel.h"
+#include "ParallelOptions.h"
 
 using std::chrono::duration;
 using std::chrono::duration_cast;
@@ -332,5 +333,11 @@ namespace ParallelAlgorithms
         counting_sort_parallel_inner< NumberOfBins >(a, 0, a_size, threshold_count, threshold_fill);
 		//counting_sort_parallel_inner< PowerOfTwoRadix >(a, 0, a_size);
 	}
+
+	template< class... _Args >
+	inline decltype(auto) counting_sort_parallel(const ParallelOptions& options, _Args&&... args)
+	{
+		return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::counting_sort_parallel(std::forward<_Args>(args)...); });
+	}
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,454 @@
+// TODO: Replace the dedicated reader/writer threads with asynchronous I/O (io_uring on Linux, overlapped I/O on Windows)
+
+// External-memory (out-of-core) parallel sort for binary files of fixed-width keys, which are larger than system memory
+
+#ifndef _ExternalSort_h
+#define _ExternalSort_h
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <sys/types.h>
+#include <tbb/task_group.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    const size_t ExternalSortSamplesPerRun   = 1024;
+    const size_t ExternalSortMinBufferSize   = 4096;    // elements per read or write buffer, below which the merge is dominated by disk seeks
+    const size_t ExternalSortMaxOpenFiles    = 512;     // files open at once by the merge, well within the default limit of 1024 per process
+
+    // 64-bit file offsets, since the files sorted here are larger than system memory
+    inline int external_sort_seek(FILE* file, unsigned long long byte_offset)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        return _fseeki64(file, (long long)byte_offset, SEEK_SET);
+#else
+        return fseeko(file, (off_t)byte_offset, SEEK_SET);
+#endif
+    }
+
+    inline unsigned long long external_sort_file_size(FILE* file)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        _fseeki64(file, 0, SEEK_END);
+        unsigned long long file_size = (unsigned long long)_ftelli64(file);
+        _fseeki64(file, 0, SEEK_SET);
+#else
+        fseeko(file, 0, SEEK_END);
+        unsigned long long file_size = (unsigned long long)ftello(file);
+        fseeko(file, 0, SEEK_SET);
+#endif
+        return file_size;
+    }
+
+    inline FILE* external_sort_open(const std::string& file_name, const char* mode)
+    {
+        FILE* file = fopen(file_name.c_str(), mode);
+        if (!file)
+            throw std::runtime_error("external sort: unable to open file " + file_name);
+        return file;
+    }
+
+    // File opened by external_sort_open, and closed by the destructor when an exception leaves it open. close() reports whether the
+    // buffered writes reached the file
+    struct ExternalSortFile
+    {
+        FILE* file;
+
+        ExternalSortFile(const std::string& file_name, const char* mode) : file(external_sort_open(file_name, mode)) {}
+        ExternalSortFile(const ExternalSortFile&) = delete;
+        ExternalSortFile& operator=(const ExternalSortFile&) = delete;
+        ~ExternalSortFile()
+        {
+            if (file) fclose(file);
+        }
+        bool close()
+        {
+            bool closed = fclose(file) == 0;
+            file = nullptr;
+            return closed;
+        }
+    };
+
+    // Sort a chunk that has been read into memory: LSD Radix Sort for unsigned long keys, Parallel Merge Sort for all other types
+    template< class _Type >
+    inline void external_sort_chunk(_Type* chunk, _Type* work_buffer, size_t chunk_size)
+    {
+        if (chunk_size == 0)
+            return;
+        if constexpr (std::is_same<_Type, unsigned long>::value)
+            SortRadixPar(chunk, work_buffer, chunk_size);
+        else
+            parallel_merge_sort_hybrid_rh_1(chunk, (size_t)0, chunk_size - 1, work_buffer, false);   // inclusive bounds, result in chunk
+    }
+
+    // Sorted run spilled to disk, along with a sparse sample of its keys, which is kept in memory to split the final merge into independent pieces
+    template< class _Type >
+    struct ExternalSortRun
+    {
+        std::string        file_name;
+        unsigned long long size;            // number of elements
+        size_t             sample_stride;   // sample[i] is the element at index i * sample_stride
+        std::vector<_Type> sample;
+    };
+
+    // Buffered sequential reader of a portion [start, end) of a sorted run
+    template< class _Type >
+    struct ExternalSortRunReader
+    {
+        FILE*              file;
+        std::vector<_Type> buffer;
+        size_t             current;
+        size_t             count;
+        unsigned long long remaining;
+
+        ExternalSortRunReader(const std::string& file_name, unsigned long long start, unsigned long long end, size_t buffer_size)
+            : file(nullptr), buffer(buffer_size), current(0), count(0), remaining(end - start)
+        {
+            if (remaining == 0)
+                return;
+            file = external_sort_open(file_name, "rb");
+            external_sort_seek(file, start * sizeof(_Type));
+        }
+        ~ExternalSortRunReader()
+        {
+            if (file) fclose(file);
+        }
+        // Returns false when the portion of the run has been fully read
+        bool next(_Type& value)
+        {
+            if (current == count)
+            {
+                if (remaining == 0)
+                    return false;
+                size_t to_read = (size_t)std::min((unsigned long long)buffer.size(), remaining);
+                count = fread(buffer.data(), sizeof(_Type), to_read, file);
+                if (count != to_read)
+                    throw std::runtime_error("external sort: short read from a sorted run");
+                remaining -= count;
+                current = 0;
+            }
+            value = buffer[current++];
+            return true;
+        }
+    };
+
+    // Index of the first element of the run that is not less than value (the run is sorted).
+    // The in-memory sample narrows the search down to one sample_stride of the file, which is then binary searched on disk.
+    template< class _Type >
+    inline unsigned long long external_sort_run_lower_bound(const ExternalSortRun<_Type>& run, const _Type& value)
+    {
+        size_t s = std::lower_bound(run.sample.begin(), run.sample.end(), value) - run.sample.begin();
+        if (s == 0)
+            return 0;
+        unsigned long long left  = (unsigned long long)(s - 1) * run.sample_stride + 1;    // sample[s - 1] < value
+        unsigned long long right = std::min((unsigned long long)s * run.sample_stride, run.size);
+        ExternalSortFile run_file(run.file_name, "rb");
+        _Type element;
+        while (left < right)
+        {
+            unsigned long long m = left + (right - left) / 2;
+            external_sort_seek(run_file.file, m * sizeof(_Type));
+            if (fread(&element, sizeof(_Type), 1, run_file.file) != 1)
+                throw std::runtime_error("external sort: short read from a sorted run");
+            if (element < value) left  = m + 1;
+            else                 right = m;
+        }
+        return left;
+    }
+
+    // k-way merge of the [start[k], end[k]) portion of each run into the output file starting at element output_start.
+    // When sample is given, the output elements at multiples of sample_stride are appended to it
+    template< class _Type >
+    inline void external_sort_merge_portion(const std::vector< ExternalSortRun<_Type> >& runs, const std::vector<unsigned long long>& start, const std::vector<unsigned long long>& end,
+                                            const char* output_file_name, unsigned long long output_start, size_t buffer_size,
+                                            std::vector<_Type>* sample = nullptr, size_t sample_stride = 1)
+    {
+        size_t number_of_runs = runs.size();
+        std::vector< std::unique_ptr< ExternalSortRunReader<_Type> > > readers(number_of_runs);
+        for (size_t k = 0; k < number_of_runs; k++)
+            readers[k].reset(new ExternalSortRunReader<_Type>(runs[k].file_name, start[k], end[k], buffer_size));
+
+        // min-heap of the current element of each run, ties resolved by run index to keep equal keys in run order
+        typedef std::pair<_Type, size_t> HeapItem;
+        auto greater = [](const HeapItem& a, const HeapItem& b) { return b.first < a.first || (!(a.first < b.first) && b.second < a.second); };
+        std::priority_queue< HeapItem, std::vector<HeapItem>, decltype(greater) > heap(greater);
+        _Type value;
+        for (size_t k = 0; k < number_of_runs; k++)
+            if (readers[k]->next(value))
+                heap.push(HeapItem(value, k));
+
+        ExternalSortFile output(output_file_name, "r+b");
+        FILE* output_file = output.file;
+        external_sort_seek(output_file, output_start * sizeof(_Type));
+        std::vector<_Type> output_buffer(buffer_size);
+        size_t output_count = 0;
+        unsigned long long output_index = output_start;
+        bool write_failed = false;
+
+        while (!heap.empty())
+        {
+            HeapItem item = heap.top();
+            heap.pop();
+            if (sample && output_index % sample_stride == 0)
+                sample->push_back(item.first);
+            output_index++;
+            output_buffer[output_count++] = item.first;
+            if (output_count == buffer_size)
+            {
+                write_failed |= fwrite(output_buffer.data(), sizeof(_Type), output_count, output_file) != output_count;
+                output_count = 0;
+            }
+            if (readers[item.second]->next(value))
+                heap.push(HeapItem(value, item.second));
+        }
+        if (output_count > 0)
+            write_failed |= fwrite(output_buffer.data(), sizeof(_Type), output_count, output_file) != output_count;
+        write_failed |= !output.close();
+        if (write_failed)
+            throw std::runtime_error(std::string("external sort: unable to write to ") + output_file_name);
+    }
+
+    // Number of runs merged at once: as many as the open file limit allows, and as the memory budget holds read buffers of
+    // ExternalSortMinBufferSize elements for, plus one write buffer, but at least two
+    template< class _Type >
+    inline size_t external_sort_merge_width(size_t memory_budget_in_bytes)
+    {
+        size_t buffers_in_budget = memory_budget_in_bytes / (sizeof(_Type) * ExternalSortMinBufferSize);
+        size_t files = std::min(ExternalSortMaxOpenFiles, buffers_in_budget);     // read files of the runs, plus the output file
+        return files > 3 ? files - 1 : (size_t)2;
+    }
+
+    // Parallel k-way merge of all sorted runs into the output file, which is created, or truncated.
+    // Splitter keys, chosen from the in-memory samples of the runs, divide every run into number_of_portions pieces. Portion j of the output
+    // is then the merge of piece j of every run, and is written at its own offset of the output file, independently of the other portions.
+    // There are only as many portions as the open file limit, and the memory budget with buffers of ExternalSortMinBufferSize elements, allow.
+    // When merged_run is given, its sample is filled in for a later merge of the output file
+    template< class _Type >
+    inline void external_sort_merge_runs(const std::vector< ExternalSortRun<_Type> >& runs, const char* output_file_name, size_t memory_budget_in_bytes,
+                                         ExternalSortRun<_Type>* merged_run = nullptr)
+    {
+        size_t number_of_runs = runs.size();
+        size_t files_per_portion = number_of_runs + 1;
+        size_t number_of_portions = std::min(small_parallel_processor_count(), ExternalSortMaxOpenFiles / files_per_portion);
+        number_of_portions = std::min(number_of_portions, memory_budget_in_bytes / (sizeof(_Type) * ExternalSortMinBufferSize * files_per_portion));
+        number_of_portions = std::max(number_of_portions, (size_t)1);
+
+        std::vector<_Type> all_samples;
+        for (size_t k = 0; k < number_of_runs; k++)
+            all_samples.insert(all_samples.end(), runs[k].sample.begin(), runs[k].sample.end());
+        std::sort(all_samples.begin(), all_samples.end());
+        if (all_samples.size() < number_of_portions)
+            number_of_portions = 1;
+
+        // boundary[j][k] is the index within run k where portion j starts
+        std::vector< std::vector<unsigned long long> > boundary(number_of_portions + 1, std::vector<unsigned long long>(number_of_runs, 0));
+        for (size_t k = 0; k < number_of_runs; k++)
+            boundary[number_of_portions][k] = runs[k].size;
+        for (size_t j = 1; j < number_of_portions; j++)
+        {
+            _Type splitter = all_samples[j * all_samples.size() / number_of_portions];
+            for (size_t k = 0; k < number_of_runs; k++)
+                boundary[j][k] = external_sort_run_lower_bound(runs[k], splitter);
+        }
+
+        // Each portion holds a read buffer for every run, plus one write buffer, all within the memory budget
+        size_t buffer_size = memory_budget_in_bytes / (sizeof(_Type) * number_of_portions * files_per_portion);
+        buffer_size = std::max(buffer_size, (size_t)1);
+
+        ExternalSortFile output(output_file_name, "wb");        // the merge portions write into it at their own offsets
+        if (!output.close())
+            throw std::runtime_error(std::string("external sort: unable to write to ") + output_file_name);
+
+        std::vector< std::vector<_Type> > sample_of_portion(number_of_portions);
+        size_t sample_stride = 1;
+        if (merged_run)
+        {
+            merged_run->size = 0;
+            for (size_t k = 0; k < number_of_runs; k++)
+                merged_run->size += runs[k].size;
+            sample_stride = (size_t)std::max(merged_run->size / ExternalSortSamplesPerRun, (unsigned long long)1);
+        }
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        unsigned long long output_start = 0;
+        for (size_t j = 0; j < number_of_portions; j++)
+        {
+            g.run([&, j, output_start] {
+                external_sort_merge_portion(runs, boundary[j], boundary[j + 1], output_file_name, output_start, buffer_size,
+                                            merged_run ? &sample_of_portion[j] : nullptr, sample_stride);
+            });
+            for (size_t k = 0; k < number_of_runs; k++)
+                output_start += boundary[j + 1][k] - boundary[j][k];
+        }
+        g.wait();
+
+        if (merged_run)
+        {
+            merged_run->file_name     = output_file_name;
+            merged_run->sample_stride = sample_stride;
+            merged_run->sample.clear();
+            for (size_t j = 0; j < number_of_portions; j++)
+                merged_run->sample.insert(merged_run->sample.end(), sample_of_portion[j].begin(), sample_of_portion[j].end());
+        }
+    }
+
+    // Sort a binary file of fixed-width keys, which may be much larger than system memory, placing the result in the output file.
+    // Phase 1: the input file is read in chunks that fit in memory_budget_in_bytes, each chunk is sorted in parallel and spilled to disk as a sorted run.
+    //          Reading of the next chunk and writing of the previous run are done by their own threads, overlapped with sorting of the current chunk.
+    // Phase 2: while there are more runs than external_sort_merge_width() allows to be merged at once, groups of that many runs are merged
+    //          into longer runs. The remaining runs are merged by a parallel k-way merge into the output file.
+    // Sorted runs are temporary files named after temp_file_prefix (output_file_name by default), and are removed when done, or on an exception.
+    // When the input fits within a single chunk, it is sorted in memory and written straight to the output file.
+    template< class _Type >
+    inline void sort_file_external(const char* input_file_name, const char* output_file_name, size_t memory_budget_in_bytes, const char* temp_file_prefix = nullptr)
+    {
+        static_assert(std::is_trivially_copyable<_Type>::value, "external sort requires fixed-width keys, which can be read and written as raw bytes");
+
+        // Three chunk buffers rotate between being read into, sorted and written out, plus one work buffer for the sort
+        size_t chunk_size = memory_budget_in_bytes / (4 * sizeof(_Type));
+        if (chunk_size == 0)
+            throw std::invalid_argument("external sort: memory_budget_in_bytes is too small to hold the sorting buffers");
+        std::string run_prefix = std::string(temp_file_prefix ? temp_file_prefix : output_file_name) + ".run";
+
+        // Files and threads are released by the destructors in reverse order of declaration: threads are joined first,
+        // as they use the chunk buffers and the input file, then the input file is closed, and the run files are removed last
+        struct TempFiles
+        {
+            std::vector<std::string> names;
+            ~TempFiles() { for (const std::string& name : names) remove(name.c_str()); }
+        } temp_files;
+        ExternalSortFile input(input_file_name, "rb");
+        FILE* input_file = input.file;
+        unsigned long long input_size = external_sort_file_size(input_file) / sizeof(_Type);
+
+        std::vector<_Type> chunk[3];
+        for (int c = 0; c < 3; c++)
+            chunk[c].resize((size_t)std::min((unsigned long long)chunk_size, input_size));
+        std::vector<_Type> work_buffer(chunk[0].size());
+
+        std::vector< ExternalSortRun<_Type> > runs;
+        size_t      count[3] = { 0, 0, 0 };
+        bool        write_failed = false;
+        std::thread reader, writer;
+        struct JoinThreads
+        {
+            std::thread& reader;
+            std::thread& writer;
+            ~JoinThreads()
+            {
+                if (reader.joinable()) reader.join();
+                if (writer.joinable()) writer.join();
+            }
+        } join_threads{ reader, writer };
+
+        int current = 0;
+        count[current] = fread(chunk[current].data(), sizeof(_Type), chunk[current].size(), input_file);
+        unsigned long long total_read = count[current];
+
+        while (count[current] > 0)
+        {
+            int next = (current + 1) % 3;
+            bool more_input = total_read < input_size;
+            if (more_input)     // read the next chunk while sorting the current one
+                reader = std::thread([&, next] { count[next] = fread(chunk[next].data(), sizeof(_Type), chunk[next].size(), input_file); });
+            else
+                count[next] = 0;
+
+            external_sort_chunk(chunk[current].data(), work_buffer.data(), count[current]);
+
+            if (runs.empty() && !more_input)    // the whole input fit in one chunk
+            {
+                ExternalSortFile output(output_file_name, "wb");
+                bool failed = fwrite(chunk[current].data(), sizeof(_Type), count[current], output.file) != count[current];
+                failed |= !output.close();
+                if (failed)
+                    throw std::runtime_error(std::string("external sort: unable to write to ") + output_file_name);
+                return;
+            }
+
+            ExternalSortRun<_Type> run;
+            run.file_name     = run_prefix + std::to_string(runs.size());
+            run.size          = count[current];
+            run.sample_stride = std::max(count[current] / ExternalSortSamplesPerRun, (size_t)1);
+            for (size_t i = 0; i < count[current]; i += run.sample_stride)
+                run.sample.push_back(chunk[current][i]);
+
+            if (writer.joinable())                          // the previous run is written out by now, freeing its chunk buffer for the next read
+                writer.join();
+            temp_files.names.push_back(run.file_name);
+            writer = std::thread([&, current, file_name = run.file_name] {
+                FILE* run_file = fopen(file_name.c_str(), "wb");
+                if (!run_file || fwrite(chunk[current].data(), sizeof(_Type), count[current], run_file) != count[current])
+                    write_failed = true;
+                if (run_file && fclose(run_file) != 0)
+                    write_failed = true;
+            });
+            runs.push_back(run);
+
+            if (reader.joinable())
+                reader.join();
+            total_read += count[next];
+            current = next;
+        }
+        if (writer.joinable())
+            writer.join();
+        input.close();
+
+        for (int c = 0; c < 3; c++)                         // release the run generation buffers before the merge phase uses the memory budget
+            std::vector<_Type>().swap(chunk[c]);
+        std::vector<_Type>().swap(work_buffer);
+        if (write_failed)
+            throw std::runtime_error("external sort: unable to write sorted runs");
+
+        // intermediate passes, which keep the number of files open at once, and the buffers of the merge, within their limits
+        size_t merge_width = external_sort_merge_width<_Type>(memory_budget_in_bytes);
+        for (size_t pass = 1; runs.size() > merge_width; pass++)
+        {
+            std::vector< ExternalSortRun<_Type> > merged_runs;
+            for (size_t i = 0; i < runs.size(); i += merge_width)
+            {
+                std::vector< ExternalSortRun<_Type> > group(runs.begin() + i, runs.begin() + std::min(i + merge_width, runs.size()));
+                if (group.size() == 1)
+                {
+                    merged_runs.push_back(group[0]);
+                    continue;
+                }
+                std::string merged_file_name = run_prefix + std::to_string(pass) + "_" + std::to_string(merged_runs.size());
+                temp_files.names.push_back(merged_file_name);
+                ExternalSortRun<_Type> merged_run;
+                external_sort_merge_runs(group, merged_file_name.c_str(), memory_budget_in_bytes, &merged_run);
+                for (size_t k = 0; k < group.size(); k++)
+                    remove(group[k].file_name.c_str());
+                merged_runs.push_back(merged_run);
+            }
+            runs.swap(merged_runs);
+        }
+        external_sort_merge_runs(runs, output_file_name, memory_budget_in_bytes);
+    }
+
+    // sort_file_external<_Type>(options, ...) sorts the chunks and merges the runs within the arena given by options
+    template< class _Type, class... _Args >
+    inline decltype(auto) sort_file_external(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::sort_file_external<_Type>(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+
+#include "ExternalSort.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Sorts a file of unsigned longs with a memory budget of 1/8th of the file size, forcing the sort to spill sorted runs to disk and merge them
+int ExternalSortBenchmark(vector<unsigned long>& ulongs)
+{
+	const char* input_file_name  = "ExternalSortBenchmarkInput.bin";
+	const char* output_file_name = "ExternalSortBenchmarkOutput.bin";
+	size_t memory_budget_in_bytes = ulongs.size() * sizeof(unsigned long) / 8;
+
+	FILE* input_file = fopen(input_file_name, "wb");
+	if (!input_file || fwrite(ulongs.data(), sizeof(unsigned long), ulongs.size(), input_file) != ulongs.size())
+	{
+		printf("Unable to write the input file %s\n", input_file_name);
+		exit(1);
+	}
+	fclose(input_file);
+
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(std::execution::par_unseq, sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> sorted(ulongs.size());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		const auto startTime = high_resolution_clock::now();
+		ParallelAlgorithms::sort_file_external<unsigned long>(input_file_name, output_file_name, memory_budget_in_bytes);
+		const auto endTime = high_resolution_clock::now();
+
+		FILE* output_file = fopen(output_file_name, "rb");
+		size_t sorted_size = output_file ? fread(sorted.data(), sizeof(unsigned long), sorted.size(), output_file) : 0;
+		if (output_file)
+			fclose(output_file);
+		print_results("External Parallel Sort", sorted.data(), ulongs.size(), startTime, endTime);
+		if (sorted_size != sorted.size() || !std::equal(sorted_reference.begin(), sorted_reference.end(), sorted.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	remove(input_file_name);
+	remove(output_file_name);
+
+	return 0;
+}
@@ -22,11 +22,14 @@
 #include <execution>
 #endif
 
+#include "SmallParallel.h"
+#include "ParallelOptions.h"
+
 namespace ParallelAlgorithms
 {
     // Inclusive-left and exclusive-right boundaries
     template< class _Type >
-    inline void parallel_fill(_Type* src, _Type value, size_t l, size_t r, size_t parallel_threshold = 16 * 1024)
+    inline void parallel_fill_inner(_Type* src, _Type value, size_t l, size_t r, size_t parallel_threshold = 16 * 1024)
     {
         if (r <= l)
             return;
@@ -43,12 +46,12 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_fill(src, value, l, m, parallel_threshold); },
-            [&] { parallel_fill(src, value, m, r, parallel_threshold); }
+            [&] { parallel_fill_inner(src, value, l, m, parallel_threshold); },
+            [&] { parallel_fill_inner(src, value, m, r, parallel_threshold); }
         );
     }
     // Inclusive-left and exclusive-right boundaries
-    inline void parallel_fill(unsigned char* src, unsigned char value, size_t l, size_t r, size_t parallel_threshold = 16 * 1024)
+    inline void parallel_fill_inner(unsigned char* src, unsigned char value, size_t l, size_t r, size_t parallel_threshold = 16 * 1024)
     {
         if (r <= l)
             return;
@@ -66,9 +69,44 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_fill(src, value, l, m, parallel_threshold); },
-            [&] { parallel_fill(src, value, m, r, parallel_threshold); }
+            [&] { parallel_fill_inner(src, value, l, m, parallel_threshold); },
+            [&] { parallel_fill_inner(src, value, m, r, parallel_threshold); }
         );
     }
+
+    // Inclusive-left and exclusive-right boundaries
+    // Small arrays are filled by a single level of parallel tasks, larger ones recursively
+    // Memory-bound, and run on physical cores
+    template< class _Type >
+    inline void parallel_fill(_Type* src, _Type value, size_t l, size_t r, size_t parallel_threshold = 16 * 1024)
+    {
+        if (r <= l)
+            return;
+        run_kernel(KernelBound::Memory, [&] {
+            if ((r - l) <= SmallParallelCutoff)
+                parallel_fill_small(src, value, l, r);
+            else
+                parallel_fill_inner(src, value, l, r, parallel_threshold);
+        });
+    }
+    // Inclusive-left and exclusive-right boundaries
+    inline void parallel_fill(unsigned char* src, unsigned char value, size_t l, size_t r, size_t parallel_threshold = 16 * 1024)
+    {
+        if (r <= l)
+            return;
+        run_kernel(KernelBound::Memory, [&] {
+            if ((r - l) <= SmallParallelCutoff)
+                parallel_fill_small(src, value, l, r, 64 * 1024);     // bytes fill so fast that larger chunks are needed to pay for a task
+            else
+                parallel_fill_inner(src, value, l, r, parallel_threshold);
+        });
+    }
+
+    // Fill using the threads given by options, such as one per physical core
+    template< class... _Args >
+    inline decltype(auto) parallel_fill(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_fill(std::forward<_Args>(args)...); });
+    }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "ParallelMergeSort.h"
+#include "RadixSortLsdParallel.h"
+#include "HugePages.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Sorts of the same input, with the array and the work buffer in regular pages (A) and in transparent huge pages (B), alternating A and B
+// in each iteration so that both see the same system state. The arrays are written before the sorts, so that page faults are not timed
+template< class _Allocator >
+static void huge_page_benchmark_sorts(const char* const pages, vector<unsigned long>& ulongs, const vector<unsigned long>& sorted_reference, _Allocator allocator)
+{
+	vector<unsigned long, _Allocator> ulongsCopy(ulongs.size(), 0, allocator);
+	vector<unsigned long, _Allocator> work(ulongs.size(), 0, allocator);
+	char tag[128];
+
+	std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+	auto startTime = high_resolution_clock::now();
+	SortRadixPar(ulongsCopy.data(), work.data(), ulongsCopy.size());
+	auto endTime = high_resolution_clock::now();
+	snprintf(tag, sizeof(tag), "LSD Radix Sort,      %-12s", pages);
+	print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+	if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+	{
+		printf("Arrays are not equal\n");
+		exit(1);
+	}
+
+	std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+	startTime = high_resolution_clock::now();
+	ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(ulongsCopy.data(), 0, ulongsCopy.size() - 1, work.data(), false);
+	endTime = high_resolution_clock::now();
+	snprintf(tag, sizeof(tag), "Parallel Merge Sort, %-12s", pages);
+	print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+	if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+	{
+		printf("Arrays are not equal\n");
+		exit(1);
+	}
+}
+
+int HugePageBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(sorted_reference.begin(), sorted_reference.end());
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+	FILE* thp_setting = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+	if (thp_setting)
+	{
+		char setting[128] = {};
+		if (fgets(setting, sizeof(setting), thp_setting))
+			printf("Transparent huge pages: %s", setting);
+		fclose(thp_setting);
+	}
+#endif
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		huge_page_benchmark_sorts("4KB pages",  ulongs, sorted_reference, ParallelAlgorithms::HugePageAllocator<unsigned long>(ParallelAlgorithms::HugePages::None));
+		huge_page_benchmark_sorts("huge pages", ulongs, sorted_reference, ParallelAlgorithms::HugePageAllocator<unsigned long>(ParallelAlgorithms::HugePages::Transparent));
+	}
+	return 0;
+}
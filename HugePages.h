@@ -0,0 +1,133 @@
+// Huge page backed memory for large sort inputs and work buffers, where the scattered writes of the Radix Sort permute phase and
+// the merges of large arrays are limited by TLB misses: one 2MB page covers what takes 512 TLB entries with 4KB pages
+
+#ifndef _HugePages_h
+#define _HugePages_h
+
+#include <stddef.h>
+#include <new>
+#include <limits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#ifndef NOMINMAX
+#define NOMINMAX        // keeps std::min and std::max usable after windows.h
+#endif
+#include "windows.h"
+#else
+#include <sys/mman.h>
+#endif
+
+namespace ParallelAlgorithms
+{
+    const size_t HugePageSize = 2 * 1024 * 1024;
+
+    //   None        - regular pages
+    //   Transparent - a 2MB-aligned mapping advised with MADV_HUGEPAGE, which the kernel backs with transparent huge pages when it can,
+    //                 with regular pages as the fallback. Works with THP set to "madvise" or "always" in /sys/kernel/mm/transparent_hugepage/enabled
+    //   HugeTLB     - pages reserved in the hugetlbfs pool (vm.nr_hugepages), which are guaranteed huge. Falls back to Transparent
+    //                 when the pool has too few pages left
+    // On Windows, Transparent and HugeTLB use large pages, which need the "Lock pages in memory" privilege, with regular pages as the fallback
+    enum class HugePages { None, Transparent, HugeTLB };
+
+    inline size_t huge_pages_length(size_t size_in_bytes)
+    {
+        return (size_in_bytes + HugePageSize - 1) / HugePageSize * HugePageSize;
+    }
+
+    // Page-aligned memory of at least size_in_bytes, backed by huge pages as requested by hugePages, or nullptr when it can not be allocated.
+    // Must be freed by huge_pages_free with the same size_in_bytes
+    inline void* huge_pages_allocate(size_t size_in_bytes, HugePages hugePages = HugePages::Transparent)
+    {
+        if (size_in_bytes == 0 || size_in_bytes > std::numeric_limits<size_t>::max() - 2 * HugePageSize)
+            return nullptr;
+        size_t length = huge_pages_length(size_in_bytes);
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        if (hugePages != HugePages::None)
+        {
+            SIZE_T large_page_size = GetLargePageMinimum();
+            if (large_page_size > 0 && length % large_page_size == 0)
+            {
+                void* data = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+                if (data)
+                    return data;
+            }
+        }
+        return VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+#if defined(MAP_HUGETLB)
+        if (hugePages == HugePages::HugeTLB)
+        {
+            void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (data != MAP_FAILED)
+                return data;
+        }
+#endif
+        if (hugePages == HugePages::None)
+        {
+            void* data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return data == MAP_FAILED ? nullptr : data;
+        }
+        // over-allocate by one huge page, and unmap the parts before and after the 2MB-aligned range
+        char* mapping = (char*)mmap(nullptr, length + HugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == (char*)MAP_FAILED)
+            return nullptr;
+        char* data = (char*)(((size_t)mapping + HugePageSize - 1) / HugePageSize * HugePageSize);
+        if (data > mapping)
+            munmap(mapping, data - mapping);
+        if (data + length < mapping + length + HugePageSize)
+            munmap(data + length, mapping + length + HugePageSize - (data + length));
+#if defined(MADV_HUGEPAGE)
+        madvise(data, length, MADV_HUGEPAGE);
+#endif
+        return data;
+#endif
+    }
+
+    inline void huge_pages_free(void* data, size_t size_in_bytes)
+    {
+        if (!data)
+            return;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        VirtualFree(data, 0, MEM_RELEASE);
+#else
+        munmap(data, huge_pages_length(size_in_bytes));
+#endif
+    }
+
+    // Standard allocator, for std::vector inputs and outputs of the sorts in huge pages:
+    //   std::vector<unsigned long, HugePageAllocator<unsigned long>> a(size);
+    // Elements are value-initialized by std::vector, which also faults in the pages
+    template< class _Type >
+    struct HugePageAllocator
+    {
+        typedef _Type value_type;
+
+        HugePages huge_pages;
+
+        HugePageAllocator(HugePages hugePages = HugePages::Transparent) noexcept : huge_pages(hugePages) {}
+        template< class _Other >
+        HugePageAllocator(const HugePageAllocator<_Other>& other) noexcept : huge_pages(other.huge_pages) {}
+
+        _Type* allocate(size_t n)
+        {
+            if (n > std::numeric_limits<size_t>::max() / sizeof(_Type))
+                throw std::bad_alloc();
+            void* data = huge_pages_allocate(n * sizeof(_Type), huge_pages);
+            if (!data)
+                throw std::bad_alloc();
+            return (_Type*)data;
+        }
+
+        void deallocate(_Type* data, size_t n) noexcept
+        {
+            huge_pages_free(data, n * sizeof(_Type));
+        }
+
+        // memory from any of them can be freed by any other, whatever its HugePages
+        template< class _Other >
+        bool operator==(const HugePageAllocator<_Other>&) const noexcept { return true; }
+        template< class _Other >
+        bool operator!=(const HugePageAllocator<_Other>&) const noexcept { return false; }
+    };
+}
+
+#endif
@@ -167,6 +167,19 @@ template <typename RandomIterator, typename Comparator>
 void InplaceMerge(RandomIterator start, RandomIterator end,
     Comparator comp);
 
+/**
+ * Function: InplaceMerge(RandomIterator start, RandomIterator mid,
+ *                        RandomIterator end, Comparator comp);
+ * -------------------------------------------------------------------
+ * Given the sorted sequences [start, mid) and [mid, end), of any
+ * lengths, sorts the entire range according to comp in O(n) time and
+ * O(1) auxiliary storage space.  Like the version above, the merge is
+ * not stable.
+ */
+template <typename RandomIterator, typename Comparator>
+void InplaceMerge(RandomIterator start, RandomIterator mid,
+    RandomIterator end, Comparator comp);
+
 /* * * * * Implementation Below This Point * * * * */
 namespace inplacemerge_detail {
     /**
@@ -430,6 +443,41 @@ namespace inplacemerge_detail {
         std::sort_heap(buffer, buffer + blockSize, comp);
         std::rotate(buffer, buffer + blockSize, end);
     }
+
+    /**
+     * Function: RotationMerge(RandomIterator begin, RandomIterator mid,
+     *                         RandomIterator end, Comparator comp);
+     * ----------------------------------------------------------------------
+     * Merges the sorted ranges [begin, mid) and [mid, end) by moving the
+     * shorter range through the longer one with rotations.  Each element of
+     * the shorter range is placed in turn: the elements of the longer range
+     * which go before it (or after it, when the second range is the shorter
+     * one) are rotated past what is left of the shorter range.  With k
+     * elements in the shorter range, this takes O(k^2 + n) time, which is
+     * O(n) for the k = O(sqrt(n)) it is used for.
+     */
+    template <typename RandomIterator, typename Comparator>
+    void RotationMerge(RandomIterator begin, RandomIterator mid,
+        RandomIterator end, Comparator comp) {
+        if (mid - begin <= end - mid) {
+            /* Place the elements of the first range from the front. */
+            while (begin != mid && mid != end) {
+                RandomIterator split = std::lower_bound(mid, end, *begin, comp);
+                begin = std::rotate(begin, mid, split);
+                mid = split;
+                ++begin;
+            }
+        }
+        else {
+            /* Place the elements of the second range from the back. */
+            while (begin != mid && mid != end) {
+                RandomIterator split = std::upper_bound(begin, mid, *(end - 1), comp);
+                end = std::rotate(split, mid, end);
+                mid = split;
+                --end;
+            }
+        }
+    }
 }
 
 /* Actual implementation of InplaceMerge */
@@ -457,18 +505,40 @@ void InplaceMerge(RandomIterator begin, RandomIterator end,
         return;
     }
 
+    /* The second list starts at the midpoint. */
+    InplaceMerge(begin, begin + (end - begin) / 2, end, comp);
+}
+
+/* Implementation of InplaceMerge for lists of any lengths, where listSize
+ * of the original, which both lists had, becomes firstSize and secondSize.
+ */
+template <typename RandomIterator, typename Comparator>
+void InplaceMerge(RandomIterator begin, RandomIterator mid,
+    RandomIterator end, Comparator comp) {
+    /* Grant access to the utility functions we've written. */
+    using namespace inplacemerge_detail;
+
+    /* Nothing to merge when either list is empty. */
+    if (begin == mid || mid == end) return;
+
     /* Compute s, the block size.  The casts are necessary to resolve which
      * overload to use.
      */
     const size_t s = (size_t)std::ceil(std::sqrt(double(end - begin)));
 
     /* Cache the number of elements in each subrange. */
-    const size_t listSize = (end - begin) / 2;
+    const size_t firstSize = mid - begin;
+    const size_t secondSize = end - mid;
 
-    /* Compute the midpoint, which is where the second list starts and
-     * the first list stops.
+    /* The named blocks exist, and E is small enough to be merged back in at
+     * the end, when each list has at least four blocks.  A shorter list has
+     * O(sqrt(n)) elements, which rotations merge in O(n) time, and this also
+     * covers the small ranges for which the original used heap sort.
      */
-    RandomIterator mid = begin + listSize;
+    if (firstSize < 4 * s || secondSize < 4 * s) {
+        RotationMerge(begin, mid, end, comp);
+        return;
+    }
 
     /* Get back iterators to the start of blocks A and B. */
     std::pair<RandomIterator, RandomIterator> maxElems =
@@ -480,7 +550,7 @@ void InplaceMerge(RandomIterator begin, RandomIterator end,
     RandomIterator cStart = maxElems.first - std::distance(maxElems.second, end);
 
     /* Group D is formed by taking the K - |B| % s elements that precede B. */
-    RandomIterator dStart = maxElems.second - ((listSize - std::distance(maxElems.second, end)) % s);
+    RandomIterator dStart = maxElems.second - ((secondSize - std::distance(maxElems.second, end)) % s);
 
     /* Exchange C and B.  This makes the range [cStart, mid) the buffer. */
     std::swap_ranges(cStart, maxElems.first, maxElems.second);
@@ -498,7 +568,7 @@ void InplaceMerge(RandomIterator begin, RandomIterator end,
      * has been swapped with the buffer.  This means that the number of elements
      * that are beyond what's necessary is K mod s.  Let's see what this is.
      */
-    const size_t firstSlack = listSize % s;
+    const size_t firstSlack = firstSize % s;
 
     /* There are two cases to consider.  First, if s == 0, then there is no
      * leftover slack and we can just run the main algorithm.  Otherwise,
@@ -536,7 +606,7 @@ void InplaceMerge(RandomIterator begin, RandomIterator end,
      * sorting it.
      */
     std::swap_ranges(dStart, end, begin);
-    BufferedInplaceMerge(begin, begin + distance(dStart, end), dStart,
+    BufferedInplaceMerge(begin, begin + std::distance(dStart, end), dStart,
         dStart, end, comp);
 
     /* Sort the buffer using heapsort. */
@@ -554,4 +624,10 @@ void InplaceMerge(RandomIterator begin, RandomIterator end) {
         std::less<typename std::iterator_traits<RandomIterator>::value_type>());
 }
 
+template <typename RandomIterator>
+void InplaceMerge(RandomIterator begin, RandomIterator mid, RandomIterator end) {
+    InplaceMerge(begin, mid, end,
+        std::less<typename std::iterator_traits<RandomIterator>::value_type>());
+}
+
 #endif
\ No newline at end of file
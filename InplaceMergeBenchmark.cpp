@@ -0,0 +1,93 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "ParallelMerge.h"
+#include "ParallelMergeSort.h"
+#include "InplaceMerge.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+extern void check_results(const vector<unsigned long>& reference, const vector<unsigned long>& result);
+
+// Merges of two sorted halves: std::inplace_merge, which uses a buffer when it can allocate one, the serial and parallel linear-time
+// truly in-place merges, and the O(n log n) truly in-place parallel merge. Then the in-place Parallel Merge Sort, stable with its
+// rotation-based merges, and not stable with the linear-time merge
+int InplaceMergeBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> halves_sorted(ulongs);
+	size_t middle = ulongs.size() / 2;
+	sort(halves_sorted.begin(), halves_sorted.begin() + middle);
+	sort(halves_sorted.begin() + middle, halves_sorted.end());
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		std::copy(halves_sorted.begin(), halves_sorted.end(), ulongsCopy.begin());
+		auto startTime = high_resolution_clock::now();
+		std::inplace_merge(ulongsCopy.begin(), ulongsCopy.begin() + middle, ulongsCopy.end());
+		auto endTime = high_resolution_clock::now();
+		print_results("std::inplace_merge                       ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+
+		std::copy(halves_sorted.begin(), halves_sorted.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		InplaceMerge(ulongsCopy.begin(), ulongsCopy.begin() + middle, ulongsCopy.end());
+		endTime = high_resolution_clock::now();
+		print_results("Linear in-place merge                    ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+
+		std::copy(halves_sorted.begin(), halves_sorted.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		p_merge_linear_in_place(ulongsCopy.data(), 0, middle - 1, ulongsCopy.size() - 1);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel linear in-place merge           ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+
+		std::copy(halves_sorted.begin(), halves_sorted.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		p_merge_truly_in_place(ulongsCopy.data(), 0, middle - 1, ulongsCopy.size() - 1);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel truly in-place merge            ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_inplace_merge_sort_hybrid(ulongsCopy.data(), 0, ulongsCopy.size() - 1, true);
+		endTime = high_resolution_clock::now();
+		print_results("In-place Parallel Merge Sort, stable     ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_inplace_merge_sort_hybrid(ulongsCopy.data(), 0, ulongsCopy.size() - 1, false);
+		endTime = high_resolution_clock::now();
+		print_results("In-place Parallel Merge Sort, not stable ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::parallel_inplace_merge_sort_hybrid(ulongsCopy.data(), 0, ulongsCopy.size() - 1, false, 0, true);
+		endTime = high_resolution_clock::now();
+		print_results("In-place Parallel Merge Sort, linear     ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(sorted_reference, ulongsCopy);
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "ParallelMergeSort.h"
+#include "SortThresholds.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+extern void check_results(const vector<unsigned long>& reference, const vector<unsigned long>& result);
+
+// Sweeps the leaf threshold of the serial in-place merge sort and the parallel threshold of the in-place Parallel Merge Sorts,
+// where a threshold of 0 is the one derived from the number of cores, the cache sizes and the element size
+int InplaceThresholdBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	ParallelAlgorithms::MemoryBudget no_memory(0);
+
+	printf("L1 cache = %zu bytes, L2 cache = %zu bytes, cores = %zu\n", ParallelAlgorithms::l1_cache_size(), ParallelAlgorithms::l2_cache_size(),
+		ParallelAlgorithms::small_parallel_processor_count());
+	printf("Derived leaf threshold = %zu, derived parallel threshold = %zu\n", ParallelAlgorithms::inplace_merge_sort_leaf_threshold<unsigned long>(),
+		ParallelAlgorithms::inplace_merge_sort_parallel_threshold<unsigned long>(ulongs.size()));
+
+	size_t leaf_thresholds[] = { 0, 16, 32, 48, 64, 96, 128 };
+	size_t parallel_thresholds[] = { 0, 1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024, ulongs.size() / ParallelAlgorithms::small_parallel_processor_count() };
+	char tag[128];
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		for (size_t threshold : leaf_thresholds)
+		{
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			auto startTime = high_resolution_clock::now();
+			ParallelAlgorithms::preventative_adaptive_inplace_merge_sort(ulongsCopy.data(), 0, ulongsCopy.size() - 1, no_memory, threshold);
+			auto endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "In-place Merge Sort, leaf threshold %-10zu               ", threshold);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+		}
+
+		for (size_t threshold : parallel_thresholds)
+		{
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			auto startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_inplace_merge_sort_hybrid_inner(ulongsCopy.data(), 0, ulongsCopy.size() - 1, true, threshold);
+			auto endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "In-place Parallel Merge Sort, stable, threshold %-10zu   ", threshold);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_inplace_merge_sort_hybrid_inner(ulongsCopy.data(), 0, ulongsCopy.size() - 1, false, threshold);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "In-place Parallel Merge Sort, threshold %-10zu           ", threshold);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort(ulongsCopy.data(), 0, ulongsCopy.size() - 1, no_memory, threshold);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Preventative In-place Merge Sort, threshold %-10zu       ", threshold);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+		}
+	}
+	return 0;
+}
@@ -3,17 +3,20 @@
 #ifndef _InsertionSort_h
 #define _InsertionSort_h
 
-template< class _Type >
-inline void insertionSortSimilarToSTLnoSelfAssignment( _Type* a, size_t a_size )
+#include <stddef.h>
+#include <functional>
+
+template< class _Type, class _Compare >
+inline void insertionSortSimilarToSTLnoSelfAssignment( _Type* a, size_t a_size, _Compare comp )
 {
 	for ( size_t i = 1; i < a_size; i++ )
 	{
-		if ( a[ i ] < a[ i - 1 ] )		// no need to do (j > 0) compare for the first iteration
+		if ( comp( a[ i ], a[ i - 1 ] ) )		// no need to do (j > 0) compare for the first iteration
 		{
 			_Type currentElement = a[ i ];
 			a[ i ] = a[ i - 1 ];
 			size_t j;
-			for ( j = i - 1; j > 0 && currentElement < a[ j - 1 ]; j-- )
+			for ( j = i - 1; j > 0 && comp( currentElement, a[ j - 1 ] ); j-- )
 			{
 				a[ j ] = a[ j - 1 ];
 			}
@@ -23,4 +26,10 @@ inline void insertionSortSimilarToSTLnoSelfAssignment( _Type* a, size_t a_size )
 	}
 }
 
+template< class _Type >
+inline void insertionSortSimilarToSTLnoSelfAssignment( _Type* a, size_t a_size )
+{
+	insertionSortSimilarToSTLnoSelfAssignment( a, a_size, std::less<>() );
+}
+
 #endif
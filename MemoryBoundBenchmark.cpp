@@ -0,0 +1,108 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <execution>
+#include <random>
+#include <ratio>
+#include <thread>
+#include <vector>
+
+#include "SmallParallel.h"
+#include "FillParallel.h"
+#include "SumParallel.h"
+#include "RadixSelectParallel.h"
+#include "ParallelStdAlgorithms.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+extern void check_results(const vector<unsigned long>& reference, const vector<unsigned long>& result);
+
+// The memory-bound kernels: fill, sum, the histogram of Radix Select, LSD Radix Sort (histogram and permutation) and merge, each on all
+// hardware threads, and on one thread per physical core, which is what the library does by default. On machines without hyperthreads both are the same
+int MemoryBoundBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	vector<unsigned long> halves(ulongs);
+	size_t middle = halves.size() / 2;
+	sort(halves.begin(), halves.begin() + middle);
+	sort(halves.begin() + middle, halves.end());
+	unsigned long long sum_reference = 0;
+	for (unsigned long value : ulongs)
+		sum_reference += value;
+	char tag[128];
+
+	printf("Hardware threads = %u, physical cores = %zu\n", std::thread::hardware_concurrency(), ParallelAlgorithms::physical_core_count());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		for (bool physical_cores : { false, true })
+		{
+			ParallelAlgorithms::memory_bound_kernels_on_physical_cores() = physical_cores;
+			const char* threads = physical_cores ? "physical cores  " : "hardware threads";
+
+			auto startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_fill(ulongsCopy.data(), (unsigned long)i, (size_t)0, ulongsCopy.size());
+			auto endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Fill,         %s ", threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			if (std::count(ulongsCopy.begin(), ulongsCopy.end(), (unsigned long)i) != (std::ptrdiff_t)ulongsCopy.size())
+			{
+				printf("Fill is not complete\n");
+				exit(1);
+			}
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			long long sum = ParallelAlgorithms::SumParallel(ulongsCopy.data(), (size_t)0, ulongsCopy.size());
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Sum,          %s ", threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			if ((unsigned long long)sum != sum_reference)
+			{
+				printf("Sums are not equal\n");
+				exit(1);
+			}
+
+			startTime = high_resolution_clock::now();
+			unsigned long median = ParallelAlgorithms::radix_select_par(ulongsCopy.data(), ulongsCopy.size(), ulongsCopy.size() / 2);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Radix Select, %s ", threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			if (median != sorted_reference[sorted_reference.size() / 2])
+			{
+				printf("Medians are not equal\n");
+				exit(1);
+			}
+
+			startTime = high_resolution_clock::now();
+			SortRadixPar(ulongsCopy.data(), ulongsCopy.size());
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "LSD Radix,    %s ", threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::merge(std::execution::par, halves.begin(), halves.begin() + middle, halves.begin() + middle, halves.end(), ulongsCopy.begin());
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Merge,        %s ", threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+		}
+	}
+	ParallelAlgorithms::memory_bound_kernels_on_physical_cores() = true;
+	return 0;
+}
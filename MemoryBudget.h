@@ -0,0 +1,185 @@
+// Memory budget of the preventative-adaptive algorithms: how much they may allocate for work buffers before falling back to their in-place paths.
+// Taken once per sort, from the physical memory and the cgroup memory limit of the process, or given explicitly, and passed down the recursion.
+
+#ifndef _MemoryBudget_h
+#define _MemoryBudget_h
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <string>
+
+extern unsigned long long physical_memory_used_in_megabytes();
+extern unsigned long long physical_memory_total_in_megabytes();
+
+namespace ParallelAlgorithms
+{
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+    inline bool cgroup_read_value(const std::string& file_name, unsigned long long& value)
+    {
+        FILE* file = fopen(file_name.c_str(), "r");
+        if (!file)
+            return false;
+        bool read = fscanf(file, "%llu", &value) == 1;      // fails on "max", which is no limit
+        fclose(file);
+        return read;
+    }
+
+    // Value of the key line in a memory.stat file
+    inline bool cgroup_read_stat(const std::string& file_name, const char* key, unsigned long long& value)
+    {
+        FILE* file = fopen(file_name.c_str(), "r");
+        if (!file)
+            return false;
+        char name[128];
+        unsigned long long stat_value;
+        bool read = false;
+        while (!read && fscanf(file, "%127s %llu", name, &stat_value) == 2)
+        {
+            if (strcmp(name, key) == 0)
+            {
+                value = stat_value;
+                read = true;
+            }
+        }
+        fclose(file);
+        return read;
+    }
+
+    // Memory limit and usage of the cgroup of the process, from cgroup v2 (memory.max) or v1 (memory.limit_in_bytes). The limit is the smallest
+    // of the cgroup and its ancestors, as a container may be limited by any of them. The cgroup path from /proc/self/cgroup is not always
+    // visible inside a container, so parent directories up to the mount point are tried as well. Page cache which the kernel can reclaim
+    // (inactive_file) is not counted as used, the same as the container runtimes do. Returns false when no limit is set or can be read.
+    inline bool cgroup_memory_limit(unsigned long long& limit_in_bytes, unsigned long long& used_in_bytes)
+    {
+        FILE* cgroups = fopen("/proc/self/cgroup", "r");
+        if (!cgroups)
+            return false;
+        std::string v2_path, v1_path;
+        bool v2 = false, v1 = false;
+        char line[4096];
+        while (fgets(line, sizeof(line), cgroups))      // lines of hierarchy-ID:controller-list:cgroup-path
+        {
+            char* controllers = strchr(line, ':');
+            char* path = controllers ? strchr(controllers + 1, ':') : nullptr;
+            if (!path)
+                continue;
+            *controllers++ = '\0';
+            *path++ = '\0';
+            path[strcspn(path, "\n")] = '\0';
+            if (strcmp(line, "0") == 0 && controllers[0] == '\0')
+            {
+                v2 = true;
+                v2_path = path;
+            }
+            for (char* controller = strtok(controllers, ","); controller; controller = strtok(nullptr, ","))
+            {
+                if (strcmp(controller, "memory") == 0)
+                {
+                    v1 = true;
+                    v1_path = path;
+                }
+            }
+        }
+        fclose(cgroups);
+
+        const char* mount_point = v1 ? "/sys/fs/cgroup/memory" : "/sys/fs/cgroup";
+        std::string path = v1 ? v1_path : v2_path;
+        const char* limit_file = v1 ? "/memory.limit_in_bytes" : "/memory.max";
+        const char* usage_file = v1 ? "/memory.usage_in_bytes" : "/memory.current";
+        const char* inactive_file = v1 ? "total_inactive_file" : "inactive_file";
+        if (!v1 && !v2)
+            return false;
+
+        bool limited = false, used_read = false;
+        limit_in_bytes = (unsigned long long)-1;
+        while (true)
+        {
+            std::string directory = mount_point + (path == "/" ? std::string() : path);
+            unsigned long long value;
+            if (cgroup_read_value(directory + limit_file, value) && value < limit_in_bytes)
+            {
+                limit_in_bytes = value;
+                limited = true;
+            }
+            if (!used_read && cgroup_read_value(directory + usage_file, used_in_bytes))
+            {
+                used_read = true;
+                unsigned long long inactive = 0;
+                if (cgroup_read_stat(directory + "/memory.stat", inactive_file, inactive) && inactive < used_in_bytes)
+                    used_in_bytes -= inactive;
+            }
+            if (path.empty() || path == "/")
+                break;
+            size_t parent = path.find_last_of('/');
+            path = parent == 0 || parent == std::string::npos ? "/" : path.substr(0, parent);
+        }
+        return limited && used_read;
+    }
+#endif
+
+    // Bytes that an algorithm may allocate. Concurrent parts of a parallel algorithm reserve what they allocate, and release it
+    // when they free it, so that parallel merges at one level of the recursion do not all allocate what only one of them fits in.
+    class MemoryBudget
+    {
+    public:
+        // An explicit budget, such as the memory left for a sort by an application which knows its own limits
+        explicit MemoryBudget(unsigned long long available_bytes) : m_available_bytes(available_bytes) {}
+
+        MemoryBudget(const MemoryBudget& other) : m_available_bytes(other.available_bytes()) {}
+        MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+        unsigned long long available_bytes() const
+        {
+            return m_available_bytes.load(std::memory_order_relaxed);
+        }
+
+        bool fits(size_t bytes) const
+        {
+            return bytes <= available_bytes();
+        }
+
+        // Takes bytes from the budget, when there are that many left
+        bool try_reserve(size_t bytes)
+        {
+            unsigned long long available = m_available_bytes.load(std::memory_order_relaxed);
+            do
+            {
+                if (bytes > available)
+                    return false;
+            } while (!m_available_bytes.compare_exchange_weak(available, available - bytes, std::memory_order_relaxed));
+            return true;
+        }
+
+        void release(size_t bytes)
+        {
+            m_available_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<unsigned long long> m_available_bytes;
+    };
+
+    // The budget of the process: physical_memory_threshold of the physical memory, or of the cgroup memory limit when that is smaller,
+    // less the memory already in use, the same rule the preventative-adaptive algorithms have always used, against the limit that really applies
+    inline MemoryBudget system_memory_budget(double physical_memory_threshold = 0.75)
+    {
+        unsigned long long total_in_bytes = physical_memory_total_in_megabytes() * 1024ULL * 1024;
+        unsigned long long used_in_bytes  = physical_memory_used_in_megabytes()  * 1024ULL * 1024;
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+        unsigned long long cgroup_limit_in_bytes, cgroup_used_in_bytes;
+        if (cgroup_memory_limit(cgroup_limit_in_bytes, cgroup_used_in_bytes) && cgroup_limit_in_bytes < total_in_bytes)
+        {
+            total_in_bytes = cgroup_limit_in_bytes;
+            used_in_bytes  = cgroup_used_in_bytes;
+        }
+#endif
+        double allowed_in_bytes = physical_memory_threshold * (double)total_in_bytes;
+        if (allowed_in_bytes <= (double)used_in_bytes)
+            return MemoryBudget(0);
+        return MemoryBudget((unsigned long long)(allowed_in_bytes - (double)used_in_bytes));
+    }
+}
+
+#endif
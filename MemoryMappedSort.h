@@ -0,0 +1,252 @@
+// TODO: Use PrefetchVirtualMemory() on Windows as the equivalent of madvise(MADV_WILLNEED)
+
+// In-place sort of on-disk arrays of fixed-width integers, through a memory mapping of the file.
+// No read()/write() copies are made, and the page cache acts as the working memory of the in-place sorting algorithms.
+
+#ifndef _MemoryMappedSort_h
+#define _MemoryMappedSort_h
+
+#include <stddef.h>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#ifndef NOMINMAX
+#define NOMINMAX        // keep windows.h from defining min() and max() macros, which break std::min and std::max
+#endif
+#include <windows.h>
+#include <ppl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tbb/task_group.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    enum MappedAccessPattern { MappedAccessNormal, MappedAccessSequential, MappedAccessRandom, MappedAccessWillNeed };
+
+    // Tell the OS how the mapped pages are about to be accessed, to tune read-ahead and page eviction for the next phase of the sort
+    inline void mapped_advise(void* address, size_t length, MappedAccessPattern pattern)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        (void)address;  (void)length;  (void)pattern;
+#else
+        int advice = MADV_NORMAL;
+        switch (pattern)
+        {
+        case MappedAccessSequential: advice = MADV_SEQUENTIAL; break;
+        case MappedAccessRandom:     advice = MADV_RANDOM;     break;
+        case MappedAccessWillNeed:   advice = MADV_WILLNEED;   break;
+        default:                     advice = MADV_NORMAL;     break;
+        }
+        madvise(address, length, advice);     // only a hint, which is safe to ignore on failure
+#endif
+    }
+
+    // Top level of the in-place MSD Radix Sort, split into its phases, with each phase preceded by an access hint for the mapped pages.
+    // Histogram reads the whole array sequentially, permutation swaps elements into 256 bins at random, and recursion into each bin
+    // stays within that bin. Lower levels of recursion are handled by _RadixSort_Unsigned_PowerOf2Radix_Par_L1.
+    template< unsigned long PowerOfTwoRadix, unsigned long Log2ofPowerOfTwoRadix, long Threshold >
+    inline void _RadixSort_Unsigned_PowerOf2Radix_Advised_Par_L1(unsigned long* a, size_t a_size, unsigned long bitMask, unsigned long shiftRightAmount)
+    {
+        size_t last = a_size - 1;
+        size_t a_bytes = a_size * sizeof(unsigned long);
+
+        mapped_advise(a, a_bytes, MappedAccessSequential);
+        size_t* count = HistogramOneByteComponentParallel< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(a, 0, last, shiftRightAmount);
+
+        size_t startOfBin[PowerOfTwoRadix + 1], endOfBin[PowerOfTwoRadix], nextBin = 1;
+        startOfBin[0] = endOfBin[0] = 0;    startOfBin[PowerOfTwoRadix] = 0;			// sentinal
+        for (unsigned long i = 1; i < PowerOfTwoRadix; i++)
+            startOfBin[i] = endOfBin[i] = startOfBin[i - 1] + count[i - 1];
+        delete[] count;
+
+        mapped_advise(a, a_bytes, MappedAccessRandom);
+        for (size_t _current = 0; _current <= last; )
+        {
+            unsigned long digit;
+            unsigned long _current_element = a[_current];	// get the compiler to recognize that a register can be used for the loop instead of a[_current] memory location
+            while (endOfBin[digit = (unsigned long)((_current_element & bitMask) >> shiftRightAmount)] != _current)  _swap(_current_element, a[endOfBin[digit]++]);
+            a[_current] = _current_element;
+
+            endOfBin[digit]++;
+            while (endOfBin[nextBin - 1] == startOfBin[nextBin])  nextBin++;	// skip over empty and full bins, when the end of the current bin reaches the start of the next bin
+            _current = endOfBin[nextBin - 1];
+        }
+
+        bitMask >>= Log2ofPowerOfTwoRadix;
+        if (bitMask == 0)						// all the bits have been processed
+            return;
+        if (shiftRightAmount >= Log2ofPowerOfTwoRadix)	shiftRightAmount -= Log2ofPowerOfTwoRadix;
+        else											shiftRightAmount = 0;
+
+        mapped_advise(a, a_bytes, MappedAccessNormal);
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (unsigned long i = 0; i < PowerOfTwoRadix; i++)
+        {
+            size_t numberOfElements = endOfBin[i] - startOfBin[i];
+            if (numberOfElements >= Threshold)		// endOfBin actually points to one beyond the bin
+                g.run([=] {							// important to not pass by reference, as all tasks will then get the same/last value
+                    _RadixSort_Unsigned_PowerOf2Radix_Par_L1< unsigned long, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&a[startOfBin[i]], numberOfElements, bitMask, shiftRightAmount);
+                });
+            else if (numberOfElements >= 2)
+                ParallelAlgorithms::small_sort_hybrid(&a[startOfBin[i]], numberOfElements);
+        }
+        g.wait();
+    }
+
+    // In-place sort of a memory mapped array, which uses all of the bits of the unsigned long keys
+    inline void parallel_inplace_msd_radix_sort_mapped(unsigned long* a, size_t a_size)
+    {
+        const long PowerOfTwoRadix = 256;
+        const long Log2ofPowerOfTwoRadix = 8;
+        const long Threshold = 100;
+
+        if (a_size < Threshold)
+        {
+            ParallelAlgorithms::small_sort_hybrid(a, a_size);
+            return;
+        }
+        unsigned long shiftRightAmount = (unsigned long)(sizeof(unsigned long) * 8 - Log2ofPowerOfTwoRadix);   // start with the most significant digit
+        unsigned long bitMask = (unsigned long)(PowerOfTwoRadix - 1) << shiftRightAmount;
+        _RadixSort_Unsigned_PowerOf2Radix_Advised_Par_L1< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, a_size, bitMask, shiftRightAmount);
+    }
+
+    // Read-write mapping of a whole file. The mapping and the file are released when it goes out of scope, also when the sort throws.
+    // Files smaller than min_bytes are opened but not mapped, leaving address null
+    struct MappedFile
+    {
+        void*  address;
+        size_t size_in_bytes;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        HANDLE file;
+        HANDLE mapping;
+
+        MappedFile(const char* file_name, size_t min_bytes)
+            : address(NULL), size_in_bytes(0), file(INVALID_HANDLE_VALUE), mapping(NULL)
+        {
+            file = CreateFileA(file_name, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::runtime_error(std::string("mapped sort: unable to open file ") + file_name);
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size))
+            {
+                CloseHandle(file);
+                throw std::runtime_error(std::string("mapped sort: unable to get the size of file ") + file_name);
+            }
+            size_in_bytes = (size_t)file_size.QuadPart;
+            if (size_in_bytes < min_bytes)
+                return;
+            mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+            address = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0) : NULL;
+            if (!address)
+            {
+                if (mapping) CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::runtime_error(std::string("mapped sort: unable to map file ") + file_name);
+            }
+        }
+        ~MappedFile()
+        {
+            if (address) UnmapViewOfFile(address);
+            if (mapping) CloseHandle(mapping);
+            CloseHandle(file);
+        }
+        bool flush()
+        {
+            return FlushViewOfFile(address, 0) && FlushFileBuffers(file);
+        }
+#else
+        int file;
+
+        MappedFile(const char* file_name, size_t min_bytes)
+            : address(NULL), size_in_bytes(0), file(-1)
+        {
+            file = open(file_name, O_RDWR);
+            if (file < 0)
+                throw std::runtime_error(std::string("mapped sort: unable to open file ") + file_name);
+            struct stat file_status;
+            if (fstat(file, &file_status) != 0)
+            {
+                close(file);
+                throw std::runtime_error(std::string("mapped sort: unable to get the size of file ") + file_name);
+            }
+            size_in_bytes = (size_t)file_status.st_size;
+            if (size_in_bytes < min_bytes)
+                return;
+            address = mmap(NULL, size_in_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            if (address == MAP_FAILED)
+            {
+                address = NULL;
+                close(file);
+                throw std::runtime_error(std::string("mapped sort: unable to map file ") + file_name);
+            }
+        }
+        ~MappedFile()
+        {
+            if (address) munmap(address, size_in_bytes);
+            close(file);
+        }
+        bool flush()
+        {
+            return msync(address, size_in_bytes, MS_SYNC) == 0;
+        }
+#endif
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+    };
+
+    // Sort a binary file of fixed-width integers in place, by memory mapping it.
+    // unsigned long keys are sorted with the in-place MSD Radix Sort when use_radix_sort is set, and all other types
+    // (or use_radix_sort == false) with the in-place Parallel Merge Sort. Modified pages are flushed to the file before returning.
+    template< class _Type >
+    inline void sort_file_in_place_mapped(const char* file_name, bool use_radix_sort = true)
+    {
+        static_assert(std::is_trivially_copyable<_Type>::value, "in-place file sort requires fixed-width keys, which can be mapped as raw bytes");
+
+        MappedFile mapped(file_name, 2 * sizeof(_Type));
+        if (!mapped.address)
+            return;
+        void* address = mapped.address;
+        size_t file_bytes = mapped.size_in_bytes;
+        _Type* a = static_cast<_Type*>(address);
+        size_t a_size = file_bytes / sizeof(_Type);     // a trailing partial element, if any, is left untouched
+
+        if constexpr (std::is_same<_Type, unsigned long>::value)
+        {
+            if (use_radix_sort)
+                parallel_inplace_msd_radix_sort_mapped(a, a_size);
+            else
+            {
+                mapped_advise(address, file_bytes, MappedAccessWillNeed);      // merge sort visits all pages many times, so read them all in up front
+                parallel_inplace_merge_sort_hybrid(a, 0, a_size - 1);
+            }
+        }
+        else
+        {
+            mapped_advise(address, file_bytes, MappedAccessWillNeed);
+            parallel_inplace_merge_sort_hybrid(a, 0, a_size - 1);
+        }
+
+        if (!mapped.flush())
+            throw std::runtime_error(std::string("mapped sort: unable to flush sorted data to file ") + file_name);
+    }
+
+    template< class _Type, class... _Args >
+    inline decltype(auto) sort_file_in_place_mapped(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::sort_file_in_place_mapped<_Type>(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
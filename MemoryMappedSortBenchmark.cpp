@@ -0,0 +1,64 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+
+#include "MemoryMappedSort.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Sorts a file of unsigned longs in place, through a memory mapping of the file, with the in-place MSD Radix Sort and the in-place Merge Sort
+int MemoryMappedSortBenchmark(vector<unsigned long>& ulongs)
+{
+	const char* file_name = "MemoryMappedSortBenchmark.bin";
+
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(std::execution::par_unseq, sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> sorted(ulongs.size());
+
+	for (int i = 0; i < 2 * iterationCount; ++i)
+	{
+		bool use_radix_sort = i < iterationCount;
+		FILE* file = fopen(file_name, "wb");
+		if (!file || fwrite(ulongs.data(), sizeof(unsigned long), ulongs.size(), file) != ulongs.size())
+		{
+			printf("Unable to write the file %s\n", file_name);
+			exit(1);
+		}
+		fclose(file);
+
+		const auto startTime = high_resolution_clock::now();
+		ParallelAlgorithms::sort_file_in_place_mapped<unsigned long>(file_name, use_radix_sort);
+		const auto endTime = high_resolution_clock::now();
+
+		file = fopen(file_name, "rb");
+		size_t sorted_size = file ? fread(sorted.data(), sizeof(unsigned long), sorted.size(), file) : 0;
+		if (file)
+			fclose(file);
+		print_results(use_radix_sort ? "Memory Mapped In-Place MSD Radix Sort" : "Memory Mapped In-Place Merge Sort", sorted.data(), ulongs.size(), startTime, endTime);
+		if (sorted_size != sorted.size() || !std::equal(sorted_reference.begin(), sorted_reference.end(), sorted.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	remove(file_name);
+
+	return 0;
+}
@@ -0,0 +1,257 @@
+// Parallel Natural Merge Sort: takes advantage of the ascending and descending runs already in the input, as TimSort does,
+// so that presorted input costs one parallel scan, and a sorted array with a short unsorted tail costs a sort of the tail plus one merge.
+// Not stable: the runs, and the stretches of short runs after they are sorted, are merged by the parallel merge, which exchanges its halves
+
+#ifndef _NaturalMergeSort_h
+#define _NaturalMergeSort_h
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <new>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "SmallParallel.h"
+#include "WorkBufferPool.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    enum class NaturalRunKind { Ascending, Descending, Unsorted };
+
+    struct NaturalRun
+    {
+        size_t         start;       // inclusive
+        size_t         end;         // exclusive
+        NaturalRunKind kind;
+    };
+
+    // Appends run to runs, joining it to the last run when both are ascending and in order across the boundary, both strictly descending
+    // across the boundary, or both unsorted
+    template< class _Type, class _Compare >
+    inline void natural_merge_sort_append_run(const _Type* a, std::vector<NaturalRun>& runs, const NaturalRun& run, _Compare comp)
+    {
+        if (!runs.empty() && runs.back().end == run.start && runs.back().kind == run.kind)
+        {
+            NaturalRun& last = runs.back();
+            if ((run.kind == NaturalRunKind::Unsorted) ||
+                (run.kind == NaturalRunKind::Ascending  && !comp(a[run.start], a[last.end - 1])) ||
+                (run.kind == NaturalRunKind::Descending &&  comp(a[run.start], a[last.end - 1])))
+            {
+                last.end = run.end;
+                return;
+            }
+        }
+        runs.push_back(run);
+    }
+
+    // Runs of a[startIndex .. endIndex-1]: maximal non-descending runs, and strictly descending runs, which have no equal elements to reorder when reversed.
+    // Consecutive runs shorter than minRunLength are cheaper to sort than to merge, and are collected into unsorted runs.
+    template< class _Type, class _Compare >
+    inline void natural_merge_sort_find_runs(const _Type* a, size_t startIndex, size_t endIndex, size_t minRunLength, std::vector<NaturalRun>& runs, _Compare comp)
+    {
+        size_t i = startIndex;
+        while (i < endIndex)
+        {
+            size_t run_start = i;
+            NaturalRunKind kind = NaturalRunKind::Ascending;
+            i++;
+            if (i < endIndex && comp(a[i], a[i - 1]))
+            {
+                kind = NaturalRunKind::Descending;
+                for (i++; i < endIndex && comp(a[i], a[i - 1]); i++);
+            }
+            else
+            {
+                for (; i < endIndex && !comp(a[i], a[i - 1]); i++);
+            }
+            if (i - run_start < minRunLength && !(run_start == startIndex && i == endIndex))
+                kind = NaturalRunKind::Unsorted;
+            natural_merge_sort_append_run(a, runs, NaturalRun{ run_start, i, kind }, comp);
+        }
+    }
+
+    // Copy of src[l .. r-1] to dst[l .. r-1] by a single level of parallel tasks
+    template< class _Type >
+    inline void natural_merge_sort_copy(const _Type* src, size_t l, size_t r, _Type* dst)
+    {
+        small_parallel_for_chunks(l, r, small_parallel_number_of_chunks(r - l, 64 * 1024), [&](size_t, size_t startIndex, size_t endIndex) {
+            std::copy(src + startIndex, src + endIndex, dst + startIndex);
+        });
+    }
+
+    // Reverse of a[l .. r-1], with each task swapping a chunk of the left half with its mirror in the right half
+    template< class _Type >
+    inline void natural_merge_sort_reverse(_Type* a, size_t l, size_t r)
+    {
+        size_t half = (r - l) / 2;
+        small_parallel_for_chunks(0, half, small_parallel_number_of_chunks(half, 64 * 1024), [&](size_t, size_t startIndex, size_t endIndex) {
+            for (size_t k = startIndex; k < endIndex; k++)
+                std::swap(a[l + k], a[r - 1 - k]);
+        });
+    }
+
+    // Parallel Natural Merge Sort of src[l .. r] (inclusive), using dst[l .. r] as the work buffer. The result is in dst when srcToDst is true, in src otherwise.
+    // 1. A parallel scan finds the runs in chunks of the array, which are joined across chunk boundaries.
+    // 2. Descending runs are reversed, and stretches of short runs are sorted by Parallel Merge Sort, all concurrently.
+    // 3. Runs are merged pairwise by the parallel merge, in rounds, alternating between src and dst. When the number of runs is odd,
+    //    the smallest run that keeps the pairs adjacent is the one carried to the next round by a copy.
+    // The order is given by comp.
+    template< class _Type, class _Compare, class = enable_if_compare<_Compare> >
+    inline void parallel_natural_merge_sort(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp, size_t minRunLength = 0)
+    {
+        if (r < l)  return;
+        size_t size = r - l + 1;
+        if (minRunLength == 0)
+            minRunLength = std::max(size / 1024, (size_t)1024);     // at most about 1024 long runs, which are 10 rounds of merging
+
+        size_t number_of_chunks = small_parallel_number_of_chunks(size, 64 * 1024);
+        std::vector< std::vector<NaturalRun> > runs_of_chunk(number_of_chunks);
+        small_parallel_for_chunks(l, r + 1, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            natural_merge_sort_find_runs(src, startIndex, endIndex, minRunLength, runs_of_chunk[c], comp);
+        });
+        std::vector<NaturalRun> runs;
+        for (auto& runs_in_chunk : runs_of_chunk)
+            for (auto& run : runs_in_chunk)
+                natural_merge_sort_append_run(src, runs, run, comp);
+
+        {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            Concurrency::task_group g;
+#else
+            tbb::task_group g;
+#endif
+            for (auto& run : runs)
+            {
+                if (run.kind == NaturalRunKind::Descending)
+                    g.run([=] { natural_merge_sort_reverse(src, run.start, run.end); });
+                else if (run.kind == NaturalRunKind::Unsorted)
+                    g.run([=] { parallel_merge_sort_hybrid_rh_1(src, run.start, run.end - 1, dst, false, comp); });
+            }
+            g.wait();
+        }
+        // runs which are now sorted may continue each other
+        std::vector<NaturalRun> sorted_runs;
+        for (auto& run : runs)
+            natural_merge_sort_append_run(src, sorted_runs, NaturalRun{ run.start, run.end, NaturalRunKind::Ascending }, comp);
+
+        _Type* from = src;
+        _Type* to   = dst;
+        while (sorted_runs.size() > 1)
+        {
+            size_t number_of_runs = sorted_runs.size();
+            size_t carried_run = number_of_runs;        // none
+            if (number_of_runs % 2 == 1)
+            {
+                carried_run = 0;
+                for (size_t i = 2; i < number_of_runs; i += 2)
+                    if (sorted_runs[i].end - sorted_runs[i].start < sorted_runs[carried_run].end - sorted_runs[carried_run].start)
+                        carried_run = i;
+            }
+            std::vector<NaturalRun> merged_runs;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            Concurrency::task_group g;
+#else
+            tbb::task_group g;
+#endif
+            for (size_t i = 0; i < number_of_runs; )
+            {
+                NaturalRun left = sorted_runs[i];
+                if (i == carried_run)
+                {
+                    g.run([=] { natural_merge_sort_copy(from, left.start, left.end, to); });
+                    merged_runs.push_back(left);
+                    i += 1;
+                    continue;
+                }
+                NaturalRun right = sorted_runs[i + 1];
+                g.run([=] { merge_parallel_L5(from, left.start, left.end - 1, right.start, right.end - 1, to, left.start, comp); });
+                merged_runs.push_back(NaturalRun{ left.start, right.end, NaturalRunKind::Ascending });
+                i += 2;
+            }
+            g.wait();
+            sorted_runs.swap(merged_runs);
+            std::swap(from, to);
+        }
+
+        _Type* result = srcToDst ? dst : src;
+        if (from != result)
+            natural_merge_sort_copy(from, l, r + 1, result);
+    }
+
+    template< class _Type >
+    inline void parallel_natural_merge_sort(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true, size_t minRunLength = 0)
+    {
+        parallel_natural_merge_sort(src, l, r, dst, srcToDst, std::less<>(), minRunLength);
+    }
+
+    // In-place interface: sorts src[l .. r-1], allocating a work buffer only when there is more than one run to merge or sort.
+    // A presorted array is not written to
+    template< class _Type, class _Compare >
+    inline void parallel_natural_merge_sort(_Type* src, size_t l, size_t r, _Compare comp)
+    {
+        if (r <= l + 1)
+            return;
+        bool is_sorted = true;
+        // one parallel scan, which also finds a strictly descending array, that only needs a reverse
+        size_t size = r - l;
+        size_t number_of_chunks = small_parallel_number_of_chunks(size, 64 * 1024);
+        bool ascending[SmallParallelMaxChunks], descending[SmallParallelMaxChunks];
+        small_parallel_for_chunks(l, r, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            size_t last = std::min(endIndex + 1, r);       // include the boundary to the next chunk
+            ascending[c]  = std::is_sorted(src + startIndex, src + last, comp);
+            descending[c] = true;
+            for (size_t i = startIndex + 1; i < last && descending[c]; i++)
+                descending[c] = comp(src[i], src[i - 1]);
+        });
+        bool is_descending = true;
+        for (size_t c = 0; c < number_of_chunks; c++)
+        {
+            is_sorted     = is_sorted     && ascending[c];
+            is_descending = is_descending && descending[c];
+        }
+        if (is_sorted)
+            return;
+        if (is_descending)
+        {
+            natural_merge_sort_reverse(src, l, r);
+            return;
+        }
+        WorkBuffer<_Type> work(r - l);
+        if (!work)
+            throw std::bad_alloc();
+        parallel_natural_merge_sort(src + l, 0, r - l - 1, work.data(), false, comp);
+    }
+
+    template< class _Type, class _Compare, class _Projection >
+    inline void parallel_natural_merge_sort(_Type* src, size_t l, size_t r, _Compare comp, _Projection proj)
+    {
+        parallel_natural_merge_sort(src, l, r, make_projected_compare(comp, proj));
+    }
+
+    template< class _Type >
+    inline void parallel_natural_merge_sort(_Type* src, size_t l, size_t r)
+    {
+        parallel_natural_merge_sort(src, l, r, std::less<>());
+    }
+
+    template< class _Type >
+    inline void parallel_natural_merge_sort(std::vector<_Type>& src)
+    {
+        parallel_natural_merge_sort(src.data(), 0, src.size());
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_natural_merge_sort(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_natural_merge_sort(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "NaturalMergeSort.h"
+#include "SortParallel.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Random, presorted, constant, descending, and presorted with a random tail of 1%, by Parallel Merge Sort versus Parallel Natural Merge Sort,
+// and by the adaptive sort_par, with the algorithm it chose
+int NaturalMergeSortBenchmark(vector<unsigned long>& ulongs)
+{
+	const char* inputNames[] = { "random", "presorted", "constant", "descending", "presorted with 1% random tail" };
+	vector<unsigned long> input(ulongs.size());
+	vector<unsigned long> sorted_reference(ulongs.size());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	vector<unsigned long> work(ulongs.size());
+	size_t tail_start = ulongs.size() - ulongs.size() / 100;
+
+	for (int inputType = 0; inputType < 5; inputType++)
+	{
+		for (size_t j = 0; j < ulongs.size(); j++)
+		{
+			switch (inputType)
+			{
+			case 0:  input[j] = ulongs[j];                                   break;
+			case 1:  input[j] = j;                                           break;
+			case 2:  input[j] = 42;                                          break;
+			case 3:  input[j] = ulongs.size() - j;                           break;
+			default: input[j] = j < tail_start ? j : ulongs[j] % tail_start; break;
+			}
+		}
+		printf("%s input\n", inputNames[inputType]);
+
+		for (int i = 0; i < iterationCount; ++i)
+		{
+			std::copy(input.begin(), input.end(), sorted_reference.begin());
+			auto startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(sorted_reference.data(), 0, sorted_reference.size() - 1, work.data(), false);
+			auto endTime = high_resolution_clock::now();
+			print_results("Parallel Merge Sort        ", sorted_reference.data(), ulongs.size(), startTime, endTime);
+
+			std::copy(input.begin(), input.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_natural_merge_sort(ulongsCopy);
+			endTime = high_resolution_clock::now();
+			print_results("Parallel Natural Merge Sort", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+			if (sorted_reference != ulongsCopy)
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+
+			std::copy(input.begin(), input.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::sort_par(ulongsCopy);
+			endTime = high_resolution_clock::now();
+			print_results("Adaptive sort_par          ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+			printf("sort_par chose %s\n", ParallelAlgorithms::sort_algorithm_name(ParallelAlgorithms::last_sort_decision().algorithm));
+			if (sorted_reference != ulongsCopy)
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+		}
+	}
+	return 0;
+}
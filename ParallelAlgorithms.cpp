@@ -29,6 +29,26 @@ extern int CountingSortBenchmark(vector<unsigned long>& ulongs);
 extern int SumBenchmark(vector<unsigned long>& ulongs);
 extern int SumBenchmarkChar(vector<unsigned long>& ulongs);
 extern int TestMemoryAllocation();
+extern int ExternalSortBenchmark(vector<unsigned long>& ulongs);
+extern int MemoryMappedSortBenchmark(vector<unsigned long>& ulongs);
+extern int PartialSortBenchmark(vector<unsigned long>& ulongs);
+extern int RadixSelectBenchmark(vector<unsigned long>& ulongs);
+extern int ApplyPermutationBenchmark(vector<unsigned long>& ulongs);
+extern int ColumnarSortBenchmark(vector<unsigned long>& ulongs);
+extern int SegmentedSortBenchmark(vector<unsigned long>& ulongs);
+extern int SortingNetworkBenchmark(vector<unsigned long>& ulongs);
+extern int SmallParallelBenchmark(vector<unsigned long>& ulongs);
+extern int WorkBufferPoolBenchmark(vector<unsigned long>& ulongs);
+extern int PrefaultBenchmark(vector<unsigned long>& ulongs);
+extern int HugePageBenchmark(vector<unsigned long>& ulongs);
+extern int BoundedBufferBenchmark(vector<unsigned long>& ulongs);
+extern int InplaceMergeBenchmark(vector<unsigned long>& ulongs);
+extern int InplaceThresholdBenchmark(vector<unsigned long>& ulongs);
+extern int RotateBenchmark(vector<unsigned long>& ulongs);
+extern int ParallelOptionsBenchmark(vector<unsigned long>& ulongs);
+extern int MemoryBoundBenchmark(vector<unsigned long>& ulongs);
+extern int NaturalMergeSortBenchmark(vector<unsigned long>& ulongs);
+extern int ComparatorBenchmark(vector<unsigned long>& ulongs);
 extern void TestLazyMemoryAllocation();
 
 
@@ -113,6 +133,27 @@ int main()
 #if 1
 	RadixSortMsdBenchmark(ulongs);
 
+	//ExternalSortBenchmark(ulongs);	// sorts a file on disk, using a memory budget smaller than the file
+	//MemoryMappedSortBenchmark(ulongs);	// sorts a file on disk in place, through a memory mapping of the file
+	//PartialSortBenchmark(ulongs);		// smallest K of N elements, across a range of K/N ratios
+	//RadixSelectBenchmark(ulongs);		// nth_element and 100 quantiles, without sorting
+	//ApplyPermutationBenchmark(ulongs);	// argsort of a key column, then reordering another column by the permutation
+	//ColumnarSortBenchmark(ulongs);		// table of separate column arrays, sorted by several key columns
+	//SegmentedSortBenchmark(ulongs);	// batch of many small independent arrays in one buffer
+	//SortingNetworkBenchmark(ulongs);	// small arrays, as at the leaves of recursive sorts, by Insertion Sort and Sorting Networks
+	//SmallParallelBenchmark(ulongs);	// 1K to 1M elements: serial, recursive parallel and single level of parallel tasks
+	//NaturalMergeSortBenchmark(ulongs);	// random, presorted, constant, descending, and presorted with a random tail
+	//ComparatorBenchmark(ulongs);			// operator<, std::less and std::greater, records by key, and case-insensitive strings
+	//WorkBufferPoolBenchmark(ulongs);		// repeated sorts of 1K to 1M elements, with and without reuse of the work buffer
+	//PrefaultBenchmark(ulongs);				// LSD Radix Sort work buffer faulted in during the sort, serially, in parallel, and by MAP_POPULATE
+	//HugePageBenchmark(ulongs);				// LSD Radix Sort and Parallel Merge Sort with the arrays in 4KB pages and in transparent huge pages
+	//BoundedBufferBenchmark(ulongs);			// Stable Parallel Merge Sort with buffers of N, 1% of N, sqrt(N) and no elements
+	//InplaceMergeBenchmark(ulongs);			// linear-time and O(n log n) truly in-place merges, serial and parallel, and std::inplace_merge
+	//InplaceThresholdBenchmark(ulongs);		// leaf and parallel threshold sweep of the in-place merge sorts, next to the derived thresholds
+	//RotateBenchmark(ulongs);				// std::rotate, parallel three reversals, and the block swap rotations built on memswap
+	//ParallelOptionsBenchmark(ulongs);		// sort, reduce and fill limited to a number of threads, or to physical cores, by ParallelOptions
+	//MemoryBoundBenchmark(ulongs);			// fill, sum, histogram, LSD Radix Sort and merge on all hardware threads, and on physical cores only
+
 	//CountingSortBenchmark(ulongs);	// sorts uchar's and not ulongs
 
 	//SumBenchmarkChar(ulongs);
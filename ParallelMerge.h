@@ -9,6 +9,12 @@
 
 #include "InsertionSort.h"
 #include "BinarySearch.h"
+#include "ProjectedCompare.h"
+#include "MemoryBudget.h"
+#include "BoundedBufferMergeSort.h"
+#include "InplaceMerge.h"
+#include "ParallelRotate.h"
+#include "ParallelOptions.h"
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
 #include <ppl.h>
 #else
@@ -49,12 +55,13 @@ inline void merge_ptr(const _Type* a_start, const _Type* a_end, const _Type* b_s
 }
 // Faster Merge: see https://duvanenko.tech.blog/2018/07/25/faster-serial-merge-in-c-and-c/
 // _end pointer point not to the last element, but one past and never access it - i.e. _end is not included
-template< class _Type >
-inline void merge_ptr_1(const _Type* a_start, const _Type* a_end, const _Type* b_start, const _Type* b_end, _Type* dst)
+// The order is given by comp, with *a_start <= *b_start being !comp(*b_start, *a_start)
+template< class _Type, class _Compare >
+inline void merge_ptr_1(const _Type* a_start, const _Type* a_end, const _Type* b_start, const _Type* b_end, _Type* dst, _Compare comp)
 {
 	if (a_start < a_end && b_start < b_end) {
 		while (true) {
-			if (*a_start <= *b_start) {
+			if (!comp(*b_start, *a_start)) {
 				*dst++ = *a_start++;
 				if (a_start >= a_end)	break;
 			}
@@ -68,6 +75,11 @@ inline void merge_ptr_1(const _Type* a_start, const _Type* a_end, const _Type* b
 	while (b_start < b_end)	*dst++ = *b_start++;
 }
 template< class _Type >
+inline void merge_ptr_1(const _Type* a_start, const _Type* a_end, const _Type* b_start, const _Type* b_end, _Type* dst)
+{
+	merge_ptr_1(a_start, a_end, b_start, b_end, dst, std::less<>());
+}
+template< class _Type >
 inline void merge_ptr_1_unrolled(const _Type* a_start, const _Type* a_end, const _Type* b_start, const _Type* b_end, _Type* dst)
 {
 	if (a_start < a_end && b_start < b_end) {
@@ -251,8 +263,8 @@ inline void merge_parallel_L3(_Type* t, int p1, int r1, int p2, int r2, _Type* a
 
 // Listing 4
 // The hybrid divide-and-conquer algorithm implementation
-template< class _Type >
-inline void merge_dac_hybrid(const _Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3)
+template< class _Type, class _Compare >
+inline void merge_dac_hybrid(const _Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3, _Compare comp)
 {
 	size_t length1 = r1 - p1 + 1;
 	size_t length2 = r2 - p2 + 1;
@@ -264,20 +276,27 @@ inline void merge_dac_hybrid(const _Type* t, size_t p1, size_t r1, size_t p2, si
 	}
 	if (length1 == 0) return;
 	if ((length1 + length2) <= 8192)
-		merge_ptr_1(&t[p1], &t[p1 + length1], &t[p2], &t[p2 + length2], &a[p3]);
+		merge_ptr_1(&t[p1], &t[p1 + length1], &t[p2], &t[p2 + length2], &a[p3], comp);
 	else {
 		size_t q1 = p1 / 2 + r1 / 2 + (p1 % 2 + r1 % 2) / 2;	// average without overflow
-		size_t q2 = my_binary_search(t[q1], t, p2, r2);
+		size_t q2 = my_binary_search(t[q1], t, p2, r2, comp);
 		size_t q3 = p3 + (q1 - p1) + (q2 - p2);
 		a[q3] = t[q1];
-		merge_dac_hybrid(t, p1, q1 - 1, p2, q2 - 1, a, p3);
-		merge_dac_hybrid(t, q1 + 1, r1, q2, r2, a, q3 + 1);
+		merge_dac_hybrid(t, p1, q1 - 1, p2, q2 - 1, a, p3, comp);
+		merge_dac_hybrid(t, q1 + 1, r1, q2, r2, a, q3 + 1, comp);
 	}
 }
 
-// Listing 5
 template< class _Type >
-inline void merge_parallel_L5(_Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3, size_t parallel_threshold = 32768)
+inline void merge_dac_hybrid(const _Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3)
+{
+	merge_dac_hybrid(t, p1, r1, p2, r2, a, p3, std::less<>());
+}
+
+// Listing 5
+// The order is given by comp, such as std::greater<>() for descending order, or make_projected_compare(comp, proj) to compare a member of each element
+template< class _Type, class _Compare, class = ParallelAlgorithms::enable_if_compare<_Compare> >
+inline void merge_parallel_L5(_Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3, _Compare comp, size_t parallel_threshold = 32768)
 {
 	size_t length1 = r1 - p1 + 1;
 	size_t length2 = r2 - p2 + 1;
@@ -289,12 +308,12 @@ inline void merge_parallel_L5(_Type* t, size_t p1, size_t r1, size_t p2, size_t
 	if (length1 == 0)	return;
 	if ((length1 + length2) <= parallel_threshold) {	// 8192 threshold is much better than 16. 32K seems to be an even better threshold
 		//merge_ptr( &t[ p1 ], &t[ p1 + length1 ], &t[ p2 ], &t[ p2 + length2 ], &a[ p3 ] );	// in DDJ paper
-		merge_ptr_1(&t[p1], &t[p1 + length1], &t[p2], &t[p2 + length2], &a[p3]);				// slightly faster than merge_ptr version due to fewer loop comparisons
+		merge_ptr_1(&t[p1], &t[p1 + length1], &t[p2], &t[p2 + length2], &a[p3], comp);				// slightly faster than merge_ptr version due to fewer loop comparisons
 		//merge_ptr_3(&t[p1], &t[p1 + length1], &t[p2], &t[p2 + length2], &a[p3]);				// new merge concept, which turned out slower
 	}
 	else {
 		size_t q1 = p1 / 2 + r1 / 2 + (p1 % 2 + r1 % 2) / 2;   // average without overflow
-		size_t q2 = my_binary_search(t[q1], t, p2, r2);
+		size_t q2 = my_binary_search(t[q1], t, p2, r2, comp);
 		size_t q3 = p3 + (q1 - p1) + (q2 - p2);
 		a[q3] = t[q1];
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
@@ -302,12 +321,24 @@ inline void merge_parallel_L5(_Type* t, size_t p1, size_t r1, size_t p2, size_t
 #else
 		tbb::parallel_invoke(
 #endif
-			[&] { merge_parallel_L5(t, p1,     q1 - 1, p2, q2 - 1, a, p3    ); },
-			[&] { merge_parallel_L5(t, q1 + 1, r1,     q2, r2,     a, q3 + 1); }
+			[&] { merge_parallel_L5(t, p1,     q1 - 1, p2, q2 - 1, a, p3,     comp, parallel_threshold); },
+			[&] { merge_parallel_L5(t, q1 + 1, r1,     q2, r2,     a, q3 + 1, comp, parallel_threshold); }
 		);
 	}
 }
 
+template< class _Type >
+inline void merge_parallel_L5(_Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3, size_t parallel_threshold = 32768)
+{
+	merge_parallel_L5(t, p1, r1, p2, r2, a, p3, std::less<>(), parallel_threshold);
+}
+
+template< class... _Args >
+inline decltype(auto) merge_parallel_L5(const ParallelAlgorithms::ParallelOptions& options, _Args&&... args)
+{
+	return ParallelAlgorithms::run_with_options(options, [&]() -> decltype(auto) { return ::merge_parallel_L5(std::forward<_Args>(args)...); });
+}
+
 template< class _Type >
 inline void merge_parallel_quad(_Type* t, size_t p1, size_t r1, size_t p2, size_t r2, _Type* a, size_t p3)
 {
@@ -410,7 +441,8 @@ inline void merge_truly_in_place(_Type* t, size_t l, size_t m, size_t r)
 		//		block_exchange_7< 16 >( t, q1, m, q2 - 1 );
 		//		block_exchange_mirror_reverse_order(( t, q1, m, q2 - 1 );
 		//		p_block_exchange( t, q1, m, q2 - 1 );
-		block_exchange_mirror_1(t, q1, m, q2 - 1);		// 2X speedup
+		//block_exchange_mirror_1(t, q1, m, q2 - 1);		// 2X speedup
+		ParallelAlgorithms::rotate_serial(t + q1, t + m + 1, t + q2);
 		//block_exchange_mirror_par(t, q1, m, q2 - 1);
 		//		block_exchange_juggling_Bentley( &t[ q1 ], q1 - q1, m - q1, q2 - 1 - q1 );
 		//		block_swap_Bentley( &t[ q1 ], q1 - q1, m - q1, q2 - 1 - q1 );
@@ -425,12 +457,13 @@ inline void merge_truly_in_place(_Type* t, size_t l, size_t m, size_t r)
 		//      if ((length1 + length2) <= 1024) { std::inplace_merge(t + l, t + m + 1, t + r + 1);  return; }
 		//		if ( length2 < 1024 )	{ merge_inplace_reverse< 1024 >( t, l, m, r );  return; }	
 		size_t q1 = (m + 1) / 2 + r / 2 + ((m % 2 ) + r % 2) / 2;							// q1 is mid-point of the larger segment
-		size_t q2 = my_binary_search(t[q1], t, l, m);		// q2 is q1 partitioning element within the smaller sub-array (and q2 itself is part of the sub-array that does not move)
+		size_t q2 = std::upper_bound(t + l, t + m + 1, t[q1]) - t;	// q2 is q1 partitioning element within the smaller sub-array, past the elements equal to t[q1] to keep the merge stable
 		size_t q3 = q2 + (q1 - m - 1);
 		//		block_exchange_7< 16 >( t, q2, m, q1 );
 		//		block_exchange_mirror_reverse_order(( t, q2, m, q1 );
 		//		p_block_exchange( t, q2, m, q1 );
-		block_exchange_mirror_1(t, q2, m, q1);			// 2X speedup
+		//block_exchange_mirror_1(t, q2, m, q1);			// 2X speedup
+		ParallelAlgorithms::rotate_serial(t + q2, t + m + 1, t + q1 + 1);
 		//block_exchange_mirror_par(t, q2, m, q1);
 		//		block_exchange_juggling_Bentley( &t[ q2 ], q2 - q2, m - q2, q1 - q2 );
 		//		block_swap_Bentley( &t[ q2 ], q2 - q2, m - q2, q1 - q2 );
@@ -473,7 +506,7 @@ inline void merge_in_place(_Type* t, int l, int m, int r)
 		if ((length1 + length2) <= 1024) { std::inplace_merge(t + l, t + m + 1, t + r + 1);  return; }
 		//		if ( length2 < 1024 )	{ merge_inplace_reverse< 1024 >( t, l, m, r );  return; }	
 		int q1 = (m + 1 + r) / 2;							// q1 is mid-point of the larger segment
-		int q2 = my_binary_search(t[q1], t, l, m);		// q2 is q1 partitioning element within the smaller sub-array (and q2 itself is part of the sub-array that does not move)
+		int q2 = (int)(std::upper_bound(t + l, t + m + 1, t[q1]) - t);	// q2 is q1 partitioning element within the smaller sub-array, past the elements equal to t[q1] to keep the merge stable
 		int q3 = q2 + (q1 - m - 1);
 		//		block_exchange_7< 16 >( t, q2, m, q1 );
 		//		block_exchange_mirror_reverse_order(( t, q2, m, q1 );
@@ -491,7 +524,7 @@ inline void merge_in_place(_Type* t, int l, int m, int r)
 // Based on not-in-place algorithm in 3rd ed. of "Introduction to Algorithms" p. 798-802, extending it to be in-place
 // and my Dr. Dobb's paper https://www.drdobbs.com/parallel/parallel-in-place-merge/240008783 or https://web.archive.org/web/20141217133856/http://www.drdobbs.com/parallel/parallel-in-place-merge/240008783
 template< class _Type >
-inline void p_merge_in_place_2(_Type* t, size_t l, size_t m, size_t r)
+inline void p_merge_in_place_2(_Type* t, size_t l, size_t m, size_t r, size_t parallelThreshold = 32 * 1024)
 {
 	size_t length1 = m - l + 1;
 	size_t length2 = r - m;
@@ -510,17 +543,26 @@ inline void p_merge_in_place_2(_Type* t, size_t l, size_t m, size_t r)
 		//		block_exchange_mirror_reverse_order(( t, q1, m, q2 - 1 );
 		//		p_block_exchange( t, q1, m, q2 - 1 );
 		//block_exchange_mirror(t, q1, m, q2 - 1);		// 2X speedup
-		block_exchange_mirror_par(t, q1, m, q2 - 1);
+		//block_exchange_mirror_par(t, q1, m, q2 - 1);
+		ParallelAlgorithms::rotate_par(t + q1, t + m + 1, t + q2, std::max(parallelThreshold, ParallelAlgorithms::RotateParallelThreshold));
 //		block_exchange_juggling_Bentley( &t[ q1 ], q1 - q1, m - q1, q2 - 1 - q1 );
 //		block_swap_Bentley( &t[ q1 ], q1 - q1, m - q1, q2 - 1 - q1 );
+		if ((length1 + length2) < parallelThreshold)
+		{
+			p_merge_in_place_2(t, l,      q1 - 1, q3 - 1, parallelThreshold);	// note that q3 is now in its final place and no longer participates in further processing
+			p_merge_in_place_2(t, q3 + 1, q2 - 1, r,      parallelThreshold);
+		}
+		else
+		{
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
-		Concurrency::parallel_invoke(
+			Concurrency::parallel_invoke(
 #else
-		tbb::parallel_invoke(
+			tbb::parallel_invoke(
 #endif
-			[&] { p_merge_in_place_2(t, l,      q1 - 1, q3 - 1); },	// note that q3 is now in its final place and no longer participates in further processing
-			[&] { p_merge_in_place_2(t, q3 + 1, q2 - 1, r     ); }
-		);
+				[&] { p_merge_in_place_2(t, l,      q1 - 1, q3 - 1, parallelThreshold); },	// note that q3 is now in its final place and no longer participates in further processing
+				[&] { p_merge_in_place_2(t, q3 + 1, q2 - 1, r,      parallelThreshold); }
+			);
+		}
 	}
 	else {
 		if (length1 <= 0)	return;
@@ -530,23 +572,32 @@ inline void p_merge_in_place_2(_Type* t, size_t l, size_t m, size_t r)
 		if ((length1 + length2) <= 1024) { std::inplace_merge(t + l, t + m + 1, t + r + 1);  return; }
 		//		if ( length2 < 1024 )	{ merge_inplace_reverse< 1024 >( t, l, m, r );  return; }	
 		size_t q1 = (m + 1) / 2 + r / 2 + ((m + 1) % 2 + r % 2) / 2;	// q1 is mid-point of the larger segment
-		size_t q2 = my_binary_search(t[q1], t, l, m);					// q2 is q1 partitioning element within the smaller sub-array (and q2 itself is part of the sub-array that does not move)
+		size_t q2 = std::upper_bound(t + l, t + m + 1, t[q1]) - t;	// q2 is q1 partitioning element within the smaller sub-array, past the elements equal to t[q1] to keep the merge stable
 		size_t q3 = q2 + (q1 - m - 1);
 		//		block_exchange_7< 16 >( t, q2, m, q1 );
 		//		block_exchange_mirror_reverse_order(( t, q2, m, q1 );
 		//		p_block_exchange( t, q2, m, q1 );
 		//block_exchange_mirror(t, q2, m, q1);			// 2X speedup
-		block_exchange_mirror_par(t, q2, m, q1);
+		//block_exchange_mirror_par(t, q2, m, q1);
+		ParallelAlgorithms::rotate_par(t + q2, t + m + 1, t + q1 + 1, std::max(parallelThreshold, ParallelAlgorithms::RotateParallelThreshold));
 //		block_exchange_juggling_Bentley( &t[ q2 ], q2 - q2, m - q2, q1 - q2 );
 //		block_swap_Bentley( &t[ q2 ], q2 - q2, m - q2, q1 - q2 );
+		if ((length1 + length2) < parallelThreshold)
+		{
+			p_merge_in_place_2(t, l, q2 - 1, q3 - 1, parallelThreshold);	// note that q3 is now in its final place and no longer participates in further processing
+			p_merge_in_place_2(t, q3 + 1, q1, r, parallelThreshold);
+		}
+		else
+		{
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
-		Concurrency::parallel_invoke(
+			Concurrency::parallel_invoke(
 #else
-		tbb::parallel_invoke(
+			tbb::parallel_invoke(
 #endif
-			[&] { p_merge_in_place_2(t, l, q2 - 1, q3 - 1); },	// note that q3 is now in its final place and no longer participates in further processing
-			[&] { p_merge_in_place_2(t, q3 + 1, q1, r); }
-		);
+				[&] { p_merge_in_place_2(t, l, q2 - 1, q3 - 1, parallelThreshold); },	// note that q3 is now in its final place and no longer participates in further processing
+				[&] { p_merge_in_place_2(t, q3 + 1, q1, r, parallelThreshold); }
+			);
+		}
 	}
 }
 
@@ -583,7 +634,7 @@ inline void mergeInPlace(_Type* a, int l, int m, int r)
 // Based on not-in-place algorithm in 3rd ed. of "Introduction to Algorithms" p. 798-802, extending it to be in-place
 // and my Dr. Dobb's paper https://www.drdobbs.com/parallel/parallel-in-place-merge/240008783 or https://web.archive.org/web/20141217133856/http://www.drdobbs.com/parallel/parallel-in-place-merge/240008783
 template< class _Type >
-inline void p_merge_truly_in_place(_Type* t, size_t l, size_t m, size_t r)
+inline void p_merge_truly_in_place(_Type* t, size_t l, size_t m, size_t r, size_t parallelThreshold = 32 * 1024)
 {
 	size_t length1 = m - l + 1;
 	size_t length2 = r - m;
@@ -603,17 +654,26 @@ inline void p_merge_truly_in_place(_Type* t, size_t l, size_t m, size_t r)
 		//		block_exchange_mirror_reverse_order(( t, q1, m, q2 - 1 );
 		//		p_block_exchange( t, q1, m, q2 - 1 );
 		//      block_exchange_mirror(t, q1, m, q2 - 1);		// 2X speedup
-		block_exchange_mirror_par(t, q1, m, q2 - 1);
+		//block_exchange_mirror_par(t, q1, m, q2 - 1);
+		ParallelAlgorithms::rotate_par(t + q1, t + m + 1, t + q2, std::max(parallelThreshold, ParallelAlgorithms::RotateParallelThreshold));
 		//		block_exchange_juggling_Bentley( &t[ q1 ], q1 - q1, m - q1, q2 - 1 - q1 );
 		//		block_swap_Bentley( &t[ q1 ], q1 - q1, m - q1, q2 - 1 - q1 );
+		if ((length1 + length2) < parallelThreshold)
+		{
+			p_merge_truly_in_place(t, l, q1 - 1, q3 - 1, parallelThreshold);	// note that q3 is now in its final place and no longer participates in further processing
+			p_merge_truly_in_place(t, q3 + 1, q2 - 1, r, parallelThreshold);
+		}
+		else
+		{
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
-		Concurrency::parallel_invoke(
+			Concurrency::parallel_invoke(
 #else
-		tbb::parallel_invoke(
+			tbb::parallel_invoke(
 #endif
-			[&] { p_merge_truly_in_place(t, l, q1 - 1, q3 - 1); },	// note that q3 is now in its final place and no longer participates in further processing
-			[&] { p_merge_truly_in_place(t, q3 + 1, q2 - 1, r); }
-		);
+				[&] { p_merge_truly_in_place(t, l, q1 - 1, q3 - 1, parallelThreshold); },	// note that q3 is now in its final place and no longer participates in further processing
+				[&] { p_merge_truly_in_place(t, q3 + 1, q2 - 1, r, parallelThreshold); }
+			);
+		}
 	}
 	else {
 		if (length1 <= 0)	return;
@@ -624,26 +684,74 @@ inline void p_merge_truly_in_place(_Type* t, size_t l, size_t m, size_t r)
 		//      if ((length1 + length2) <= 1024) { std::inplace_merge(t + l, t + m + 1, t + r + 1);  return; }
 		//		if ( length2 < 1024 )	{ merge_inplace_reverse< 1024 >( t, l, m, r );  return; }	
 		size_t q1 = (m + 1) / 2 + r / 2 + ((m + 1) % 2 + r % 2) / 2;	// q1 is mid-point of the larger segment
-		size_t q2 = my_binary_search(t[q1], t, l, m);					// q2 is q1 partitioning element within the smaller sub-array (and q2 itself is part of the sub-array that does not move)
+		size_t q2 = std::upper_bound(t + l, t + m + 1, t[q1]) - t;	// q2 is q1 partitioning element within the smaller sub-array, past the elements equal to t[q1] to keep the merge stable
 		size_t q3 = q2 + (q1 - m - 1);
 		//		block_exchange_7< 16 >( t, q2, m, q1 );
 		//		block_exchange_mirror_reverse_order(( t, q2, m, q1 );
 		//		p_block_exchange( t, q2, m, q1 );
 		//     block_exchange_mirror(t, q2, m, q1);			// 2X speedup
-		block_exchange_mirror_par(t, q2, m, q1);
+		//block_exchange_mirror_par(t, q2, m, q1);
+		ParallelAlgorithms::rotate_par(t + q2, t + m + 1, t + q1 + 1, std::max(parallelThreshold, ParallelAlgorithms::RotateParallelThreshold));
 		//		block_exchange_juggling_Bentley( &t[ q2 ], q2 - q2, m - q2, q1 - q2 );
 		//		block_swap_Bentley( &t[ q2 ], q2 - q2, m - q2, q1 - q2 );
+		if ((length1 + length2) < parallelThreshold)
+		{
+			p_merge_truly_in_place(t, l, q2 - 1, q3 - 1, parallelThreshold);	// note that q3 is now in its final place and no longer participates in further processing
+			p_merge_truly_in_place(t, q3 + 1, q1, r, parallelThreshold);
+		}
+		else
+		{
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
-		Concurrency::parallel_invoke(
+			Concurrency::parallel_invoke(
 #else
-		tbb::parallel_invoke(
+			tbb::parallel_invoke(
 #endif
-			[&] { p_merge_truly_in_place(t, l, q2 - 1, q3 - 1); },	// note that q3 is now in its final place and no longer participates in further processing
-			[&] { p_merge_truly_in_place(t, q3 + 1, q1, r); }
-		);
+				[&] { p_merge_truly_in_place(t, l, q2 - 1, q3 - 1, parallelThreshold); },	// note that q3 is now in its final place and no longer participates in further processing
+				[&] { p_merge_truly_in_place(t, q3 + 1, q1, r, parallelThreshold); }
+			);
+		}
 	}
 }
 
+// Splits [first, middle) and [middle, last) at the middle of their merged output by co-rank, swaps the two middle blocks with a parallel rotation,
+// and merges the two halves independently, down to parts of threshold elements, which are merged by the linear-time in-place merge
+template< class _Type, class _Compare >
+inline void p_merge_linear_in_place_inner(_Type* first, _Type* middle, _Type* last, _Compare comp, size_t threshold)
+{
+	size_t length1 = middle - first;
+	size_t length2 = last - middle;
+	if (length1 == 0 || length2 == 0)	return;
+	if ((length1 + length2) <= threshold) { InplaceMerge(first, middle, last, comp);  return; }
+
+	size_t k = (length1 + length2) / 2;
+	size_t i = ParallelAlgorithms::small_parallel_merge_split(first, length1, middle, length2, k, comp);	// first[ 0 .. i-1 ] and middle[ 0 .. k-i-1 ] are the first k of the output
+	size_t j = k - i;
+	if (i < length1 && j > 0)
+		ParallelAlgorithms::rotate_par(first + i, middle, middle + j, std::max(threshold, ParallelAlgorithms::RotateParallelThreshold));
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+	Concurrency::parallel_invoke(
+#else
+	tbb::parallel_invoke(
+#endif
+		[&] { p_merge_linear_in_place_inner(first,     first + i,                  first + k, comp, threshold); },
+		[&] { p_merge_linear_in_place_inner(first + k, first + k + (length1 - i), last,      comp, threshold); }
+	);
+}
+
+// Truly in-place parallel merge of t[ l .. m ] and t[ m + 1 .. r ] in O(n) work, using the linear-time in-place merge of Huang and Langston
+// from InplaceMerge.h for each part. Not stable. Each core gets at least one part, and no part is smaller than parallelThreshold
+template< class _Type, class _Compare >
+inline void p_merge_linear_in_place(_Type* t, size_t l, size_t m, size_t r, _Compare comp, size_t parallelThreshold = 32 * 1024)
+{
+	size_t threshold = std::max((r - l + 1) / ParallelAlgorithms::small_parallel_processor_count(), parallelThreshold);
+	p_merge_linear_in_place_inner(t + l, t + m + 1, t + r + 1, comp, threshold);
+}
+template< class _Type >
+inline void p_merge_linear_in_place(_Type* t, size_t l, size_t m, size_t r)
+{
+	p_merge_linear_in_place(t, l, m, r, std::less<>());
+}
+
 template< class _Type >
 inline void p_merge_in_place_adaptive(_Type* src, size_t l, size_t m, size_t r)
 {
@@ -661,63 +769,97 @@ inline void p_merge_in_place_adaptive(_Type* src, size_t l, size_t m, size_t r)
 	}
 }
 
+// Merge with a bounded buffer of sqrt(N) or 1% of N elements when that fits in the memory budget, and truly in-place merge otherwise.
+// Used by the preventative-adaptive merges when the buffer of N elements does not fit
 template< class _Type >
-inline void merge_inplace_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, double physical_memory_threshold = 0.75)
+inline void merge_bounded_buffer_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, ParallelAlgorithms::MemoryBudget& budget, bool parallel)
 {
-	double physical_memory_fraction = (double)physical_memory_used_in_megabytes() / (double)physical_memory_total_in_megabytes();
-	//printf("merge_inplace_preventative_adaptive: physical memory used = %llu   physical memory total = %llu\n",
-	//	physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes());
+	size_t buffer_size = ParallelAlgorithms::bounded_buffer_size(r - l + 1);
+	if (!budget.try_reserve(sizeof(_Type) * buffer_size))
+		buffer_size = 0;
+	_Type* buffer = buffer_size > 0 ? new(std::nothrow) _Type[buffer_size] : nullptr;
 
-	if (physical_memory_fraction > physical_memory_threshold)
+	if (!buffer)
 	{
 		//printf("Running purely in-place merge\n");
-		merge_truly_in_place(src, l, m, r);
+		if (parallel)
+			p_merge_truly_in_place(src, l, m, r);
+		else
+			merge_truly_in_place(src, l, m, r);
 	}
 	else
 	{
-		size_t src_size = r - l + 1;
-		_Type* merged = new(std::nothrow) _Type[src_size];
-
-		if (!merged)
-			merge_truly_in_place(src, l, m, r);
+		//printf("Running bounded buffer merge\n");
+		if (parallel)
+			ParallelAlgorithms::p_merge_bounded_buffer(src, l, m, r, buffer, buffer_size);
 		else
-		{
-			merge_ptr_1(src + l, src + m + 1, src + m + 1, src + r + 1, merged + 0);
-			std::copy(merged + 0, merged + src_size, src + l);
-			delete[] merged;
-		}
+			ParallelAlgorithms::merge_bounded_buffer(src, l, m, r, buffer, buffer_size);
+		delete[] buffer;
 	}
+	budget.release(sizeof(_Type) * buffer_size);
 }
 
+// Not-in-place merge when its buffer fits in the memory budget, merge with a bounded buffer when that fits, and truly in-place merge otherwise
 template< class _Type >
-inline void p_merge_in_place_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, double physical_memory_threshold_post = 0.75)
+inline void merge_inplace_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, ParallelAlgorithms::MemoryBudget& budget)
 {
 	size_t src_size = r - l + 1;
-	size_t anticipated_memory_usage = sizeof(_Type) * src_size / (size_t)(1024 * 1024) + physical_memory_used_in_megabytes();
-	double physical_memory_fraction = (double)anticipated_memory_usage / (double)physical_memory_total_in_megabytes();
-	//printf("p_merge_in_place_preventative_adaptive: physical memory used = %llu   physical memory total = %llu   anticipated memory used = %llu\n",
-	//	physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes(), anticipated_memory_usage);
-
-	if (physical_memory_fraction > physical_memory_threshold_post)
+	if (!budget.try_reserve(sizeof(_Type) * src_size))
 	{
-		//printf("Running purely in-place parallel merge\n");
-		p_merge_truly_in_place(src, l, m, r);
+		merge_bounded_buffer_preventative_adaptive(src, l, m, r, budget, false);
+		return;
 	}
+	_Type* merged = new(std::nothrow) _Type[src_size];
+
+	if (!merged)
+		merge_bounded_buffer_preventative_adaptive(src, l, m, r, budget, false);
 	else
 	{
-		_Type* merged = new(std::nothrow) _Type[src_size];
+		merge_ptr_1(src + l, src + m + 1, src + m + 1, src + r + 1, merged + 0);
+		std::copy(merged + 0, merged + src_size, src + l);
+		delete[] merged;
+	}
+	budget.release(sizeof(_Type) * src_size);
+}
 
-		if (!merged)
-			p_merge_truly_in_place(src, l, m, r);
-		else
-		{
-			//printf("Running not-in-place parallel merge\n");
-			merge_parallel_L5(src, l, m, m + 1, r, merged, 0);
-			std::copy(merged + 0, merged + src_size, src + l);
-			delete[] merged;
-		}
+template< class _Type >
+inline void merge_inplace_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, double physical_memory_threshold = 0.75)
+{
+	ParallelAlgorithms::MemoryBudget budget = ParallelAlgorithms::system_memory_budget(physical_memory_threshold);
+	merge_inplace_preventative_adaptive(src, l, m, r, budget);
+}
+
+// Parallel not-in-place merge when its buffer fits in the memory budget, parallel merge with a bounded buffer when that fits,
+// and parallel truly in-place merge otherwise.
+// Concurrent merges of the same sort share the budget, each reserving its buffer
+template< class _Type >
+inline void p_merge_in_place_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, ParallelAlgorithms::MemoryBudget& budget)
+{
+	size_t src_size = r - l + 1;
+	if (!budget.try_reserve(sizeof(_Type) * src_size))
+	{
+		merge_bounded_buffer_preventative_adaptive(src, l, m, r, budget, true);
+		return;
 	}
+	_Type* merged = new(std::nothrow) _Type[src_size];
+
+	if (!merged)
+		merge_bounded_buffer_preventative_adaptive(src, l, m, r, budget, true);
+	else
+	{
+		//printf("Running not-in-place parallel merge\n");
+		merge_parallel_L5(src, l, m, m + 1, r, merged, 0);
+		std::copy(merged + 0, merged + src_size, src + l);
+		delete[] merged;
+	}
+	budget.release(sizeof(_Type) * src_size);
 }
 
+template< class _Type >
+inline void p_merge_in_place_preventative_adaptive(_Type* src, size_t l, size_t m, size_t r, double physical_memory_threshold_post = 0.75)
+{
+	ParallelAlgorithms::MemoryBudget budget = ParallelAlgorithms::system_memory_budget(physical_memory_threshold_post);
+	p_merge_in_place_preventative_adaptive(src, l, m, r, budget);
+}
 
 #endif
\ No newline at end of file
@@ -1,10 +1,5 @@
 // TODO: Place all of these algorithms in a parallel_algorithms namespace
-// TODO: Provide the same interface to serial and parallel algorithms as standard C++ does, using the first argument as the execution policy
-// TODO: Improve parallel in-place merge sort by using the same method as the not-in-place merge sort does, where it looks at how many processors are
-//       available and adjusts the parallel threshold accordingly, as the current parallel threshold is set way too small.
 // TODO: Use Selection Sort instead of Insertion Sort for faster bottom of the recursion tree.
-// TODO: Consider bringing in and thoroughly testing (correctness and performance) https://keithschwarz.com/interesting/code/?dir=inplace-merge (Linear in-place merge implementation)
-// TODO: Implement memswap() with the same interface as memcpy() https://stackoverflow.com/questions/109249/why-isnt-there-a-standard-memswap-function
 
 // Parallel Merge Sort implementations
 
@@ -27,12 +22,18 @@
 #endif
 
 #include "InsertionSort.h"
+#include "SortingNetwork.h"
+#include "SmallParallel.h"
 #include "BinarySearch.h"
 #include "ParallelMerge.h"
+#include "MemoryBudget.h"
+#include "SortThresholds.h"
+#include "BoundedBufferMergeSort.h"
 #include "RadixSortLSD.h"
 #include "RadixSortMSD.h"
 #include "RadixSortLsdParallel.h"
 #include "RadixSortMsdParallel.h"
+#include "ParallelOptions.h"
 
 // TODO: This extern should not be needed and root-cause needs to be found
 extern void RadixSortLSDPowerOf2Radix_unsigned_TwoPhase(unsigned long* a, unsigned long* b, size_t a_size);
@@ -95,8 +96,8 @@ namespace ParallelAlgorithms
     }
 
     // Listing 3
-    template< class _Type >
-    inline void parallel_merge_sort_hybrid_rh(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true)
+    template< class _Type, class _Compare >
+    inline void parallel_merge_sort_hybrid_rh(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp)
     {
         if (r < l)  return;
         if (r == l) {    // termination/base case of sorting a single element
@@ -104,7 +105,7 @@ namespace ParallelAlgorithms
             return;
         }
         if ((r - l) <= 48) {
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);        // in both cases sort the src
+            small_sort_hybrid_stable(src + l, r - l + 1, comp);        // in both cases sort the src
             //stable_sort( src + l, src + r + 1 );  // STL stable_sort can be used instead, but is slightly slower than Insertion Sort
             if (srcToDst) for (size_t i = l; i <= r; i++)    dst[i] = src[i];    // copy from src to dst, when the result needs to be in dst
             return;
@@ -115,16 +116,24 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_merge_sort_hybrid_rh(src, l,     m, dst, !srcToDst); },    // reverse direction of srcToDst for the next level of recursion
-            [&] { parallel_merge_sort_hybrid_rh(src, m + 1, r, dst, !srcToDst); }     // reverse direction of srcToDst for the next level of recursion
+            [&] { parallel_merge_sort_hybrid_rh(src, l,     m, dst, !srcToDst, comp); },    // reverse direction of srcToDst for the next level of recursion
+            [&] { parallel_merge_sort_hybrid_rh(src, m + 1, r, dst, !srcToDst, comp); }     // reverse direction of srcToDst for the next level of recursion
         );
-        if (srcToDst) merge_parallel_L5(src, l, m, m + 1, r, dst, l);
-        else          merge_parallel_L5(dst, l, m, m + 1, r, src, l);
+        if (srcToDst) merge_parallel_L5(src, l, m, m + 1, r, dst, l, comp);
+        else          merge_parallel_L5(dst, l, m, m + 1, r, src, l, comp);
     }
 
-    // Listing 4
     template< class _Type >
-    inline void parallel_merge_sort_hybrid_rh_1(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true)
+    inline void parallel_merge_sort_hybrid_rh(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true)
+    {
+        parallel_merge_sort_hybrid_rh(src, l, r, dst, srcToDst, std::less<>());
+    }
+
+    // Listing 4
+    // The order is given by comp, such as std::greater<>() for descending order, and by comp applied to proj of each element in the overload with a projection,
+    // such as a member of a struct. Not stable for arrays larger than the serial merge threshold, as the parallel merge exchanges the halves.
+    template< class _Type, class _Compare >
+    inline void parallel_merge_sort_hybrid_rh_1(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp)
     {
         if (r < l)  return;
         if (r == l) {    // termination/base case of sorting a single element
@@ -132,7 +141,7 @@ namespace ParallelAlgorithms
             return;
         }
         if ((r - l) <= 48 && !srcToDst) {     // 32 or 64 or larger seem to perform well
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);    // want to do dstToSrc, can just do it in-place, just sort the src, no need to copy
+            small_sort_hybrid_stable(src + l, r - l + 1, comp);    // want to do dstToSrc, can just do it in-place, just sort the src, no need to copy
             return;
         }
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
@@ -141,15 +150,27 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_merge_sort_hybrid_rh_1(src, l,     m, dst, !srcToDst); },      // reverse direction of srcToDst for the next level of recursion
-            [&] { parallel_merge_sort_hybrid_rh_1(src, m + 1, r, dst, !srcToDst); }       // reverse direction of srcToDst for the next level of recursion
+            [&] { parallel_merge_sort_hybrid_rh_1(src, l,     m, dst, !srcToDst, comp); },      // reverse direction of srcToDst for the next level of recursion
+            [&] { parallel_merge_sort_hybrid_rh_1(src, m + 1, r, dst, !srcToDst, comp); }       // reverse direction of srcToDst for the next level of recursion
         );
-        if (srcToDst) merge_parallel_L5(src, l, m, m + 1, r, dst, l);
-        else          merge_parallel_L5(dst, l, m, m + 1, r, src, l);
+        if (srcToDst) merge_parallel_L5(src, l, m, m + 1, r, dst, l, comp);
+        else          merge_parallel_L5(dst, l, m, m + 1, r, src, l, comp);
+    }
+
+    template< class _Type, class _Compare, class _Projection >
+    inline void parallel_merge_sort_hybrid_rh_1(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp, _Projection proj)
+    {
+        parallel_merge_sort_hybrid_rh_1(src, l, r, dst, srcToDst, make_projected_compare(comp, proj));
     }
 
     template< class _Type >
-    inline void parallel_merge_sort_hybrid_rh_2(_Type* src, size_t l, size_t r, _Type* dst, bool stable = true, bool srcToDst = true, size_t parallelThreshold = 32 * 1024)
+    inline void parallel_merge_sort_hybrid_rh_1(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true)
+    {
+        parallel_merge_sort_hybrid_rh_1(src, l, r, dst, srcToDst, std::less<>());
+    }
+
+    template< class _Type, class _Compare, class = enable_if_compare<_Compare> >
+    inline void parallel_merge_sort_hybrid_rh_2(_Type* src, size_t l, size_t r, _Type* dst, bool stable, bool srcToDst, _Compare comp, size_t parallelThreshold = 32 * 1024)
     {
         if (r < l)  return;
         if (r == l) {   // termination/base case of sorting a single element
@@ -158,10 +179,10 @@ namespace ParallelAlgorithms
         }
         if ((r - l) <= parallelThreshold && !srcToDst) {
             if (!stable)
-                std::sort(src + l, src + r + 1);
+                std::sort(src + l, src + r + 1, comp);
                 //std::sort(std::execution::par_unseq, src + l, src + r + 1);
             else
-                std::stable_sort( src + l, src + r + 1 );
+                std::stable_sort( src + l, src + r + 1, comp );
             //if (srcToDst)
             //    for (int i = l; i <= r; i++)    dst[i] = src[i];
             return;
@@ -172,11 +193,17 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_merge_sort_hybrid_rh_2(src, l,     m, dst, stable, !srcToDst); },      // reverse direction of srcToDst for the next level of recursion
-            [&] { parallel_merge_sort_hybrid_rh_2(src, m + 1, r, dst, stable, !srcToDst); }       // reverse direction of srcToDst for the next level of recursion
+            [&] { parallel_merge_sort_hybrid_rh_2(src, l,     m, dst, stable, !srcToDst, comp, parallelThreshold); },      // reverse direction of srcToDst for the next level of recursion
+            [&] { parallel_merge_sort_hybrid_rh_2(src, m + 1, r, dst, stable, !srcToDst, comp, parallelThreshold); }       // reverse direction of srcToDst for the next level of recursion
         );
-        if (srcToDst) merge_parallel_L5(src, l, m, m + 1, r, dst, l);
-        else          merge_parallel_L5(dst, l, m, m + 1, r, src, l);
+        if (srcToDst) merge_parallel_L5(src, l, m, m + 1, r, dst, l, comp);
+        else          merge_parallel_L5(dst, l, m, m + 1, r, src, l, comp);
+    }
+
+    template< class _Type >
+    inline void parallel_merge_sort_hybrid_rh_2(_Type* src, size_t l, size_t r, _Type* dst, bool stable = true, bool srcToDst = true, size_t parallelThreshold = 32 * 1024)
+    {
+        parallel_merge_sort_hybrid_rh_2(src, l, r, dst, stable, srcToDst, std::less<>(), parallelThreshold);
     }
 
     template< class _Type >
@@ -207,8 +234,7 @@ namespace ParallelAlgorithms
     template< class _Type >
     inline void parallel_merge_merge_sort_hybrid(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true, size_t parallelThreshold = 32 * 1024)
     {
-        // may return 0 when not able to detect
-        const auto processor_count = std::thread::hardware_concurrency();
+        const auto processor_count = small_parallel_processor_count();
         //printf("Number of cores = %u \n", processor_count);
 
         if ((int)(parallelThreshold * processor_count) < (r - l + 1))
@@ -275,8 +301,7 @@ namespace ParallelAlgorithms
 
     inline void parallel_merge_sort_hybrid_radix_single_buffer(unsigned long* src, size_t l, size_t r, unsigned long* dst, bool srcToDst = true, size_t parallelThreshold = 24 * 1024)
     {
-        // may return 0 when not able to detect
-        const auto processor_count = std::thread::hardware_concurrency();
+        const auto processor_count = small_parallel_processor_count();
         //printf("Number of cores = %u   parallelThreshold = %d\n", processor_count, parallelThreshold);
 
         if ((parallelThreshold * processor_count) < (r - l + 1))
@@ -304,8 +329,8 @@ namespace ParallelAlgorithms
     }
 
     // Serial Merge Sort, using divide-and-conquer algorthm
-    template< class _Type >
-    inline void merge_sort_hybrid(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true)
+    template< class _Type, class _Compare >
+    inline void merge_sort_hybrid(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp)
     {
         if (r < l)  return;
         if (r == l) {    // termination/base case of sorting a single element
@@ -313,17 +338,91 @@ namespace ParallelAlgorithms
             return;
         }
         if ((r - l) <= 48 && !srcToDst) {     // 32 or 64 or larger seem to perform well
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);    // want to do dstToSrc, can just do it in-place, just sort the src, no need to copy
+            small_sort_hybrid_stable(src + l, r - l + 1, comp);    // want to do dstToSrc, can just do it in-place, just sort the src, no need to copy
             //stable_sort( src + l, src + r + 1 );  // STL stable_sort can be used instead, but is slightly slower than Insertion Sort. Threshold needs to be bigger
             return;
         }
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
 
-        merge_sort_hybrid(src, l,     m, dst, !srcToDst);      // reverse direction of srcToDst for the next level of recursion
-        merge_sort_hybrid(src, m + 1, r, dst, !srcToDst);      // reverse direction of srcToDst for the next level of recursion
+        merge_sort_hybrid(src, l,     m, dst, !srcToDst, comp);      // reverse direction of srcToDst for the next level of recursion
+        merge_sort_hybrid(src, m + 1, r, dst, !srcToDst, comp);      // reverse direction of srcToDst for the next level of recursion
 
-        if (srcToDst) merge_dac_hybrid(src, l, m, m + 1, r, dst, l);
-        else          merge_dac_hybrid(dst, l, m, m + 1, r, src, l);
+        if (srcToDst) merge_dac_hybrid(src, l, m, m + 1, r, dst, l, comp);
+        else          merge_dac_hybrid(dst, l, m, m + 1, r, src, l, comp);
+    }
+
+    template< class _Type, class _Compare, class _Projection >
+    inline void merge_sort_hybrid(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp, _Projection proj)
+    {
+        merge_sort_hybrid(src, l, r, dst, srcToDst, make_projected_compare(comp, proj));
+    }
+
+    template< class _Type >
+    inline void merge_sort_hybrid(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true)
+    {
+        merge_sort_hybrid(src, l, r, dst, srcToDst, std::less<>());
+    }
+
+    // Parallel Merge Sort for small arrays, using a single level of parallel tasks per step instead of recursion: one chunk per core is sorted
+    // by the serial merge sort, followed by log2(chunks) rounds of pairwise merges. Each merge of a round is split by merge path into
+    // equal parts of its output, to keep all cores busy until the last round. The chunks are sorted into whichever buffer makes the last round
+    // land in the buffer requested by srcToDst, so no copy is needed at the end.
+    template< class _Type, class _Compare, class = enable_if_compare<_Compare> >
+    inline void parallel_merge_sort_small(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst, _Compare comp, size_t minChunkSize = 4 * 1024)
+    {
+        if (r < l)  return;
+        size_t size = r - l + 1;
+        size_t number_of_chunks = small_parallel_number_of_chunks(size, minChunkSize);
+        size_t number_of_rounds = 0;
+        for (size_t runs = number_of_chunks; runs > 1; runs = (runs + 1) / 2)
+            number_of_rounds++;
+        bool chunksToDst = srcToDst != (number_of_rounds % 2 == 1);
+
+        size_t bounds[SmallParallelMaxChunks + 1];      // start of each sorted run, non-inclusive end of the last
+        for (size_t c = 0; c < number_of_chunks; c++)
+            bounds[c] = l + size * c / number_of_chunks;
+        bounds[number_of_chunks] = r + 1;
+
+        small_parallel_for_chunks(l, r + 1, number_of_chunks, [&](size_t, size_t startIndex, size_t endIndex) {
+            merge_sort_hybrid(src, startIndex, endIndex - 1, dst, chunksToDst, comp);
+        });
+
+        _Type* from = chunksToDst ? dst : src;
+        _Type* to   = chunksToDst ? src : dst;
+        for (size_t runs = number_of_chunks; runs > 1; runs = (runs + 1) / 2)
+        {
+            size_t number_of_merges = runs / 2;
+            size_t tasks_per_merge  = std::max(number_of_chunks / number_of_merges, (size_t)1);
+            size_t number_of_tasks  = number_of_merges * tasks_per_merge + runs % 2;
+            small_parallel_for_chunks(0, number_of_tasks, number_of_tasks, [&](size_t t, size_t, size_t) {
+                size_t p = t / tasks_per_merge;
+                if (p == number_of_merges)      // the odd run out of this round
+                {
+                    std::copy(from + bounds[2 * p], from + bounds[2 * p + 1], to + bounds[2 * p]);
+                    return;
+                }
+                size_t s = t % tasks_per_merge;
+                const _Type* a = from + bounds[2 * p];
+                const _Type* b = from + bounds[2 * p + 1];
+                size_t a_size = bounds[2 * p + 1] - bounds[2 * p];
+                size_t b_size = bounds[2 * p + 2] - bounds[2 * p + 1];
+                size_t k_start = (a_size + b_size) *  s      / tasks_per_merge;
+                size_t k_end   = (a_size + b_size) * (s + 1) / tasks_per_merge;
+                size_t i_start = small_parallel_merge_split(a, a_size, b, b_size, k_start, comp);
+                size_t i_end   = small_parallel_merge_split(a, a_size, b, b_size, k_end,   comp);
+                std::merge(a + i_start, a + i_end, b + (k_start - i_start), b + (k_end - i_end), to + bounds[2 * p] + k_start, comp);
+            });
+            for (size_t p = 0; p < (runs + 1) / 2; p++)
+                bounds[p] = bounds[2 * p];
+            bounds[(runs + 1) / 2] = bounds[runs];
+            std::swap(from, to);
+        }
+    }
+
+    template< class _Type >
+    inline void parallel_merge_sort_small(_Type* src, size_t l, size_t r, _Type* dst, bool srcToDst = true, size_t minChunkSize = 4 * 1024)
+    {
+        parallel_merge_sort_small(src, l, r, dst, srcToDst, std::less<>(), minChunkSize);
     }
 
     template< class _Type >
@@ -348,11 +447,15 @@ namespace ParallelAlgorithms
     }
 
     template< class _Type >
-    inline void parallel_inplace_merge_sort_hybrid_inner(_Type* src, size_t l, size_t r, bool stable = false, size_t parallelThreshold = 1024)
+    // parallelThreshold of 0 derives it from the number of cores, the L2 cache size and the element size
+    // linear_merge selects the linear-time in-place merge for large merges when stable is false, instead of p_merge_in_place_2
+    inline void parallel_inplace_merge_sort_hybrid_inner(_Type* src, size_t l, size_t r, bool stable = false, size_t parallelThreshold = 0, bool linear_merge = false)
     {
         if (r <= l) {
             return;
         }
+        if (parallelThreshold == 0)
+            parallelThreshold = inplace_merge_sort_parallel_threshold<_Type>(r - l + 1);
 #if 0
         if ((r - l) <= parallelThreshold) {             // Faster than Insertion Sort for use in parallel in-place merge sort
             if (!stable)
@@ -370,38 +473,48 @@ namespace ParallelAlgorithms
         }
 #endif
 #if 1
-        if ((r - l) <= 48) {     // 32 or 64 or larger seem to perform well. Don't want users to be able to set threshold too large, as O(N^2)
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);
+        if ((r - l) < inplace_merge_sort_leaf_threshold<_Type>()) {     // Don't want users to be able to set threshold too large, as O(N^2)
+            small_sort_hybrid_stable(src + l, r - l + 1);
             return;
         }
 #endif
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
+        if ((r - l + 1) < parallelThreshold) {
+            parallel_inplace_merge_sort_hybrid_inner(src, l,     m, stable, parallelThreshold, linear_merge);
+            parallel_inplace_merge_sort_hybrid_inner(src, m + 1, r, stable, parallelThreshold, linear_merge);
+        }
+        else {
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
-        Concurrency::parallel_invoke(
+            Concurrency::parallel_invoke(
 #else
-        tbb::parallel_invoke(
+            tbb::parallel_invoke(
 #endif
-            [&] { parallel_inplace_merge_sort_hybrid_inner(src, l,     m, stable, parallelThreshold); },
-            [&] { parallel_inplace_merge_sort_hybrid_inner(src, m + 1, r, stable, parallelThreshold); }
-        );
+                [&] { parallel_inplace_merge_sort_hybrid_inner(src, l,     m, stable, parallelThreshold, linear_merge); },
+                [&] { parallel_inplace_merge_sort_hybrid_inner(src, m + 1, r, stable, parallelThreshold, linear_merge); }
+            );
+        }
         //std::inplace_merge(src + l, src + m + 1, src + r + 1);
         //merge_in_place(src, l, m, r);       // merge the results
         //std::inplace_merge(std::execution::par_unseq, src + l, src + m + 1, src + r + 1);
-        p_merge_in_place_2(src, l, m, r);
+        if (linear_merge && !stable && (r - l) >= 32 * 1024)
+            p_merge_linear_in_place(src, l, m, r, std::less<>(), parallelThreshold);      // truly in-place, O(n) work, not stable
+        else
+            p_merge_in_place_2(src, l, m, r, parallelThreshold);
         //p_merge_truly_in_place(src, l, m, r);
     }
 
     template< class _Type >
-    inline void parallel_inplace_merge_sort_hybrid(_Type* src, size_t l, size_t r, bool stable = false, size_t parallelThreshold = 24 * 1024)
+    inline void parallel_inplace_merge_sort_hybrid(_Type* src, size_t l, size_t r, bool stable = false, size_t parallelThreshold = 0, bool linear_merge = false)
     {
-        // may return 0 when not able to detect
-        const auto processor_count = std::thread::hardware_concurrency();
-        //printf("Number of cores = %u \n", processor_count);
+        const size_t processor_count = small_parallel_processor_count();
+        //printf("Number of cores = %zu \n", processor_count);
 
-        if ((parallelThreshold * processor_count) < (r - l + 1))
+        if (parallelThreshold == 0)
+            parallelThreshold = inplace_merge_sort_parallel_threshold<_Type>(r - l + 1);
+        else if ((parallelThreshold * processor_count) < (r - l + 1))
             parallelThreshold = (r - l + 1) / processor_count;
 
-        parallel_inplace_merge_sort_hybrid_inner(src, l, r, stable, parallelThreshold);
+        parallel_inplace_merge_sort_hybrid_inner(src, l, r, stable, parallelThreshold, linear_merge);
     }
 
     template< class _Type >
@@ -431,32 +544,47 @@ namespace ParallelAlgorithms
         //p_merge_in_place_adaptive(src, l, m, r);
     }
 
+    // Merges are not-in-place while their buffers fit in the budget, which is taken once for the whole sort
     template< class _Type >
-    inline void preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, double physical_memory_threshold = 0.75, size_t threshold = 48)
+    // threshold of 0 derives the size of sub-arrays sorted by small_sort_hybrid_stable from the element size
+    inline void preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, MemoryBudget& budget, size_t threshold = 0)
     {
         if (r <= l) {
             return;
         }
-        if ((r - l) <= threshold) {     // 32 or 64 or larger seem to perform well. Need to avoid setting threshold too large, as O(N^2)
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);  // truly in-place
+        if (threshold == 0)
+            threshold = inplace_merge_sort_leaf_threshold<_Type>();
+        if ((r - l) < threshold) {      // Need to avoid setting threshold too large, as O(N^2)
+            small_sort_hybrid_stable(src + l, r - l + 1);  // truly in-place
             return;
         }
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
 
-        preventative_adaptive_inplace_merge_sort(src, l,     m, physical_memory_threshold, threshold);
-        preventative_adaptive_inplace_merge_sort(src, m + 1, r, physical_memory_threshold, threshold);
+        preventative_adaptive_inplace_merge_sort(src, l,     m, budget, threshold);
+        preventative_adaptive_inplace_merge_sort(src, m + 1, r, budget, threshold);
         
-        merge_inplace_preventative_adaptive(src, l, m, r, physical_memory_threshold);
+        merge_inplace_preventative_adaptive(src, l, m, r, budget);
+    }
+
+    template< class _Type >
+    inline void preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, double physical_memory_threshold = 0.75, size_t threshold = 0)
+    {
+        MemoryBudget budget = system_memory_budget(physical_memory_threshold);
+        preventative_adaptive_inplace_merge_sort(src, l, r, budget, threshold);
     }
 
     template< class _Type >
-    inline void parallel_preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, double physical_memory_threshold = 0.75, size_t parallelThreshold = 48)
+    // Sub-arrays smaller than parallelThreshold are sorted serially. parallelThreshold of 0 derives it from the number of cores,
+    // the L2 cache size and the element size
+    inline void parallel_preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, MemoryBudget& budget, size_t parallelThreshold = 0)
     {
         if (r <= l) {
             return;
         }
-        if ((r - l) <= parallelThreshold) {     // 32 or 64 or larger seem to perform well. Need to avoid setting threshold too large, as O(N^2)
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);  // truly in-place
+        if (parallelThreshold == 0)
+            parallelThreshold = inplace_merge_sort_parallel_threshold<_Type>(r - l + 1);
+        if ((r - l + 1) < parallelThreshold) {
+            preventative_adaptive_inplace_merge_sort(src, l, r, budget);
             return;
         }
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
@@ -465,23 +593,32 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, l,     m, physical_memory_threshold, parallelThreshold); },
-            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, m + 1, r, physical_memory_threshold, parallelThreshold); }
+            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, l,     m, budget, parallelThreshold); },
+            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, m + 1, r, budget, parallelThreshold); }
         );
-        p_merge_in_place_preventative_adaptive(src, l, m, r, physical_memory_threshold);
+        p_merge_in_place_preventative_adaptive(src, l, m, r, budget);
     }
 
     template< class _Type >
-    inline void parallel_preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, bool stable = false, double physical_memory_threshold = 0.75, size_t parallelThreshold = 48)
+    inline void parallel_preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, double physical_memory_threshold = 0.75, size_t parallelThreshold = 0)
+    {
+        MemoryBudget budget = system_memory_budget(physical_memory_threshold);
+        parallel_preventative_adaptive_inplace_merge_sort(src, l, r, budget, parallelThreshold);
+    }
+
+    template< class _Type >
+    inline void parallel_preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, bool stable, MemoryBudget& budget, size_t parallelThreshold = 0)
     {
         if (r <= l) {
             return;
         }
-        if ((r - l) <= parallelThreshold) {     // 32 or 64 or larger seem to perform well. Need to avoid setting threshold too large, as O(N^2)
+        if (parallelThreshold == 0)
+            parallelThreshold = inplace_merge_sort_parallel_threshold<_Type>(r - l + 1);
+        if ((r - l + 1) < parallelThreshold) {
             if (stable)
-                insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);  // truly in-place
+                preventative_adaptive_inplace_merge_sort(src, l, r, budget);
             else
-                std::sort(src + l, src + r + 1);
+                std::sort(src + l, src + r + 1);    // truly in-place
             return;
         }
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
@@ -490,10 +627,38 @@ namespace ParallelAlgorithms
 #else
         tbb::parallel_invoke(
 #endif
-            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, l,     m, stable, physical_memory_threshold, parallelThreshold); },
-            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, m + 1, r, stable, physical_memory_threshold, parallelThreshold); }
+            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, l,     m, stable, budget, parallelThreshold); },
+            [&] { parallel_preventative_adaptive_inplace_merge_sort(src, m + 1, r, stable, budget, parallelThreshold); }
         );
-        p_merge_in_place_preventative_adaptive(src, l, m, r, physical_memory_threshold);
+        p_merge_in_place_preventative_adaptive(src, l, m, r, budget);
+    }
+
+    template< class _Type >
+    inline void parallel_preventative_adaptive_inplace_merge_sort(_Type* src, size_t l, size_t r, bool stable = false, double physical_memory_threshold = 0.75, size_t parallelThreshold = 0)
+    {
+        MemoryBudget budget = system_memory_budget(physical_memory_threshold);
+        parallel_preventative_adaptive_inplace_merge_sort(src, l, r, stable, budget, parallelThreshold);
+    }
+
+    // Merge sort with a bounded buffer of sqrt(N) or 1% of N elements when that fits in the memory budget, and in-place merge sort otherwise.
+    // Used by the preventative-adaptive sorts when the buffer of N elements does not fit
+    template< class _Type >
+    inline void parallel_bounded_buffer_preventative_adaptive_sort(_Type* src, size_t l, size_t r, bool stable, const MemoryBudget& budget, size_t parallelThreshold)
+    {
+        size_t buffer_size = bounded_buffer_size(r - l + 1);
+        _Type* buffer = budget.fits(sizeof(_Type) * buffer_size) ? new(std::nothrow) _Type[buffer_size] : nullptr;
+
+        if (!buffer)
+        {
+            //printf("Running purely in-place parallel merge sort\n");
+            parallel_inplace_merge_sort_hybrid_inner(src, l, r, stable, parallelThreshold);
+        }
+        else
+        {
+            //printf("Running bounded buffer parallel merge sort\n");
+            parallel_bounded_buffer_merge_sort(src, l, r, buffer, buffer_size);     // stable
+            delete[] buffer;
+        }
     }
 
     // Adaptivity at a higher level to minimize the overhead of memory allocation and OS paging-in of newly allocated arrays
@@ -501,25 +666,20 @@ namespace ParallelAlgorithms
     // TODO: Memory allocation size could be reduced to be (r - l), where swapping of the source and work_buff would need to be done carefully since
     //       the boundaries of one would be l and r, and the other 0 and (r - l), followed by a copy to l to r within the src
 template< class _Type >
-inline void parallel_preventative_adaptive_inplace_merge_sort_2(_Type* src, size_t l, size_t r, double physical_memory_threshold_post = 0.75, size_t parallelThreshold = 48)
+inline void parallel_preventative_adaptive_inplace_merge_sort_2(_Type* src, size_t l, size_t r, const MemoryBudget& budget, size_t parallelThreshold = 0)
 {
     size_t src_size = r + 1;
-    size_t anticipated_memory_usage = sizeof(_Type) * src_size / (size_t)(1024 * 1024) + physical_memory_used_in_megabytes();
-    double physical_memory_fraction = (double)anticipated_memory_usage / (double)physical_memory_total_in_megabytes();
-    //printf("p_merge_in_place_preventative_adaptive: physical memory used = %llu   physical memory total = %llu   anticipated memory used = %llu\n",
-    //	physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes(), anticipated_memory_usage);
+    //printf("parallel_preventative_adaptive_inplace_merge_sort_2: memory budget = %llu MB   work buffer = %zu MB\n",
+    //	budget.available_bytes() / (1024 * 1024), sizeof(_Type) * src_size / (1024 * 1024));
 
-    if (physical_memory_fraction > physical_memory_threshold_post)
-    {
-        //printf("Running purely in-place parallel merge sort\n");
-        parallel_inplace_merge_sort_hybrid_inner(src, l, r, false, parallelThreshold);
-    }
+    if (!budget.fits(sizeof(_Type) * src_size))
+        parallel_bounded_buffer_preventative_adaptive_sort(src, l, r, false, budget, parallelThreshold);
     else
     {
         _Type* work_buff = new(std::nothrow) _Type[src_size];
 
         if (!work_buff)
-            parallel_inplace_merge_sort_hybrid_inner(src, l, r, false, parallelThreshold);
+            parallel_bounded_buffer_preventative_adaptive_sort(src, l, r, false, budget, parallelThreshold);
         else
         {
             //printf("Running not-in-place parallel merge sort\n");
@@ -535,37 +695,36 @@ inline void parallel_preventative_adaptive_inplace_merge_sort_2(_Type* src, size
     }
 }
 
+template< class _Type >
+inline void parallel_preventative_adaptive_inplace_merge_sort_2(_Type* src, size_t l, size_t r, double physical_memory_threshold_post = 0.75, size_t parallelThreshold = 0)
+{
+    parallel_preventative_adaptive_inplace_merge_sort_2(src, l, r, system_memory_budget(physical_memory_threshold_post), parallelThreshold);
+}
+
     template< class _Type >
-    inline void parallel_inplace_merge_sort_radix_hybrid(_Type* src, size_t l, size_t r, size_t parallelThreshold = 24 * 1024)
+    inline void parallel_inplace_merge_sort_radix_hybrid(_Type* src, size_t l, size_t r, size_t parallelThreshold = 0)
     {
-        // may return 0 when not able to detect
-        //const auto processor_count = std::thread::hardware_concurrency();
-        //printf("Number of cores = %u \n", processor_count);
-
-        //if ((parallelThreshold * processor_count) < (r - l + 1))
-        //    parallelThreshold = (r - l + 1) / processor_count;
+        if (parallelThreshold == 0)
+            parallelThreshold = inplace_merge_sort_parallel_threshold<_Type>(r - l + 1);
 
         parallel_inplace_merge_sort_radix_hybrid_inner(src, l, r, parallelThreshold);
     }
 
-inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* src, size_t src_size, bool stable = true, double physical_memory_threshold_post = 0.75, size_t parallelThreshold = 24 * 1024)
+inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* src, size_t src_size, bool stable, const MemoryBudget& budget, size_t parallelThreshold = 24 * 1024)
 {
-    size_t anticipated_memory_usage = sizeof(unsigned long) * src_size / (size_t)(1024 * 1024) + physical_memory_used_in_megabytes();
-    double physical_memory_fraction = (double)anticipated_memory_usage / (double)physical_memory_total_in_megabytes();
-    //printf("p_merge_in_place_preventative_adaptive: physical memory used = %llu   physical memory total = %llu\n",
-    //	physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes());
+    //printf("parallel_linear_in_place_preventative_adaptive_sort: memory budget = %llu MB\n", budget.available_bytes() / (1024 * 1024));
 
-    if (physical_memory_fraction > physical_memory_threshold_post)
+    if (!budget.fits(sizeof(unsigned long) * src_size))
     {
         // In-Place and Stable => no known linear-time sort
-        parallel_inplace_merge_sort_hybrid_inner(src, 0, src_size - 1, stable, parallelThreshold);  // not-linear
+        parallel_bounded_buffer_preventative_adaptive_sort(src, 0, src_size - 1, stable, budget, parallelThreshold);  // not-linear
     }
     else
     {
         unsigned long* work_buff = new(std::nothrow) unsigned long[src_size];
 
         if (!work_buff)
-            parallel_inplace_merge_sort_hybrid_inner(src, 0, src_size - 1, stable, parallelThreshold);  // not-linear
+            parallel_bounded_buffer_preventative_adaptive_sort(src, 0, src_size - 1, stable, budget, parallelThreshold);  // not-linear
         else
         {
             parallel_merge_sort_hybrid_radix(src, 0, src_size - 1, work_buff, false, parallelThreshold);  // linear
@@ -574,6 +733,11 @@ inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* s
     }
 }
 
+inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* src, size_t src_size, bool stable = true, double physical_memory_threshold_post = 0.75, size_t parallelThreshold = 24 * 1024)
+{
+    parallel_linear_in_place_preventative_adaptive_sort(src, src_size, stable, system_memory_budget(physical_memory_threshold_post), parallelThreshold);
+}
+
     template< class _Type >
     inline void merge_sort_inplace(_Type* src, size_t l, size_t r)
     {
@@ -604,7 +768,7 @@ inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* s
     {
         if (r <= l) return;
         if ((r - l) <= 48) {
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);
+            small_sort_hybrid_stable(src + l, r - l + 1);
             return;
         }
         size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
@@ -624,12 +788,12 @@ inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* s
         size_t l = start;
         size_t r = l + length - 1;      // l and r are inclusive
         if (length <= 32) {
-            insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l + 1);
+            small_sort_hybrid_stable(src + l, r - l + 1);
             return;
         }
         size_t m = 32;
         for (size_t i = l; i <= r; i += m)
-            insertionSortSimilarToSTLnoSelfAssignment(src + i, __min(m, r - m + 1));
+            small_sort_hybrid_stable(src + i, __min(m, r - m + 1));
         for (; m <= r - l; m = m + m)
             for (size_t i = l; i <= r - m; i += m + m)
                 std::inplace_merge(src + i, src + i + m, src + __min(i + m + m, r + 1));
@@ -638,5 +802,72 @@ inline void parallel_linear_in_place_preventative_adaptive_sort(unsigned long* s
             // TODO: This leads to a terrific idea of implementing an adaptive in-place merge sort, which performs not-in-place parallel merge sort when there is sufficient memory, and falls back to the truly in-place merge sort when it has to,
             //       and even then the parallel in-place merge sort is faster than C++ parallel sort.
     }
+
+    // The Parallel Merge Sorts, with the threads they may use given by options
+    template< class... _Args >
+    inline decltype(auto) parallel_merge_sort(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_merge_sort(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_merge_sort_hybrid_rh(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_merge_sort_hybrid_rh(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_inplace_merge_sort_hybrid(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_inplace_merge_sort_hybrid(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_preventative_adaptive_inplace_merge_sort(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_merge_sort_hybrid_rh_1(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_merge_sort_hybrid_rh_2(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_merge_sort_hybrid_rh_2(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_merge_sort_small(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_merge_sort_small(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) merge_sort_hybrid(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::merge_sort_hybrid(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_inplace_merge_sort_radix_hybrid(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_inplace_merge_sort_radix_hybrid(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_preventative_adaptive_inplace_merge_sort_2(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort_2(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) parallel_linear_in_place_preventative_adaptive_sort(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::parallel_linear_in_place_preventative_adaptive_sort(std::forward<_Args>(args)...); });
+    }
 }
 #endif
\ No newline at end of file
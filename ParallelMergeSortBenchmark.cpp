@@ -53,6 +53,16 @@ void print_results(const char* const tag, const unsigned char* sorted, size_t so
 		duration_cast<duration<double, milli>>(endTime - startTime).count());
 }
 
+// Exits when the result of a benchmarked algorithm differs from the reference
+void check_results(const vector<unsigned long>& reference, const vector<unsigned long>& result)
+{
+	if (!std::equal(reference.begin(), reference.end(), result.begin()))
+	{
+		printf("Arrays are not equal\n");
+		exit(1);
+	}
+}
+
 
 int ParallelMergeSortBenchmark(vector<double>& doubles)
 {
@@ -183,7 +193,7 @@ int ParallelInPlaceMergeSortBenchmark(vector<unsigned long>& ulongs)
 		//ParallelAlgorithms::parallel_inplace_merge_sort_hybrid(ulongsCopy, 0, ulongs.size() - 1, false, ulongs.size() / 48);
 		//ParallelAlgorithms::preventative_adaptive_inplace_merge_sort(ulongsCopy, 0, ulongs.size() - 1, 0.75);
 		//ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort(ulongsCopy, 0, ulongs.size() - 1, 0.75);
-		ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort(ulongsCopy, 0, ulongs.size() - 1, false, 0.01, ulongs.size() / 48);	// threshold 48 or 32 * 1024
+		ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort(ulongsCopy, 0, ulongs.size() - 1, false, 0.01);	// threshold derived from cores, caches and element size
 		//ParallelAlgorithms::parallel_preventative_adaptive_inplace_merge_sort_2(ulongsCopy, 0, ulongs.size() - 1, 0.9, ulongs.size() / 24);	// threshold 48 or 32 * 1024
 		//ParallelAlgorithms::parallel_linear_in_place_preventative_adaptive_sort(ulongsCopy, (unsigned long)ulongs.size(), true, 0.01, ulongs.size() / 6);	// using 4-cores is fastest on 6-core CPU
 		//ParallelAlgorithms::parallel_linear_in_place_preventative_adaptive_sort(ulongsCopy, (unsigned long)ulongs.size(), true, 0.9, ulongs.size() / 8);	// using 8-cores is fastest on 48-core CPU
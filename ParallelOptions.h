@@ -0,0 +1,193 @@
+// Concurrency control of the parallel algorithms: the number of threads, the arena they run in, whether they use hyperthreads, and which
+// core type of a hybrid CPU they run on. The algorithms take these options as an optional first argument, and left at the defaults they
+// run in the caller's arena, as they do without options, at no cost
+
+#ifndef _ParallelOptions_h
+#define _ParallelOptions_h
+
+// Core type and threads per core constraints of task_arena. These take effect only when this header is included before any TBB header,
+// or when the build defines TBB_PREVIEW_TASK_ARENA_CONSTRAINTS_EXTENSION=1 for every translation unit
+#ifndef TBB_PREVIEW_TASK_ARENA_CONSTRAINTS_EXTENSION
+#define TBB_PREVIEW_TASK_ARENA_CONSTRAINTS_EXTENSION 1
+#endif
+
+#include <stddef.h>
+#include <stdio.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#ifndef NOMINMAX
+#define NOMINMAX        // keeps std::min and std::max usable after windows.h
+#endif
+#include "windows.h"
+#include <ppl.h>
+#include <concrt.h>
+#else
+#include <tbb/task_arena.h>
+#endif
+
+namespace ParallelAlgorithms
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+    typedef Concurrency::Scheduler ParallelArena;
+#else
+    typedef tbb::task_arena ParallelArena;
+#endif
+
+    struct ParallelOptions
+    {
+        int  max_threads      = 0;          // upper bound on the number of threads, including the caller's, or 0 for no bound
+        ParallelArena* arena  = nullptr;    // arena (PPL scheduler) to run in, whose own concurrency then applies, in place of the options below
+        bool use_hyperthreads = true;       // false runs on one thread per physical core
+        int  core_type        = -1;         // one of tbb::info::core_types(), such as the performance cores of a hybrid CPU, or -1 for any
+
+        bool is_default() const
+        {
+            return max_threads <= 0 && arena == nullptr && use_hyperthreads && core_type < 0;
+        }
+    };
+
+    // Number of physical cores, counting each core once however many hardware threads it has, or the number of hardware threads when
+    // the topology can not be read
+    inline size_t detect_physical_core_count()
+    {
+        size_t count = 0;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        DWORD length = 0;
+        GetLogicalProcessorInformation(nullptr, &length);
+        size_t number_of_entries = length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(number_of_entries);
+        if (number_of_entries > 0 && GetLogicalProcessorInformation(info.data(), &length))
+            for (size_t i = 0; i < number_of_entries; i++)
+                if (info[i].Relationship == RelationProcessorCore)
+                    count++;
+#else
+        std::set< std::pair<int, int> > cores;      // (package, core) of each online hardware thread
+        for (unsigned cpu = 0; cpu < 4096; cpu++)
+        {
+            char file_name[128];
+            int package = 0, core = 0;
+            snprintf(file_name, sizeof(file_name), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+            FILE* file = fopen(file_name, "r");
+            if (!file)
+            {
+                if (cpu >= std::thread::hardware_concurrency())
+                    break;
+                continue;                           // offline CPUs have no topology
+            }
+            bool read = fscanf(file, "%d", &core) == 1;
+            fclose(file);
+            snprintf(file_name, sizeof(file_name), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+            if ((file = fopen(file_name, "r")))
+            {
+                read = read && fscanf(file, "%d", &package) == 1;
+                fclose(file);
+            }
+            if (read)
+                cores.insert(std::make_pair(package, core));
+        }
+        count = cores.size();
+#endif
+        return count > 0 ? count : std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+    }
+
+    inline size_t physical_core_count()
+    {
+        static const size_t count = detect_physical_core_count();
+        return count;
+    }
+
+    // The arena for options without an arena of their own. Arenas are created on first use and kept for the life of the process, since
+    // creating one per call costs as much as a small sort
+    inline ParallelArena& options_arena(const ParallelOptions& options)
+    {
+        struct CachedArena
+        {
+            int max_threads;
+            bool use_hyperthreads;
+            int core_type;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            ParallelArena* arena;
+#else
+            std::unique_ptr<ParallelArena> arena;
+#endif
+        };
+        static std::mutex mutex;
+        static std::vector<CachedArena> arenas;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (CachedArena& cached : arenas)
+            if (cached.max_threads == options.max_threads && cached.use_hyperthreads == options.use_hyperthreads && cached.core_type == options.core_type)
+                return *cached.arena;
+
+        int concurrency = (int)std::thread::hardware_concurrency();
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        if (!options.use_hyperthreads)
+            concurrency = (int)physical_core_count();
+        if (options.max_threads > 0)
+            concurrency = std::min(concurrency, options.max_threads);
+        Concurrency::SchedulerPolicy policy(2, Concurrency::MinConcurrency, 1, Concurrency::MaxConcurrency, std::max(concurrency, 1));
+        arenas.push_back(CachedArena{ options.max_threads, options.use_hyperthreads, options.core_type, Concurrency::Scheduler::Create(policy) });
+#else
+        tbb::task_arena::constraints constraints;
+#if __TBB_PREVIEW_TASK_ARENA_CONSTRAINTS_EXTENSION_PRESENT
+        constraints.set_core_type(options.core_type < 0 ? tbb::task_arena::automatic : options.core_type);
+        constraints.set_max_threads_per_core(options.use_hyperthreads ? tbb::task_arena::automatic : 1);
+        concurrency = tbb::info::default_concurrency(constraints);
+#else
+        concurrency = tbb::info::default_concurrency();
+        if (!options.use_hyperthreads)
+            concurrency = (int)physical_core_count();  // the threads are not pinned to cores without the constraints extension
+#endif
+        if (options.max_threads > 0)
+            concurrency = std::min(concurrency, options.max_threads);
+        constraints.set_max_concurrency(std::max(concurrency, 1));
+        arenas.push_back(CachedArena{ options.max_threads, options.use_hyperthreads, options.core_type, std::unique_ptr<ParallelArena>(new ParallelArena(constraints)) });
+        arenas.back().arena->initialize();
+#endif
+        return *arenas.back().arena;
+    }
+
+    // Number of scopes on this thread which run in an arena chosen by the caller, through non-default options, which kernels must not leave
+    inline int& options_scope_depth()
+    {
+        thread_local int depth = 0;
+        return depth;
+    }
+
+    struct OptionsScope
+    {
+        OptionsScope()  { options_scope_depth()++; }
+        ~OptionsScope() { options_scope_depth()--; }
+    };
+
+    // Runs f() in the arena given by the options, and returns its result. With the default options, f() runs directly in the caller's arena
+    // Every parallel algorithm taking options has an overload with them as its first argument, which forwards the other arguments to the
+    // algorithm through run_with_options. The algorithm splits its work by small_parallel_processor_count(), the concurrency of the arena it
+    // runs in, so the options limit it without being passed further down
+    template< class _Function >
+    inline decltype(auto) run_with_options(const ParallelOptions& options, _Function&& f)
+    {
+        if (options.is_default())
+            return f();
+        ParallelArena& arena = options.arena ? *options.arena : options_arena(options);
+        OptionsScope options_scope;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        struct SchedulerScope
+        {
+            SchedulerScope(ParallelArena& scheduler) { scheduler.Attach(); }
+            ~SchedulerScope() { Concurrency::CurrentScheduler::Detach(); }
+        } scope(arena);
+        return f();
+#else
+        return arena.execute(std::forward<_Function>(f));
+#endif
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <ratio>
+#include <thread>
+#include <vector>
+
+#include "ParallelOptions.h"
+#include "SortParallel.h"
+#include "ParallelStdAlgorithms.h"
+#include "FillParallel.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+extern void check_results(const vector<unsigned long>& reference, const vector<unsigned long>& result);
+
+// Parallel Sort, reduce and fill with the default options, which run in the caller's arena, and with options that limit the number of
+// threads, or that leave out hyperthreads. Arenas of options are cached, so only the first call with each of the options creates one
+int ParallelOptionsBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	char tag[128];
+
+	printf("Hardware threads = %u, physical cores = %zu\n", std::thread::hardware_concurrency(), ParallelAlgorithms::physical_core_count());
+
+	vector<ParallelAlgorithms::ParallelOptions> all_options;
+	all_options.push_back(ParallelAlgorithms::ParallelOptions());
+	ParallelAlgorithms::ParallelOptions no_hyperthreads;
+	no_hyperthreads.use_hyperthreads = false;
+	all_options.push_back(no_hyperthreads);
+	for (int max_threads : { 1, 2, 4 })
+	{
+		ParallelAlgorithms::ParallelOptions options;
+		options.max_threads = max_threads;
+		all_options.push_back(options);
+	}
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		for (const ParallelAlgorithms::ParallelOptions& options : all_options)
+		{
+			const char* name = options.is_default() ? "default" : !options.use_hyperthreads ? "no hyperthreads" : "max threads";
+			int threads = (int)ParallelAlgorithms::run_with_options(options, [] { return ParallelAlgorithms::small_parallel_processor_count(); });
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			auto startTime = high_resolution_clock::now();
+			ParallelAlgorithms::sort_par(options, ulongsCopy.data(), ulongsCopy.size());
+			auto endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "sort_par,   %-15s %2d threads ", name, threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(sorted_reference, ulongsCopy);
+
+			startTime = high_resolution_clock::now();
+			unsigned long long sum = ParallelAlgorithms::reduce_par(options, ulongsCopy.data(), (size_t)0, ulongsCopy.size(), 0ULL, std::plus<>());
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "reduce_par, %-15s %2d threads ", name, threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			if (sum != std::accumulate(ulongs.begin(), ulongs.end(), 0ULL))
+			{
+				printf("Sums are not equal\n");
+				exit(1);
+			}
+
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::parallel_fill(options, ulongsCopy.data(), (unsigned long)i, (size_t)0, ulongsCopy.size());
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "fill,       %-15s %2d threads ", name, threads);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			if (std::count(ulongsCopy.begin(), ulongsCopy.end(), (unsigned long)i) != (std::ptrdiff_t)ulongsCopy.size())
+			{
+				printf("Fill is not complete\n");
+				exit(1);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,276 @@
+// Swapping, reversal and rotation of blocks of an array: memswap() with the interface of memcpy(), vectorized reversal, and serial and
+// parallel rotations, which pick a stack buffer, juggling, block swaps or three reversals by the sizes of the two blocks
+
+#ifndef _ParallelRotate_h
+#define _ParallelRotate_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/parallel_invoke.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+#include "SmallParallel.h"
+#include "SortThresholds.h"
+
+namespace ParallelAlgorithms
+{
+    const size_t RotateParallelThreshold = 64 * 1024;     // elements. Smaller swaps, reversals and rotations are serial
+    const size_t RotateStackBufferSize   = 512;           // bytes. A rotation with a block this small moves it through the stack
+
+    // Swaps count bytes of dest and src, which must not overlap, 32 or 16 bytes at a time. Returns dest, as memcpy() does
+    inline void* memswap(void* dest, void* src, size_t count)
+    {
+        unsigned char* a = (unsigned char*)dest;
+        unsigned char* b = (unsigned char*)src;
+#if defined(__AVX2__)
+        for (; count >= 64; count -= 64, a += 64, b += 64)
+        {
+            __m256i a0 = _mm256_loadu_si256((const __m256i*)a), a1 = _mm256_loadu_si256((const __m256i*)(a + 32));
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)b), b1 = _mm256_loadu_si256((const __m256i*)(b + 32));
+            _mm256_storeu_si256((__m256i*)a, b0);  _mm256_storeu_si256((__m256i*)(a + 32), b1);
+            _mm256_storeu_si256((__m256i*)b, a0);  _mm256_storeu_si256((__m256i*)(b + 32), a1);
+        }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        for (; count >= 16; count -= 16, a += 16, b += 16)
+        {
+            __m128i va = _mm_loadu_si128((const __m128i*)a);
+            __m128i vb = _mm_loadu_si128((const __m128i*)b);
+            _mm_storeu_si128((__m128i*)a, vb);
+            _mm_storeu_si128((__m128i*)b, va);
+        }
+#endif
+        for (; count >= 8; count -= 8, a += 8, b += 8)
+        {
+            uint64_t va, vb;
+            memcpy(&va, a, 8);  memcpy(&vb, b, 8);
+            memcpy(a, &vb, 8);  memcpy(b, &va, 8);
+        }
+        for (; count > 0; count--, a++, b++)
+            std::swap(*a, *b);
+        return dest;
+    }
+
+    // Swaps a[0 .. count-1] and b[0 .. count-1], which must not overlap
+    template< class _Type >
+    inline void swap_ranges_serial(_Type* a, _Type* b, size_t count)
+    {
+        if constexpr (std::is_trivially_copyable<_Type>::value)
+            memswap(a, b, sizeof(_Type) * count);
+        else
+            std::swap_ranges(a, a + count, b);
+    }
+
+    template< class _Type >
+    inline void swap_ranges_par(_Type* a, _Type* b, size_t count, size_t parallelThreshold = RotateParallelThreshold)
+    {
+        if (count < parallelThreshold)
+            swap_ranges_serial(a, b, count);
+        else
+            small_parallel_for_chunks(0, count, small_parallel_number_of_chunks(count, parallelThreshold / 2), [&](size_t, size_t startIndex, size_t endIndex) {
+                swap_ranges_serial(a + startIndex, b + startIndex, endIndex - startIndex);
+            });
+    }
+
+    // Swaps a[i] with b[count-1-i] for i = 0 .. count-1, where a and b must not overlap. Elements of 4 and 8 bytes are reversed within vectors
+    template< class _Type >
+    inline void reverse_swap(_Type* a, _Type* b, size_t count)
+    {
+        size_t i = 0;
+        if constexpr (std::is_trivially_copyable<_Type>::value && (sizeof(_Type) == 8 || sizeof(_Type) == 4))
+        {
+#if defined(__AVX2__)
+            const size_t lanes = 32 / sizeof(_Type);
+            const __m256i reverse_32 = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+            for (; i + lanes <= count; i += lanes)
+            {
+                __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+                __m256i vb = _mm256_loadu_si256((const __m256i*)(b + count - lanes - i));
+                if constexpr (sizeof(_Type) == 8)
+                {
+                    va = _mm256_permute4x64_epi64(va, 0x1B);
+                    vb = _mm256_permute4x64_epi64(vb, 0x1B);
+                }
+                else
+                {
+                    va = _mm256_permutevar8x32_epi32(va, reverse_32);
+                    vb = _mm256_permutevar8x32_epi32(vb, reverse_32);
+                }
+                _mm256_storeu_si256((__m256i*)(a + i), vb);
+                _mm256_storeu_si256((__m256i*)(b + count - lanes - i), va);
+            }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+            const size_t lanes = 16 / sizeof(_Type);
+            for (; i + lanes <= count; i += lanes)
+            {
+                __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+                __m128i vb = _mm_loadu_si128((const __m128i*)(b + count - lanes - i));
+                if constexpr (sizeof(_Type) == 8)
+                {
+                    va = _mm_shuffle_epi32(va, 0x4E);
+                    vb = _mm_shuffle_epi32(vb, 0x4E);
+                }
+                else
+                {
+                    va = _mm_shuffle_epi32(va, 0x1B);
+                    vb = _mm_shuffle_epi32(vb, 0x1B);
+                }
+                _mm_storeu_si128((__m128i*)(a + i), vb);
+                _mm_storeu_si128((__m128i*)(b + count - lanes - i), va);
+            }
+#endif
+        }
+        for (; i < count; i++)
+            std::swap(a[i], b[count - 1 - i]);
+    }
+
+    // Reverses a[0 .. size-1]
+    template< class _Type >
+    inline void reverse_serial(_Type* a, size_t size)
+    {
+        size_t half = size / 2;
+        reverse_swap(a, a + size - half, half);
+    }
+
+    // Reverses a[0 .. size-1], by a single level of parallel tasks, each swapping a chunk of the front half with its mirror in the back half
+    template< class _Type >
+    inline void reverse_par(_Type* a, size_t size, size_t parallelThreshold = RotateParallelThreshold)
+    {
+        size_t half = size / 2;
+        if (size < parallelThreshold)
+            reverse_swap(a, a + size - half, half);
+        else
+            small_parallel_for_chunks(0, half, small_parallel_number_of_chunks(half, parallelThreshold / 2), [&](size_t, size_t startIndex, size_t endIndex) {
+                reverse_swap(a + startIndex, a + size - endIndex, endIndex - startIndex);
+            });
+    }
+
+    // Rotation by cycles of moves (Bentley's juggling), which moves each element once, but in a strided order that is only fast within the cache
+    template< class _Type >
+    inline void rotate_juggling(_Type* first, size_t length1, size_t length2)
+    {
+        size_t size = length1 + length2;
+        size_t a = size, b = length1;
+        while (b != 0) { size_t t = a % b;  a = b;  b = t; }        // number of cycles is gcd(size, length1)
+        for (size_t i = 0; i < a; i++)
+        {
+            _Type value = std::move(first[i]);
+            size_t j = i;
+            for (;;)
+            {
+                size_t next = j + length1;
+                if (next >= size)
+                    next -= size;
+                if (next == i)
+                    break;
+                first[j] = std::move(first[next]);
+                j = next;
+            }
+            first[j] = std::move(value);
+        }
+    }
+
+    // Exchanges [first, middle) and [middle, last) serially, and returns first + (last - middle), by block swaps, which sweep memory
+    // sequentially with memswap. A trivially copyable block of up to RotateStackBufferSize bytes is moved through the stack instead.
+    // Other types within the L1 cache are rotated by juggling, which moves each element once instead of swapping it
+    template< class _Type >
+    inline _Type* rotate_serial(_Type* first, _Type* middle, _Type* last)
+    {
+        _Type* result = first + (last - middle);
+        while (first != middle && middle != last)
+        {
+            size_t length1 = middle - first;
+            size_t length2 = last - middle;
+            if constexpr (std::is_trivially_copyable<_Type>::value)
+            {
+                if (std::min(length1, length2) * sizeof(_Type) <= RotateStackBufferSize)
+                {
+                    alignas(64) unsigned char buffer[RotateStackBufferSize];
+                    if (length2 <= length1)
+                    {
+                        memcpy(buffer, middle, sizeof(_Type) * length2);
+                        memmove(first + length2, first, sizeof(_Type) * length1);
+                        memcpy(first, buffer, sizeof(_Type) * length2);
+                    }
+                    else
+                    {
+                        memcpy(buffer, first, sizeof(_Type) * length1);
+                        memmove(first, middle, sizeof(_Type) * length2);
+                        memcpy(first + length2, buffer, sizeof(_Type) * length1);
+                    }
+                    break;
+                }
+            }
+            else if (length1 != length2 && (length1 + length2) * sizeof(_Type) <= l1_cache_size())
+            {
+                rotate_juggling(first, length1, length2);
+                break;
+            }
+            if (length1 <= length2)         // the first block goes to its place at the end
+            {
+                swap_ranges_serial(first, last - length1, length1);
+                last -= length1;
+            }
+            else                            // the second block goes to its place at the start
+            {
+                swap_ranges_serial(first, middle, length2);
+                first += length2;
+            }
+        }
+        return result;
+    }
+
+    // Exchanges [first, middle) and [middle, last), and returns first + (last - middle). Large rotations use block swaps, each swap in
+    // parallel, while the shorter block is large enough for its swap to be parallel, and three parallel reversals otherwise
+    template< class _Type >
+    inline _Type* rotate_par(_Type* first, _Type* middle, _Type* last, size_t parallelThreshold = RotateParallelThreshold)
+    {
+        _Type* result = first + (last - middle);
+        while (first != middle && middle != last)
+        {
+            size_t length1 = middle - first;
+            size_t length2 = last - middle;
+            if ((length1 + length2) < parallelThreshold)
+            {
+                rotate_serial(first, middle, last);
+                break;
+            }
+            if (std::min(length1, length2) < parallelThreshold / 2)
+            {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+                Concurrency::parallel_invoke(
+#else
+                tbb::parallel_invoke(
+#endif
+                    [&] { reverse_par(first,  length1, parallelThreshold); },
+                    [&] { reverse_par(middle, length2, parallelThreshold); }
+                );
+                reverse_par(first, length1 + length2, parallelThreshold);
+                break;
+            }
+            if (length1 <= length2)
+            {
+                swap_ranges_par(first, last - length1, length1, parallelThreshold);
+                last -= length1;
+            }
+            else
+            {
+                swap_ranges_par(first, middle, length2, parallelThreshold);
+                first += length2;
+            }
+        }
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,278 @@
+// Standard C++ style interface to the parallel algorithms: an execution policy as the first argument, followed by iterators,
+// with the end iterator exclusive, which supports empty ranges at any position. Contiguous iterators, such as pointers, and iterators
+// of std::vector, std::array and std::string, use the engines below. Other iterators, such as those of std::deque, use the standard algorithm.
+//   std::execution::seq                         - serial engines
+//   std::execution::par, std::execution::par_unseq - parallel engines
+
+#ifndef _ParallelStdAlgorithms_h
+#define _ParallelStdAlgorithms_h
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <execution>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/parallel_invoke.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "SortParallel.h"
+#include "SmallParallel.h"
+#include "WorkBufferPool.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // Enables the overloads below only for execution policies, leaving the interfaces that take a pointer first unambiguous
+    template< class _ExecutionPolicy, class _Result = void >
+    using enable_if_execution_policy = typename std::enable_if< std::is_execution_policy< typename std::decay<_ExecutionPolicy>::type >::value, _Result >::type;
+
+    template< class _ExecutionPolicy >
+    constexpr bool is_sequenced_policy()
+    {
+        return std::is_same< typename std::decay<_ExecutionPolicy>::type, std::execution::sequenced_policy >::value;
+    }
+
+    // Whether the elements of [first, last) are contiguous in memory, which the engines below need to work on pointers. Before C++20
+    // the iterator types which are known to be contiguous are listed: pointers, which std::array iterators are with gcc and clang,
+    // and iterators of std::vector, std::string and std::wstring
+    template< class _It >
+    constexpr bool is_contiguous_iterator()
+    {
+#if defined(__cpp_lib_concepts)
+        return std::contiguous_iterator<_It>;
+#else
+        typedef typename std::iterator_traits<_It>::value_type _Type;
+        if constexpr (std::is_pointer<_It>::value)
+            return true;
+        else if constexpr (std::is_same<_Type, bool>::value)       // std::vector<bool> packs its elements into bits
+            return false;
+        else
+            return std::is_same<_It, typename std::vector<_Type>::iterator>::value || std::is_same<_It, typename std::vector<_Type>::const_iterator>::value ||
+                   std::is_same<_It, std::string::iterator>::value  || std::is_same<_It, std::string::const_iterator>::value ||
+                   std::is_same<_It, std::wstring::iterator>::value || std::is_same<_It, std::wstring::const_iterator>::value;
+#endif
+    }
+
+    // Parallel merge of two separate sorted arrays a[0 .. a_size-1] and b[0 .. b_size-1] into dst, by divide-and-conquer: the middle element of the larger array
+    // is placed, after a binary search for its position in the other, and the two sides are merged in parallel. Stable: equal elements of a go before those of b.
+    template< class _Type, class _Compare >
+    inline void merge_parallel_ptr(const _Type* a, size_t a_size, const _Type* b, size_t b_size, _Type* dst, _Compare comp, size_t parallelThreshold = 32 * 1024)
+    {
+        if ((a_size + b_size) <= parallelThreshold)
+        {
+            std::merge(a, a + a_size, b, b + b_size, dst, comp);
+            return;
+        }
+        size_t a_split, b_split;
+        if (a_size >= b_size)
+        {
+            a_split = a_size / 2;
+            b_split = std::lower_bound(b, b + b_size, a[a_split], comp) - b;    // elements of b equal to the pivot go after it
+            dst[a_split + b_split] = a[a_split];
+            a_size -= a_split + 1;
+            b_size -= b_split;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            Concurrency::parallel_invoke(
+#else
+            tbb::parallel_invoke(
+#endif
+                [&] { merge_parallel_ptr(a, a_split, b, b_split, dst, comp, parallelThreshold); },
+                [&] { merge_parallel_ptr(a + a_split + 1, a_size, b + b_split, b_size, dst + a_split + b_split + 1, comp, parallelThreshold); }
+            );
+        }
+        else
+        {
+            b_split = b_size / 2;
+            a_split = std::upper_bound(a, a + a_size, b[b_split], comp) - a;    // elements of a equal to the pivot go before it
+            dst[a_split + b_split] = b[b_split];
+            a_size -= a_split;
+            b_size -= b_split + 1;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+            Concurrency::parallel_invoke(
+#else
+            tbb::parallel_invoke(
+#endif
+                [&] { merge_parallel_ptr(a, a_split, b, b_split, dst, comp, parallelThreshold); },
+                [&] { merge_parallel_ptr(a + a_split, a_size, b + b_split + 1, b_size, dst + a_split + b_split + 1, comp, parallelThreshold); }
+            );
+        }
+    }
+
+    // Parallel reduction of in_array[l .. r-1] with a commutative and associative operation. Small arrays use a single level of parallel tasks,
+    // larger ones recursive halving down to parallelThreshold
+    template< class _Type, class _Result, class _BinaryOperation >
+    inline _Result reduce_par_inner(const _Type* in_array, size_t l, size_t r, _Result init, _BinaryOperation op, size_t parallelThreshold)
+    {
+        if ((r - l) <= SmallParallelCutoff)
+        {
+            _Result result_of_chunk[SmallParallelMaxChunks];
+            size_t number_of_chunks = small_parallel_number_of_chunks(r - l, std::max(parallelThreshold / 2, (size_t)1));
+            small_parallel_for_chunks(l, r, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+                _Result result = c == 0 ? init : _Result(in_array[startIndex++]);
+                for (size_t current = startIndex; current < endIndex; current++)
+                    result = op(result, in_array[current]);
+                result_of_chunk[c] = result;
+            });
+            for (size_t c = 1; c < number_of_chunks; c++)
+                result_of_chunk[0] = op(result_of_chunk[0], result_of_chunk[c]);
+            return result_of_chunk[0];
+        }
+        size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;  // average without overflow
+        _Result result_left = init, result_right = init;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::parallel_invoke(
+#else
+        tbb::parallel_invoke(
+#endif
+            [&] { result_left  = reduce_par_inner(in_array, l, m, init, op, parallelThreshold); },
+            [&] { result_right = reduce_par_inner(in_array, m + 1, r, _Result(in_array[m]), op, parallelThreshold); }
+        );
+        return op(result_left, result_right);
+    }
+
+    // left (l) boundary is inclusive and right (r) boundary is exclusive
+    template< class _Type, class _Result, class _BinaryOperation >
+    inline _Result reduce_par(const _Type* in_array, size_t l, size_t r, _Result init, _BinaryOperation op, size_t parallelThreshold = 16 * 1024)
+    {
+        if (r <= l)
+            return init;
+        return reduce_par_inner(in_array, l, r, init, op, parallelThreshold);
+    }
+
+    // sort(policy, first, last[, comp])
+    // seq uses the serial Merge Sort, and par and par_unseq use the adaptive sort_par, or Parallel Merge Sort for comparisons other than operator<.
+    // When the work buffer can not be allocated, or the iterators are not contiguous, std::sort with the same policy is used.
+    template< class _ExecutionPolicy, class _RandomIt, class _Compare >
+    inline enable_if_execution_policy<_ExecutionPolicy> sort([[maybe_unused]] _ExecutionPolicy&& policy, _RandomIt first, _RandomIt last, _Compare comp)
+    {
+        if constexpr (!is_contiguous_iterator<_RandomIt>())
+            std::sort(std::forward<_ExecutionPolicy>(policy), first, last, comp);
+        else
+        {
+            typedef typename std::iterator_traits<_RandomIt>::value_type _Type;
+            if (last - first < 2)
+                return;
+            _Type* src = std::addressof(*first);
+            size_t size = (size_t)(last - first);
+            if constexpr (!is_sequenced_policy<_ExecutionPolicy>() && is_default_less<_Compare, _Type>())
+                sort_par(src, (size_t)0, size);
+            else
+            {
+                WorkBuffer<_Type> work(size);
+                if (!work)
+                {
+                    std::sort(std::forward<_ExecutionPolicy>(policy), first, last, comp);
+                    return;
+                }
+                if constexpr (is_sequenced_policy<_ExecutionPolicy>())
+                    merge_sort_hybrid(src, (size_t)0, size - 1, work.data(), false, comp);
+                else
+                    parallel_merge_sort_hybrid_rh_1(src, (size_t)0, size - 1, work.data(), false, comp);
+            }
+        }
+    }
+
+    template< class _ExecutionPolicy, class _RandomIt >
+    inline enable_if_execution_policy<_ExecutionPolicy> sort(_ExecutionPolicy&& policy, _RandomIt first, _RandomIt last)
+    {
+        ParallelAlgorithms::sort(std::forward<_ExecutionPolicy>(policy), first, last, std::less<>());
+    }
+
+    // merge(policy, first1, last1, first2, last2, d_first[, comp]), returning the end of the output. Stable.
+    // seq uses the serial merge, and par and par_unseq the parallel divide-and-conquer merge, or std::merge for iterators which are not contiguous
+    template< class _ExecutionPolicy, class _RandomIt1, class _RandomIt2, class _RandomIt3, class _Compare >
+    inline enable_if_execution_policy<_ExecutionPolicy, _RandomIt3> merge([[maybe_unused]] _ExecutionPolicy&& policy, _RandomIt1 first1, _RandomIt1 last1,
+                                                                         _RandomIt2 first2, _RandomIt2 last2, _RandomIt3 d_first, _Compare comp)
+    {
+        if constexpr (is_sequenced_policy<_ExecutionPolicy>())
+            return std::merge(first1, last1, first2, last2, d_first, comp);
+        else if constexpr (!is_contiguous_iterator<_RandomIt1>() || !is_contiguous_iterator<_RandomIt2>() || !is_contiguous_iterator<_RandomIt3>())
+            return std::merge(std::forward<_ExecutionPolicy>(policy), first1, last1, first2, last2, d_first, comp);
+        else
+        {
+            typedef typename std::iterator_traits<_RandomIt3>::value_type _Type;
+            size_t size1 = (size_t)(last1 - first1);
+            size_t size2 = (size_t)(last2 - first2);
+            if (size1 + size2 == 0)
+                return d_first;
+            const _Type* a = size1 ? std::addressof(*first1) : nullptr;
+            const _Type* b = size2 ? std::addressof(*first2) : nullptr;
+            run_kernel(KernelBound::Memory, [&] {         // merging is memory-bound, and runs on physical cores
+                merge_parallel_ptr(a, size1, b, size2, std::addressof(*d_first), comp);
+            });
+            return d_first + (size1 + size2);
+        }
+    }
+
+    template< class _ExecutionPolicy, class _RandomIt1, class _RandomIt2, class _RandomIt3 >
+    inline enable_if_execution_policy<_ExecutionPolicy, _RandomIt3> merge(_ExecutionPolicy&& policy, _RandomIt1 first1, _RandomIt1 last1,
+                                                                         _RandomIt2 first2, _RandomIt2 last2, _RandomIt3 d_first)
+    {
+        return ParallelAlgorithms::merge(std::forward<_ExecutionPolicy>(policy), first1, last1, first2, last2, d_first, std::less<>());
+    }
+
+    // reduce(policy, first, last[, init[, op]]), with op commutative and associative, as for std::reduce
+    template< class _ExecutionPolicy, class _RandomIt, class _Result, class _BinaryOperation >
+    inline enable_if_execution_policy<_ExecutionPolicy, _Result> reduce([[maybe_unused]] _ExecutionPolicy&& policy, _RandomIt first, _RandomIt last, _Result init, _BinaryOperation op)
+    {
+        if constexpr (is_sequenced_policy<_ExecutionPolicy>())
+            return std::accumulate(first, last, init, op);
+        else if constexpr (!is_contiguous_iterator<_RandomIt>())
+            return std::reduce(std::forward<_ExecutionPolicy>(policy), first, last, init, op);
+        else
+        {
+            if (first == last)
+                return init;
+            return reduce_par(std::addressof(*first), (size_t)0, (size_t)(last - first), init, op);
+        }
+    }
+
+    template< class _ExecutionPolicy, class _RandomIt, class _Result >
+    inline enable_if_execution_policy<_ExecutionPolicy, _Result> reduce(_ExecutionPolicy&& policy, _RandomIt first, _RandomIt last, _Result init)
+    {
+        return ParallelAlgorithms::reduce(std::forward<_ExecutionPolicy>(policy), first, last, init, std::plus<>());
+    }
+
+    template< class _ExecutionPolicy, class _RandomIt >
+    inline enable_if_execution_policy<_ExecutionPolicy, typename std::iterator_traits<_RandomIt>::value_type> reduce(_ExecutionPolicy&& policy, _RandomIt first, _RandomIt last)
+    {
+        return ParallelAlgorithms::reduce(std::forward<_ExecutionPolicy>(policy), first, last, typename std::iterator_traits<_RandomIt>::value_type{}, std::plus<>());
+    }
+
+    // sort(options, policy, ...), merge(options, policy, ...) and reduce(options, policy, ...) run within the arena given by options
+    template< class... _Args >
+    inline decltype(auto) sort(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::sort(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) merge(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::merge(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) reduce(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::reduce(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) reduce_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::reduce_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
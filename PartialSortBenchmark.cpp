@@ -0,0 +1,81 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+
+#include "PartialSortParallel.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Top-K of N across a range of K/N ratios: full parallel sort, standard C++ partial_sort_copy, per-task bounded heaps, and Radix Select
+int PartialSortBenchmark(vector<unsigned long>& ulongs)
+{
+	const double ratios[] = { 0.000001, 0.0001, 0.01, 0.1 };
+
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(std::execution::par_unseq, sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+
+	for (double ratio : ratios)
+	{
+		size_t k = std::max((size_t)(ratio * ulongs.size()), (size_t)1);
+		vector<unsigned long> top_k(k);
+		printf("K = %zu of N = %zu (K/N = %g)\n", k, ulongs.size(), ratio);
+
+		for (int i = 0; i < iterationCount; ++i)
+		{
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			auto startTime = high_resolution_clock::now();
+			ParallelAlgorithms::sort_par(ulongsCopy.data(), ulongsCopy.size());
+			auto endTime = high_resolution_clock::now();
+			print_results("Full Parallel Sort       ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+
+			startTime = high_resolution_clock::now();
+			std::partial_sort_copy(ulongs.begin(), ulongs.end(), top_k.begin(), top_k.end());
+			endTime = high_resolution_clock::now();
+			print_results("std::partial_sort_copy  ", top_k.data(), k, startTime, endTime);
+			if (!std::equal(top_k.begin(), top_k.end(), sorted_reference.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::partial_sort_copy_heap_par(ulongs.data(), ulongs.size(), top_k.data(), k);
+			endTime = high_resolution_clock::now();
+			print_results("Parallel Top-K Heaps     ", top_k.data(), k, startTime, endTime);
+			if (!std::equal(top_k.begin(), top_k.end(), sorted_reference.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::partial_sort_copy_radix_par(ulongs.data(), ulongs.size(), top_k.data(), k);
+			endTime = high_resolution_clock::now();
+			print_results("Parallel Top-K Radix     ", top_k.data(), k, startTime, endTime);
+			if (!std::equal(top_k.begin(), top_k.end(), sorted_reference.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+// Parallel Partial Sort (top-K): the smallest K of N elements, in sorted order, without sorting all N elements
+
+#ifndef _PartialSortParallel_h
+#define _PartialSortParallel_h
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "SortParallel.h"
+#include "RadixSelectParallel.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // Sort the K selected elements in dst[0 .. k-1]
+    template< class _Type >
+    inline void partial_sort_final_sort(_Type* dst, size_t k)
+    {
+        if (k <= 64 * 1024)
+            std::sort(dst, dst + k);
+        else
+            sort_par(dst, k);
+    }
+
+    // Top-K for any data type with comparable elements. The array is split into chunks, one per task. Each chunk selects its own smallest K
+    // elements as candidates, using a bounded max-heap when K is small relative to the chunk, or nth_element on a copy of the chunk otherwise.
+    // The candidates of all chunks are then narrowed down to the smallest K, which are sorted into dst[0 .. k-1].
+    template< class _Type >
+    inline void partial_sort_copy_heap_par(const _Type* src, size_t src_size, _Type* dst, size_t k, size_t parallelThreshold = 64 * 1024)
+    {
+        k = std::min(k, src_size);
+        if (k == 0)
+            return;
+        if (k > src_size / 8)                   // most of the array is needed, which a full sort does faster
+        {
+            std::vector<_Type> all(src, src + src_size);
+            sort_par(all.data(), src_size);
+            std::copy(all.begin(), all.begin() + k, dst);
+            return;
+        }
+        size_t processor_count = small_parallel_processor_count();
+        size_t number_of_chunks = std::max(processor_count, (size_t)1) * 4;
+        number_of_chunks = std::max(std::min(number_of_chunks, src_size / parallelThreshold), (size_t)1);
+        size_t chunk_size = (src_size + number_of_chunks - 1) / number_of_chunks;
+
+        // each chunk has a slot of min(k, size of chunk) candidates, which adds up to no more than src_size
+        std::vector<size_t> start_of_candidates(number_of_chunks + 1, 0);
+        for (size_t c = 0; c < number_of_chunks; c++)
+        {
+            size_t size_of_chunk = std::min(chunk_size, src_size - std::min(c * chunk_size, src_size));
+            start_of_candidates[c + 1] = start_of_candidates[c] + std::min(k, size_of_chunk);
+        }
+        size_t total_candidates = start_of_candidates[number_of_chunks];
+        std::vector<_Type> candidates(total_candidates);
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t c = 0; c < number_of_chunks; c++)
+        {
+            g.run([&, c] {
+                const _Type* chunk = src + std::min(c * chunk_size, src_size);
+                size_t size_of_chunk = std::min(chunk_size, src_size - std::min(c * chunk_size, src_size));
+                _Type* chunk_candidates = candidates.data() + start_of_candidates[c];
+                size_t kc = start_of_candidates[c + 1] - start_of_candidates[c];
+                if (kc == 0)
+                    return;
+                if (kc <= size_of_chunk / 16)
+                {
+                    std::copy(chunk, chunk + kc, chunk_candidates);           // bounded max-heap of the smallest kc elements seen so far
+                    std::make_heap(chunk_candidates, chunk_candidates + kc);
+                    for (size_t i = kc; i < size_of_chunk; i++)
+                    {
+                        if (chunk[i] < chunk_candidates[0])
+                        {
+                            std::pop_heap(chunk_candidates, chunk_candidates + kc);
+                            chunk_candidates[kc - 1] = chunk[i];
+                            std::push_heap(chunk_candidates, chunk_candidates + kc);
+                        }
+                    }
+                }
+                else
+                {
+                    std::vector<_Type> copy_of_chunk(chunk, chunk + size_of_chunk);
+                    std::nth_element(copy_of_chunk.begin(), copy_of_chunk.begin() + (kc - 1), copy_of_chunk.end());
+                    std::copy(copy_of_chunk.begin(), copy_of_chunk.begin() + kc, chunk_candidates);
+                }
+            });
+        }
+        g.wait();
+
+        std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.begin() + total_candidates);
+        std::copy(candidates.begin(), candidates.begin() + k, dst);
+        partial_sort_final_sort(dst, k);
+    }
+
+    // Top-K for unsigned long keys using Radix Select. The K-th smallest value T is found digit by digit from parallel histograms,
+    // then all elements smaller than T are gathered in parallel, and the remaining places are filled with copies of T.
+    inline void partial_sort_copy_radix_par(const unsigned long* src, size_t src_size, unsigned long* dst, size_t k)
+    {
+        k = std::min(k, src_size);
+        if (k == 0)
+            return;
+        size_t count_less = 0;
+        unsigned long kth_value = radix_select_par(src, src_size, k - 1, &count_less);
+        copy_if_par(src, src_size, dst, [kth_value](unsigned long x) { return x < kth_value; });
+        std::fill(dst + count_less, dst + k, kth_value);
+        partial_sort_final_sort(dst, count_less);       // copies of the K-th value are already in place at the end
+    }
+
+    // Place the smallest k elements of src[0 .. src_size-1] in sorted order into dst[0 .. k-1], leaving src unmodified.
+    // Radix Select is used for unsigned long keys, and per-task bounded heaps for all other types.
+    template< class _Type >
+    inline void partial_sort_copy_par(const _Type* src, size_t src_size, _Type* dst, size_t k)
+    {
+        if constexpr (std::is_same<_Type, unsigned long>::value)
+            partial_sort_copy_radix_par(src, src_size, dst, k);
+        else
+            partial_sort_copy_heap_par(src, src_size, dst, k);
+    }
+
+    template< class _Type >
+    inline std::vector<_Type> partial_sort_copy_par(const std::vector<_Type>& src, size_t k)
+    {
+        std::vector<_Type> dst(std::min(k, src.size()));
+        partial_sort_copy_par(src.data(), src.size(), dst.data(), dst.size());
+        return dst;
+    }
+
+    template< class... _Args >
+    inline decltype(auto) partial_sort_copy_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::partial_sort_copy_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
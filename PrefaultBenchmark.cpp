@@ -0,0 +1,97 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "RadixSortLsdParallel.h"
+#include "WorkBufferPool.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// LSD Radix Sort with a newly allocated work buffer: faulted in inside the sort, paged in serially beforehand as the other benchmarks do,
+// pre-faulted in parallel, and populated by the kernel with MAP_POPULATE. Times include the allocation and the pre-faulting.
+// The buffers are not cached, so that each iteration pays for a new one
+int PrefaultBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	size_t size = ulongs.size();
+	ParallelAlgorithms::WorkBufferPool not_cached_pool(0);
+
+	sort(sorted_reference.begin(), sorted_reference.end());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		auto startTime = high_resolution_clock::now();
+		unsigned long* work = new unsigned long[size];
+		SortRadixPar(ulongsCopy.data(), work, size);
+		delete[] work;
+		auto endTime = high_resolution_clock::now();
+		print_results("LSD Radix Sort, faulted in during the sort", ulongsCopy.data(), size, startTime, endTime);
+		if (sorted_reference != ulongsCopy)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		work = new unsigned long[size];
+		for (size_t j = 0; j < size; j++)
+			work[j] = j;									// page in the destination array into system memory
+		SortRadixPar(ulongsCopy.data(), work, size);
+		delete[] work;
+		endTime = high_resolution_clock::now();
+		print_results("LSD Radix Sort, paged in serially         ", ulongsCopy.data(), size, startTime, endTime);
+		if (sorted_reference != ulongsCopy)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		{
+			ParallelAlgorithms::WorkBuffer<unsigned long> work_buffer(size, ParallelAlgorithms::Prefault::Touch, not_cached_pool);
+			SortRadixPar(ulongsCopy.data(), work_buffer.data(), size);
+		}
+		endTime = high_resolution_clock::now();
+		print_results("LSD Radix Sort, pre-faulted in parallel   ", ulongsCopy.data(), size, startTime, endTime);
+		if (sorted_reference != ulongsCopy)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		{
+			ParallelAlgorithms::WorkBuffer<unsigned long> work_buffer(size, ParallelAlgorithms::Prefault::Populate, not_cached_pool);
+			SortRadixPar(ulongsCopy.data(), work_buffer.data(), size);
+		}
+		endTime = high_resolution_clock::now();
+		print_results("LSD Radix Sort, populated by the kernel   ", ulongsCopy.data(), size, startTime, endTime);
+		if (sorted_reference != ulongsCopy)
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	return 0;
+}
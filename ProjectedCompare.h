@@ -0,0 +1,62 @@
+// Comparison and projection arguments of the merge and merge sort engines: the engines take a single comparison, and a projection,
+// such as a member of a struct, is folded into it. The default std::less<> inlines to operator<, which costs nothing over the plain versions
+
+#ifndef _ProjectedCompare_h
+#define _ProjectedCompare_h
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace ParallelAlgorithms
+{
+    // Projection that returns the element itself, as std::identity of C++20
+    struct identity_projection
+    {
+        template< class _Type >
+        constexpr _Type&& operator()(_Type&& value) const noexcept
+        {
+            return std::forward<_Type>(value);
+        }
+    };
+
+    // comp(proj(a), proj(b))
+    template< class _Compare, class _Projection >
+    struct projected_compare
+    {
+        _Compare    comp;
+        _Projection proj;
+
+        template< class _Type1, class _Type2 >
+        bool operator()(const _Type1& a, const _Type2& b) const
+        {
+            return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+        }
+    };
+
+    template< class _Compare, class _Projection >
+    inline projected_compare<_Compare, _Projection> make_projected_compare(_Compare comp, _Projection proj)
+    {
+        return projected_compare<_Compare, _Projection>{ comp, proj };
+    }
+
+    // The identity projection leaves the comparison unwrapped
+    template< class _Compare >
+    inline _Compare make_projected_compare(_Compare comp, identity_projection)
+    {
+        return comp;
+    }
+
+    // Keeps the overloads with a comparison from taking the size_t threshold argument of the overloads without one
+    template< class _Compare >
+    using enable_if_compare = typename std::enable_if< !std::is_arithmetic<_Compare>::value >::type;
+
+    // Whether the comparison is operator<, for which the engines can use sorting networks and other type-specific kernels
+    template< class _Compare, class _Type >
+    constexpr bool is_default_less()
+    {
+        return std::is_same<_Compare, std::less<_Type> >::value || std::is_same<_Compare, std::less<> >::value;
+    }
+}
+
+#endif
@@ -0,0 +1,78 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+
+#include "SortParallel.h"
+#include "RadixSelectParallel.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// nth_element and 100 quantiles of N: standard C++ nth_element and full parallel sort, versus Radix Select
+int RadixSelectBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> sorted_reference(ulongs);
+	sort(std::execution::par_unseq, sorted_reference.begin(), sorted_reference.end());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	size_t n = ulongs.size() / 2;
+
+	vector<double> fractions;
+	for (int q = 0; q <= 100; q++)
+		fractions.push_back(q / 100.0);
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		auto startTime = high_resolution_clock::now();
+		std::nth_element(std::execution::par_unseq, ulongsCopy.begin(), ulongsCopy.begin() + n, ulongsCopy.end());
+		auto endTime = high_resolution_clock::now();
+		print_results("std::nth_element          ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::nth_element_radix_par(ulongsCopy.data(), ulongsCopy.size(), n);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Radix nth_element", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+		if (ulongsCopy[n] != sorted_reference[n])
+		{
+			printf("nth elements are not equal\n");
+			exit(1);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::sort_par(ulongsCopy.data(), ulongsCopy.size());
+		endTime = high_resolution_clock::now();
+		print_results("100 Quantiles by Sorting  ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+
+		startTime = high_resolution_clock::now();
+		vector<unsigned long> quantiles = ParallelAlgorithms::quantiles_radix_par(ulongs.data(), ulongs.size(), fractions);
+		endTime = high_resolution_clock::now();
+		print_results("100 Quantiles Radix Select", quantiles.data(), quantiles.size(), startTime, endTime);
+		for (size_t q = 0; q < quantiles.size(); q++)
+		{
+			if (quantiles[q] != sorted_reference[(size_t)(fractions[q] * (double)(ulongs.size() - 1))])
+			{
+				printf("Quantiles are not equal\n");
+				exit(1);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,353 @@
+// Parallel Radix Select for unsigned integer arrays, which narrows down to the k-th smallest value one digit at a time,
+// using the parallel byte histograms of the MSD Radix Sort, instead of sorting
+
+#ifndef _RadixSelectParallel_h
+#define _RadixSelectParallel_h
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "RadixSortMsdParallel.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // Copy the elements of src that satisfy pred into dst, keeping their order. dst must be large enough to hold all of the selected elements.
+    // Returns the number of elements copied.
+    template< class _Type, class _Predicate >
+    inline size_t copy_if_par(const _Type* src, size_t src_size, _Type* dst, _Predicate pred, size_t parallelThreshold = 64 * 1024)
+    {
+        size_t quanta = (src_size + parallelThreshold - 1) / parallelThreshold;
+        if (quanta <= 1)
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < src_size; i++)
+                if (pred(src[i]))
+                    dst[count++] = src[i];
+            return count;
+        }
+        std::vector< std::vector<_Type> > selected(quanta);
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t q = 0; q < quanta; q++)
+        {
+            g.run([&, q] {
+                size_t startIndex = q * parallelThreshold;
+                size_t   endIndex = std::min(startIndex + parallelThreshold, src_size);     // non-inclusive
+                for (size_t i = startIndex; i < endIndex; i++)
+                    if (pred(src[i]))
+                        selected[q].push_back(src[i]);
+            });
+        }
+        g.wait();
+
+        size_t count = 0;
+        for (size_t q = 0; q < quanta; q++)
+        {
+            _Type* dst_of_quantum = dst + count;
+            g.run([&, q, dst_of_quantum] { std::copy(selected[q].begin(), selected[q].end(), dst_of_quantum); });
+            count += selected[q].size();
+        }
+        g.wait();
+        return count;
+    }
+
+    // Returns the k-th smallest value (k starting at 0) of a[0 .. a_size-1], without modifying the array, the number of elements
+    // that are smaller than that value in count_less, and the number of elements equal to it in count_equal (when not null). k must be less than a_size.
+    // Each step histograms the current digit of the remaining candidates, finds the bin holding the k-th element, and keeps only that bin's
+    // elements as candidates for the next digit. Only the first histogram reads the whole array, as each bin is about 1/256th of the candidates.
+    inline unsigned long radix_select_par(const unsigned long* a, size_t a_size, size_t k, size_t* count_less = nullptr, size_t* count_equal = nullptr)
+    {
+        const unsigned long PowerOfTwoRadix = 256;
+        const unsigned long Log2ofPowerOfTwoRadix = 8;
+        const size_t SelectThreshold = 4096;      // few enough candidates to select among them directly
+
+        unsigned long* candidates = const_cast<unsigned long*>(a);     // the histogram only reads the array
+        size_t number_of_candidates = a_size;
+        std::vector<unsigned long> candidates_buffer;
+        unsigned long value = 0;
+        size_t less = 0;
+
+        for (long shiftRight = (long)(sizeof(unsigned long) * 8 - Log2ofPowerOfTwoRadix); shiftRight >= 0; shiftRight -= Log2ofPowerOfTwoRadix)
+        {
+            if (number_of_candidates <= SelectThreshold)
+            {
+                std::vector<unsigned long> remaining(candidates, candidates + number_of_candidates);
+                std::nth_element(remaining.begin(), remaining.begin() + k, remaining.end());
+                value = remaining[k];
+                size_t less_in_remaining = std::count_if(remaining.begin(), remaining.begin() + k, [value](unsigned long x) { return x < value; });
+                if (count_less)  *count_less  = less + less_in_remaining;
+                if (count_equal) *count_equal = std::count(remaining.begin(), remaining.end(), value);
+                return value;
+            }
+            size_t* count = run_kernel(KernelBound::Memory, [&] {     // the histogram is memory-bound, and runs on physical cores
+                return HistogramOneByteComponentParallel< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(candidates, 0, number_of_candidates - 1, (unsigned long)shiftRight);
+            });
+            unsigned long digit = 0;
+            while (k >= count[digit])
+                k -= count[digit++];
+            size_t number_in_bin = count[digit];
+            for (unsigned long d = 0; d < digit; d++)
+                less += count[d];
+            delete[] count;
+
+            value |= digit << shiftRight;
+            if (number_in_bin != number_of_candidates)     // all candidates having the same digit need no narrowing
+            {
+                std::vector<unsigned long> next_candidates(number_in_bin);
+                copy_if_par(candidates, number_of_candidates, next_candidates.data(),
+                            [digit, shiftRight](unsigned long x) { return ((x >> shiftRight) & 0xff) == digit; });
+                candidates_buffer.swap(next_candidates);
+                candidates = candidates_buffer.data();
+                number_of_candidates = number_in_bin;
+            }
+        }
+        if (count_less)  *count_less  = less;
+        if (count_equal) *count_equal = number_of_candidates;     // all remaining candidates have every digit of value
+        return value;
+    }
+    // In-place parallel partition of a[0 .. a_size-1], when the number of elements satisfying pred (count_true) is already known.
+    // Elements satisfying pred are moved to a[0 .. count_true-1]. Only misplaced elements are moved: the ones not satisfying pred
+    // in the front region are swapped with the ones satisfying pred in the back region, the i-th misplaced element of the front with
+    // the i-th misplaced element of the back. Each task swaps the misplaced elements of one quantum of the front region, with the
+    // matching misplaced elements of the back region, whose start a read-only pass locates from the per-quantum counts beforehand.
+    template< class _Type, class _Predicate >
+    inline void partition_known_count_par(_Type* a, size_t a_size, size_t count_true, _Predicate pred, size_t parallelThreshold = 64 * 1024)
+    {
+        if (count_true == 0 || count_true >= a_size)
+            return;
+        _Type* back = a + count_true;
+        size_t back_size = a_size - count_true;
+        size_t front_quanta = (count_true + parallelThreshold - 1) / parallelThreshold;
+        size_t  back_quanta = (back_size  + parallelThreshold - 1) / parallelThreshold;
+
+        std::vector<size_t> front_misplaced(front_quanta + 1, 0), back_misplaced(back_quanta + 1, 0);     // counts, then exclusive prefix sums
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t q = 0; q < front_quanta; q++)
+            g.run([&, q] {
+                size_t end = std::min((q + 1) * parallelThreshold, count_true);
+                for (size_t i = q * parallelThreshold; i < end; i++)
+                    front_misplaced[q + 1] += !pred(a[i]);
+            });
+        for (size_t q = 0; q < back_quanta; q++)
+            g.run([&, q] {
+                size_t end = std::min((q + 1) * parallelThreshold, back_size);
+                for (size_t i = q * parallelThreshold; i < end; i++)
+                    back_misplaced[q + 1] += pred(back[i]) ? 1 : 0;
+            });
+        g.wait();
+        for (size_t q = 0; q < front_quanta; q++)  front_misplaced[q + 1] += front_misplaced[q];
+        for (size_t q = 0; q < back_quanta;  q++)   back_misplaced[q + 1] +=  back_misplaced[q];
+
+        // Where in the back region the misplaced element matching the first misplaced element of each front quantum is, found before any
+        // element is swapped. Each task then swaps only within back[back_start[q] ..], up to the start of the next task's elements
+        std::vector<size_t> back_start(front_quanta, 0);
+        for (size_t q = 0; q < front_quanta; q++)
+        {
+            if (front_misplaced[q + 1] == front_misplaced[q])
+                continue;
+            g.run([&, q] {
+                size_t rank = front_misplaced[q];       // rank of the first misplaced element of this quantum, among all misplaced elements
+                size_t back_quantum = std::upper_bound(back_misplaced.begin(), back_misplaced.end(), rank) - back_misplaced.begin() - 1;
+                size_t skip = rank - back_misplaced[back_quantum];
+                size_t j = back_quantum * parallelThreshold;
+                for (;; j++)                            // skip over the misplaced elements of the back region, which belong to earlier quanta
+                    if (pred(back[j]) && skip-- == 0)
+                        break;
+                back_start[q] = j;
+            });
+        }
+        g.wait();
+
+        for (size_t q = 0; q < front_quanta; q++)
+        {
+            if (front_misplaced[q + 1] == front_misplaced[q])
+                continue;
+            g.run([&, q] {
+                size_t j = back_start[q];
+                size_t end = std::min((q + 1) * parallelThreshold, count_true);
+                for (size_t i = q * parallelThreshold; i < end; i++)
+                {
+                    if (pred(a[i]))
+                        continue;
+                    while (!pred(back[j]))  j++;
+                    std::swap(a[i], back[j++]);
+                }
+            });
+        }
+        g.wait();
+    }
+
+    // Parallel nth_element for unsigned long arrays: afterwards a[n] holds the value that would be there if the array was sorted,
+    // all elements before it are not greater, and all elements after it are not smaller. n must be less than a_size.
+    // Radix Select finds the value, along with how many elements are smaller and equal to it, without moving any elements.
+    // Then only two in-place partitions are done: smaller elements to the front, followed by the elements equal to the value.
+    inline void nth_element_radix_par(unsigned long* a, size_t a_size, size_t n)
+    {
+        if (a_size < 2 || n >= a_size)
+            return;
+        size_t count_less = 0, count_equal = 0;
+        unsigned long nth_value = radix_select_par(a, a_size, n, &count_less, &count_equal);
+        partition_known_count_par(a, a_size, count_less, [nth_value](unsigned long x) { return x < nth_value; });
+        partition_known_count_par(a + count_less, a_size - count_less, count_equal, [nth_value](unsigned long x) { return x == nth_value; });
+    }
+
+    // Gathers the elements of the wanted bins of the current digit into one buffer per wanted bin, with a single parallel pass over the candidates.
+    // bin_of_digit[digit] is the index of the buffer for that digit, or -1 for digits that are not wanted.
+    inline void _RadixSelectGatherBins(const unsigned long* candidates, size_t number_of_candidates, long shiftRight, const long* bin_of_digit,
+                                       std::vector< std::vector<unsigned long> >& bins, size_t parallelThreshold = 64 * 1024)
+    {
+        size_t quanta = (number_of_candidates + parallelThreshold - 1) / parallelThreshold;
+        size_t number_of_bins = bins.size();
+        std::vector< std::vector< std::vector<unsigned long> > > gathered(quanta, std::vector< std::vector<unsigned long> >(number_of_bins));
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t q = 0; q < quanta; q++)
+            g.run([&, q] {
+                size_t end = std::min((q + 1) * parallelThreshold, number_of_candidates);
+                for (size_t i = q * parallelThreshold; i < end; i++)
+                {
+                    long bin = bin_of_digit[(candidates[i] >> shiftRight) & 0xff];
+                    if (bin >= 0)
+                        gathered[q][bin].push_back(candidates[i]);
+                }
+            });
+        g.wait();
+        for (size_t b = 0; b < number_of_bins; b++)
+            g.run([&, b] {
+                for (size_t q = 0; q < quanta; q++)
+                    bins[b].insert(bins[b].end(), gathered[q][b].begin(), gathered[q][b].end());
+            });
+        g.wait();
+    }
+
+    // ranks holds (rank among the candidates, index into values) pairs, sorted by rank. All candidates share the digits above shiftRight, which are in prefix.
+    inline void _RadixSelectMultiple(const unsigned long* candidates, size_t number_of_candidates, long shiftRight, unsigned long prefix,
+                                     const std::vector< std::pair<size_t, size_t> >& ranks, unsigned long* values)
+    {
+        const unsigned long PowerOfTwoRadix = 256;
+        const unsigned long Log2ofPowerOfTwoRadix = 8;
+        const size_t SelectThreshold = 4096;      // few enough candidates to sort them
+
+        if (shiftRight < 0)                     // all digits have been processed, leaving candidates which are all equal to prefix
+        {
+            for (size_t i = 0; i < ranks.size(); i++)
+                values[ranks[i].second] = prefix;
+            return;
+        }
+        if (number_of_candidates <= SelectThreshold)
+        {
+            std::vector<unsigned long> remaining(candidates, candidates + number_of_candidates);
+            std::sort(remaining.begin(), remaining.end());
+            for (size_t i = 0; i < ranks.size(); i++)
+                values[ranks[i].second] = remaining[ranks[i].first];
+            return;
+        }
+        size_t* count = run_kernel(KernelBound::Memory, [&] {
+            return HistogramOneByteComponentParallel< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(const_cast<unsigned long*>(candidates), 0, number_of_candidates - 1, (unsigned long)shiftRight);
+        });
+
+        // Group the ranks by the bin they fall into
+        std::vector<unsigned long> wanted_digits;
+        std::vector< std::vector< std::pair<size_t, size_t> > > ranks_of_bin;
+        long bin_of_digit[PowerOfTwoRadix];
+        size_t start_of_bin = 0, r = 0;
+        for (unsigned long digit = 0; digit < PowerOfTwoRadix; digit++)
+        {
+            bin_of_digit[digit] = -1;
+            size_t end_of_bin = start_of_bin + count[digit];
+            if (r < ranks.size() && ranks[r].first < end_of_bin)
+            {
+                bin_of_digit[digit] = (long)wanted_digits.size();
+                wanted_digits.push_back(digit);
+                ranks_of_bin.emplace_back();
+                for (; r < ranks.size() && ranks[r].first < end_of_bin; r++)
+                    ranks_of_bin.back().push_back(std::pair<size_t, size_t>(ranks[r].first - start_of_bin, ranks[r].second));
+            }
+            start_of_bin = end_of_bin;
+        }
+        bool constant_digit = count[wanted_digits[0]] == number_of_candidates;
+        delete[] count;
+
+        if (constant_digit)     // all candidates having the same digit need no narrowing
+        {
+            _RadixSelectMultiple(candidates, number_of_candidates, shiftRight - (long)Log2ofPowerOfTwoRadix, prefix | (wanted_digits[0] << shiftRight), ranks, values);
+            return;
+        }
+        std::vector< std::vector<unsigned long> > bins(wanted_digits.size());
+        _RadixSelectGatherBins(candidates, number_of_candidates, shiftRight, bin_of_digit, bins);
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t b = 0; b < bins.size(); b++)
+            g.run([&, b] {
+                _RadixSelectMultiple(bins[b].data(), bins[b].size(), shiftRight - (long)Log2ofPowerOfTwoRadix, prefix | (wanted_digits[b] << shiftRight), ranks_of_bin[b], values);
+                std::vector<unsigned long>().swap(bins[b]);
+            });
+        g.wait();
+    }
+
+    // Selects several order statistics at once: values[i] is the ranks[i]-th smallest value (starting at 0) of a[0 .. a_size-1], without modifying the array.
+    // All ranks must be less than a_size. Ranks falling into the same bin share the narrowing down of that bin, and different bins are narrowed in parallel.
+    inline void radix_select_multiple_par(const unsigned long* a, size_t a_size, const size_t* ranks, size_t number_of_ranks, unsigned long* values)
+    {
+        if (number_of_ranks == 0 || a_size == 0)
+            return;
+        std::vector< std::pair<size_t, size_t> > sorted_ranks(number_of_ranks);
+        for (size_t i = 0; i < number_of_ranks; i++)
+            sorted_ranks[i] = std::pair<size_t, size_t>(ranks[i], i);
+        std::sort(sorted_ranks.begin(), sorted_ranks.end());
+        _RadixSelectMultiple(a, a_size, (long)(sizeof(unsigned long) * 8 - 8), 0, sorted_ranks, values);
+    }
+
+    // Quantiles of an unsigned long array, without sorting it: the value at rank floor(fraction * (a_size - 1)) for each fraction in [0.0, 1.0]
+    inline std::vector<unsigned long> quantiles_radix_par(const unsigned long* a, size_t a_size, const std::vector<double>& fractions)
+    {
+        std::vector<unsigned long> values(a_size > 0 ? fractions.size() : 0);
+        std::vector<size_t> ranks(values.size());
+        for (size_t i = 0; i < ranks.size(); i++)
+            ranks[i] = (size_t)(std::min(std::max(fractions[i], 0.0), 1.0) * (double)(a_size - 1));
+        radix_select_multiple_par(a, a_size, ranks.data(), ranks.size(), values.data());
+        return values;
+    }
+
+    // Selection within the arena, and on the threads, given by options
+    template< class... _Args >
+    inline decltype(auto) radix_select_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::radix_select_par(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) nth_element_radix_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::nth_element_radix_par(std::forward<_Args>(args)...); });
+    }
+
+    template< class... _Args >
+    inline decltype(auto) quantiles_radix_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::quantiles_radix_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
@@ -10,7 +10,10 @@
 #include "RadixSortCommon.h"
 #include "RadixSortMSD.h"
 #include "InsertionSort.h"
+#include "SortingNetwork.h"
 #include "ParallelMergeSort.h"
+#include "MemoryBudget.h"
+#include "ParallelOptions.h"
 
 extern unsigned long long physical_memory_used_in_megabytes();
 extern unsigned long long physical_memory_total_in_megabytes();
@@ -58,18 +61,11 @@ inline unsigned long* HistogramByteComponents_1(unsigned long inArray[], size_t
 	for (unsigned i = 0; i < numberOfDigits * numberOfBins; i++)
 		count[i] = 0;
 
-	unsigned long* count0 = count + (0 * numberOfBins);
-	unsigned long* count1 = count + (1 * numberOfBins);
-	unsigned long* count2 = count + (2 * numberOfBins);
-	unsigned long* count3 = count + (3 * numberOfBins);
-
 	for (size_t current = l; current <= r; current++)    // Scan the array and count the number of times each digit value appears - i.e. size of each bin
 	{
 		unsigned long value = inArray[current];
-		count0[ value        & 0xff]++;
-		count1[(value >>  8) & 0xff]++;
-		count2[(value >> 16) & 0xff]++;
-		count3[(value >> 24) & 0xff]++;
+		for (unsigned d = 0; d < sizeof(unsigned long); d++)	// every byte, as unsigned long is 64-bit on Linux
+			count[d * numberOfBins + ((value >> (8 * d)) & 0xff)]++;
 	}
 	return count;
 }
@@ -135,7 +131,7 @@ inline void _RadixSortLSD_StableUnsigned_PowerOf2RadixScalar_TwoPhase_1(unsigned
 
 	unsigned long* count2D = HistogramByteComponents_1 <PowerOfTwoRadix, Log2ofPowerOfTwoRadix>(input_array, 0, last);
 
-	while (currentDigit <= maxDigit)						// end processing digits when all the mask bits have been processes and shift out, leaving none
+	while (currentDigit < maxDigit)						// end processing digits when all the mask bits have been processes and shift out, leaving none
 	{
 		unsigned long* count = count2D + (currentDigit * numberOfBins);
 
@@ -183,7 +179,7 @@ inline void RadixSortLSDPowerOf2Radix_unsigned_TwoPhase(unsigned long* a, unsign
 	}
 	else {
 		// TODO: Substitute Merge Sort, as it will get rid off the for loop, since it's internal to MergeSort
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+		ParallelAlgorithms::small_sort_hybrid(a, a_size);
 		for (size_t j = 0; j < a_size; j++)	// copy from input array to the destination array
 			b[j] = a[j];
 	}
@@ -280,6 +276,7 @@ void _RadixSortLSD_StableUnsigned_PowerOf2Radix_TwoPhase_DeRandomize(unsigned lo
 	delete[] bufferIndex;
 	delete[] bufferDerandomize;
 #endif
+	delete[] count2D;
 }
 
 // LSD Radix Sort - stable (LSD has to be, and this may preclude LSD Radix from being able to be in-place)
@@ -299,7 +296,7 @@ inline void RadixSortLSDPowerOf2Radix_unsigned_TwoPhase_DeRandomize(unsigned lon
 	}
 	else {
 		// TODO: Substitute Merge Sort, as it will get rid off the for loop, since it's internal to MergeSort
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+		ParallelAlgorithms::small_sort_hybrid(a, a_size);
 		for (unsigned long j = 0; j < a_size; j++)	// copy from input array to the destination array
 			b[j] = a[j];
 	}
@@ -307,16 +304,10 @@ inline void RadixSortLSDPowerOf2Radix_unsigned_TwoPhase_DeRandomize(unsigned lon
 
 // Stability is not needed when sorting an array of integers
 // Post-allocation adaptivity, since the size of allocation is known in advance
-inline void sort_radix_in_place_adaptive(unsigned long* src, size_t src_size, double physical_memory_threshold_post = 0.75)
+inline void sort_radix_in_place_adaptive(unsigned long* src, size_t src_size, const ParallelAlgorithms::MemoryBudget& budget)
 {
-	size_t anticipated_memory_usage = sizeof(unsigned long) * src_size + physical_memory_used_in_megabytes();
-	double physical_memory_fraction = (double)anticipated_memory_usage / (double)physical_memory_total_in_megabytes();
-	printf("sort_radix_in_place_adaptive: physical memory used = %llu   physical memory total = %llu\n",
-		physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes());
-
-	if (physical_memory_fraction > physical_memory_threshold_post)
+	if (!budget.fits(sizeof(unsigned long) * src_size))
 	{
-		printf("Running truly in-place MSD Radix Sort\n");
 		hybrid_inplace_msd_radix_sort(src, src_size);		// in-place, not stable
 	}
 	else
@@ -325,7 +316,6 @@ inline void sort_radix_in_place_adaptive(unsigned long* src, size_t src_size, do
 
 		if (!working_array)
 		{
-			printf("Running truly in-place MSD Radix Sort\n");
 			hybrid_inplace_msd_radix_sort(src, src_size);		// in-place, not stable
 		}
 		else
@@ -337,20 +327,31 @@ inline void sort_radix_in_place_adaptive(unsigned long* src, size_t src_size, do
 			//printf("sort_radix_in_place_adaptive #2: physical memory used = %llu   physical memory total = %llu\n",
 			//	physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes());
 
-			printf("Running not-in-place LSD Radix Sort\n");
 			RadixSortLSDPowerOf2Radix_unsigned_TwoPhase(src, working_array, src_size);	// not-in-place, stable
+			std::copy(working_array + 0, working_array + src_size, src);		// result is in the working array
 			delete[] working_array;
 		}
 	}
 }
 
+inline void sort_radix_in_place_adaptive(unsigned long* src, size_t src_size, double physical_memory_threshold_post = 0.75)
+{
+	sort_radix_in_place_adaptive(src, src_size, ParallelAlgorithms::system_memory_budget(physical_memory_threshold_post));
+}
+
+template< class... _Args >
+inline decltype(auto) sort_radix_in_place_adaptive(const ParallelAlgorithms::ParallelOptions& options, _Args&&... args)
+{
+	return ParallelAlgorithms::run_with_options(options, [&]() -> decltype(auto) { return ::sort_radix_in_place_adaptive(std::forward<_Args>(args)...); });
+}
+
 // l boundary is inclusive and r boundary is exclusive
 template< class _Type >
 inline void merge_sort_inplace_hybrid_with_insertion(_Type* src, size_t l, size_t r)
 {
 	if (r <= l) return;
 	if ((r - l) <= 48) {
-		insertionSortSimilarToSTLnoSelfAssignment(src + l, r - l);
+		ParallelAlgorithms::small_sort_hybrid_stable(src + l, r - l);
 		return;
 	}
 	size_t m = r / 2 + l / 2 + (r % 2 + l % 2) / 2;     // average without overflow
@@ -362,15 +363,12 @@ inline void merge_sort_inplace_hybrid_with_insertion(_Type* src, size_t l, size_
 	std::inplace_merge(src + l, src + m, src + r);
 }
 
-inline void sort_radix_in_place_stable_adaptive(unsigned long* src, size_t src_size, double physical_memory_threshold_post = 0.75)
+inline void sort_radix_in_place_stable_adaptive(unsigned long* src, size_t src_size, const ParallelAlgorithms::MemoryBudget& budget)
 {
-	size_t memory_to_be_allocated_in_megabytes = src_size * sizeof(unsigned long) / ((size_t)1024 * 1024);
-	double physical_memory_fraction = (double)(physical_memory_used_in_megabytes() + memory_to_be_allocated_in_megabytes)
-		                             / (double)physical_memory_total_in_megabytes();
-	//printf("sort_radix_in_place_adaptive: physical memory used = %llu   physical memory total = %llu   to be allocated = %llu\n",
-	//	physical_memory_used_in_megabytes(), physical_memory_total_in_megabytes(), memory_to_be_allocated_in_megabytes);
+	//printf("sort_radix_in_place_stable_adaptive: memory budget = %llu MB   to be allocated = %zu MB\n",
+	//	budget.available_bytes() / (1024 * 1024), src_size * sizeof(unsigned long) / (1024 * 1024));
 
-	if (physical_memory_fraction > physical_memory_threshold_post)
+	if (!budget.fits(src_size * sizeof(unsigned long)))
 	{
 		//printf("Running in-place stable adaptive sort\n");
 		//std::stable_sort(src + 0, src + src_size);	// problematic as it is not purely in-place algorithm, which is what is needed to keep memory footprint low
@@ -397,9 +395,15 @@ inline void sort_radix_in_place_stable_adaptive(unsigned long* src, size_t src_s
 
 			//printf("Running not-in-place LSD Radix Sort\n");
 			RadixSortLSDPowerOf2Radix_unsigned_TwoPhase(src, working_array, src_size);	// not-in-place, stable
+			std::copy(working_array + 0, working_array + src_size, src);		// result is in the working array
 			delete[] working_array;
 		}
 	}
 }
 
+inline void sort_radix_in_place_stable_adaptive(unsigned long* src, size_t src_size, double physical_memory_threshold_post = 0.75)
+{
+	sort_radix_in_place_stable_adaptive(src, src_size, ParallelAlgorithms::system_memory_budget(physical_memory_threshold_post));
+}
+
 #endif
\ No newline at end of file
@@ -3,7 +3,9 @@
 #ifndef _RadixSortLsdParallel_h
 #define _RadixSortLsdParallel_h
 
+#include "ParallelOptions.h"
 #include "InsertionSort.h"
+#include "SortingNetwork.h"
 #include "BinarySearch.h"
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
 #include "tbb/tbb.h"
@@ -25,6 +27,7 @@
 #endif
 
 #include "RadixSortLSD.h"
+#include "WorkBufferPool.h"
 
 using namespace tbb;
 
@@ -171,7 +174,7 @@ inline void RadixSortLSDPowerOf2RadixParallel_unsigned_TwoPhase(unsigned long* a
 	}
 	else {
 		// TODO: Substitute Merge Sort, as it will get rid off the for loop, since it's internal to MergeSort
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+		ParallelAlgorithms::small_sort_hybrid(a, a_size);
 		for (unsigned long j = 0; j < a_size; j++)	// copy from input array to the destination array
 			b[j] = a[j];
 	}
@@ -293,8 +296,7 @@ inline size_t** HistogramByteComponentsQCParInner(unsigned long inArray[], size_
 template< unsigned long PowerOfTwoRadix, unsigned long Log2ofPowerOfTwoRadix >
 inline size_t** HistogramByteComponentsQCPar(unsigned long* inArray, size_t l, size_t r, size_t workQuanta, size_t numberOfQuantas, unsigned long whichByte, size_t parallelThreshold = 16 * 1024)
 {
-	//may return 0 when not able to detect
-	auto processor_count = std::thread::hardware_concurrency();
+	auto processor_count = ParallelAlgorithms::small_parallel_processor_count();
 	if (processor_count < 1)
 	{
 		processor_count = 1;
@@ -420,8 +422,9 @@ inline void _RadixSortLSD_StableUnsigned_PowerOf2Radix_PermuteDerandomizedNew(
 }
 
 // This method is referenced in the Parallel LSD Radix Sort section of Practical Parallel Algorithms Book.
+// Digits below startDigit are not sorted on, for when they are already known to be in order, such as an index packed into the low bits of the key.
 template< unsigned long PowerOfTwoRadix, unsigned long Log2ofPowerOfTwoRadix >
-inline void SortRadixInnerPar(unsigned long* inputArray, unsigned long* workArray, size_t inputSize, size_t ParallelWorkQuantum = 64 * 1024)
+inline void SortRadixInnerPar(unsigned long* inputArray, unsigned long* workArray, size_t inputSize, size_t ParallelWorkQuantum = 64 * 1024, unsigned int startDigit = 0)
 {
 	//unsigned int numberOfCores = std::thread::hardware_concurrency();
 	const int NumberOfBins = PowerOfTwoRadix;
@@ -454,9 +457,9 @@ inline void SortRadixInnerPar(unsigned long* inputArray, unsigned long* workArra
 
 	// Use TPL ideas from https://docs.microsoft.com/en-us/dotnet/standard/parallel-programming/task-based-asynchronous-programming
 
-	unsigned long bitMask = 255;
-	int shiftRightAmount = 0;
-	unsigned int digit = 0;
+	unsigned long bitMask = (unsigned long)(PowerOfTwoRadix - 1) << (startDigit * Log2ofPowerOfTwoRadix);
+	int shiftRightAmount = startDigit * Log2ofPowerOfTwoRadix;
+	unsigned int digit = startDigit;
 
 	while (bitMask != 0)    // end processing digits when all the mask bits have been processed and shifted out, leaving no bits set in the bitMask
 	{
@@ -522,9 +525,8 @@ inline void SortRadixInnerPar(unsigned long* inputArray, unsigned long* workArra
 			delete[] startOfBin[q];
 		delete[] startOfBin;
 	}
-	//	if (outputArrayHasResult)
-	//		for (unsigned long current = 0; current < inputSize; current++)		// copy from output array into the input array
-	//			inputArray[current] = workArray[current];						// TODO: memcpy will most likely be faster
+	if (outputArrayHasResult)				// odd number of digits processed, leaving the result in the work array, which inputArray points to after the last swap
+		std::copy(inputArray, inputArray + inputSize, workArray);
 	//::operator delete[](bufferIndexEnd, std::align_val_t{ 64 });
 	::operator delete[](bufferIndexEnd, std::align_val_t{ 64 });
 
@@ -539,53 +541,60 @@ inline void SortRadixInnerPar(unsigned long* inputArray, unsigned long* workArra
 
 // LSD Radix Sort - stable (LSD has to be, and this may preclude LSD Radix from being able to be in-place)
 // Result is returned in "a", whereas "b" is used a temporary working buffer.
+// Histogram and permutation passes are memory-bound, and the whole sort runs on physical cores
 inline void SortRadixPar(unsigned long* a, size_t a_size, size_t parallelThreshold = 64 * 1024)
 {
 	const size_t Threshold = 100;	// Threshold of when to switch to using Insertion Sort
 	const unsigned long PowerOfTwoRadix = 256;
 	const unsigned long Log2ofPowerOfTwoRadix = 8;
 
-	unsigned long* b = new unsigned long[a_size];		// this allocation does slow things down a bit. If we want even faster, then pass "b" in as an argument
+	ParallelAlgorithms::run_kernel(ParallelAlgorithms::KernelBound::Memory, [&] {
+		// from the pool, pre-faulted in parallel by the cores that will write it, instead of page faults taken inside the sort
+		ParallelAlgorithms::WorkBuffer<unsigned long> work_buffer(a_size);
+		unsigned long* b = work_buffer.data();
+		if (!b && a_size > 0)
+			throw std::bad_alloc();
 
-	// may return 0 when not able to detect
-	auto processor_count = std::thread::hardware_concurrency();
-	//printf("Number of cores = %u \n", processor_count);
-	processor_count *= 4;									// Increase the number of cores to split array into more pieces than cores, which increases performance
+		auto processor_count = ParallelAlgorithms::small_parallel_processor_count();
+		//printf("Number of cores = %u \n", processor_count);
+		processor_count *= 4;									// Increase the number of cores to split array into more pieces than cores, which increases performance
 
-	if ((processor_count > 0) && (parallelThreshold * processor_count) < a_size)
-		parallelThreshold = a_size / processor_count;
+		if ((processor_count > 0) && (parallelThreshold * processor_count) < a_size)
+			parallelThreshold = a_size / processor_count;
 
-	// The beauty of using template arguments instead of function parameters for the Threshold and Log2ofPowerOfTwoRadix is
-	// they are not pushed on the stack and are treated as constants, but local.
-	if (a_size >= Threshold)
-		SortRadixInnerPar< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(a, b, a_size, parallelThreshold);
-	else
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
-
-	delete[] b;
+		// The beauty of using template arguments instead of function parameters for the Threshold and Log2ofPowerOfTwoRadix is
+		// they are not pushed on the stack and are treated as constants, but local.
+		if (a_size >= Threshold)
+			SortRadixInnerPar< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(a, b, a_size, parallelThreshold);
+		else
+			ParallelAlgorithms::small_sort_hybrid(a, a_size);
+	});
 }
 
 // Faster implementation, when the user is willing to provide a pre-alocated temporary/working buffer, which makes it a bit more cumbersome to use
-inline void SortRadixPar(unsigned long* a, unsigned long* tmp_work_buff, size_t a_size, size_t parallelThreshold = 512 * 1024)
+// Digits (bytes) below startDigit are skipped, when they are already in sorted order.
+// Memory-bound, as above, and run on physical cores
+inline void SortRadixPar(unsigned long* a, unsigned long* tmp_work_buff, size_t a_size, size_t parallelThreshold = 512 * 1024, unsigned int startDigit = 0)
 {
 	const size_t Threshold = 100;	// Threshold of when to switch to using Insertion Sort
 	const unsigned long PowerOfTwoRadix = 256;
 	const unsigned long Log2ofPowerOfTwoRadix = 8;
 
-	// may return 0 when not able to detect
-	auto processor_count = std::thread::hardware_concurrency();
-	//printf("Number of cores = %u \n", processor_count);
-	//processor_count = 16;
+	ParallelAlgorithms::run_kernel(ParallelAlgorithms::KernelBound::Memory, [&] {
+		auto processor_count = ParallelAlgorithms::small_parallel_processor_count();
+		//printf("Number of cores = %u \n", processor_count);
+		//processor_count = 16;
 
-	if ((processor_count > 0) && (parallelThreshold * processor_count) < a_size)
-		parallelThreshold = a_size / processor_count;
+		if ((processor_count > 0) && (parallelThreshold * processor_count) < a_size)
+			parallelThreshold = a_size / processor_count;
 
-	// The beauty of using template arguments instead of function parameters for the Threshold and Log2ofPowerOfTwoRadix is
-	// they are not pushed on the stack and are treated as constants, but local.
-	if (a_size >= Threshold)
-		SortRadixInnerPar< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(a, tmp_work_buff, a_size, parallelThreshold);
-	else
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);	// TODO: Replace with Parallel Merge Sort to use a bigger Threshold, such at parallelThreshold
+		// The beauty of using template arguments instead of function parameters for the Threshold and Log2ofPowerOfTwoRadix is
+		// they are not pushed on the stack and are treated as constants, but local.
+		if (a_size >= Threshold)
+			SortRadixInnerPar< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(a, tmp_work_buff, a_size, parallelThreshold, startDigit);
+		else
+			ParallelAlgorithms::small_sort_hybrid(a, a_size);	// TODO: Replace with Parallel Merge Sort to use a bigger Threshold, such at parallelThreshold
+	});
 }
 
 template< class _CountType >
@@ -704,10 +713,16 @@ inline void RadixSortLSDPowerOf2RadixParallel_unsigned_TwoPhase_DeRandomize(unsi
 	}
 	else {
 		// TODO: Substitute Merge Sort, as it will get rid off the for loop, since it's internal to MergeSort
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+		ParallelAlgorithms::small_sort_hybrid(a, a_size);
 		for (unsigned long j = 0; j < a_size; j++)	// copy from input array to the destination array
 			b[j] = a[j];
 	}
 }
 
+template< class... _Args >
+inline decltype(auto) SortRadixPar(const ParallelAlgorithms::ParallelOptions& options, _Args&&... args)
+{
+	return ParallelAlgorithms::run_with_options(options, [&]() -> decltype(auto) { return ::SortRadixPar(std::forward<_Args>(args)...); });
+}
+
 #endif
\ No newline at end of file
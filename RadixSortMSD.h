@@ -4,6 +4,7 @@
 
 #include "RadixSortCommon.h"
 #include "InsertionSort.h"
+#include "SortingNetwork.h"
 
 // Swap that does not check for self-assignment.
 template< class _Type >
@@ -52,7 +53,7 @@ inline void _RadixSort_Unsigned_PowerOf2Radix_L1(_Type* a, size_t a_size, _Type
 			if (numberOfElements >= Threshold)		// endOfBin actually points to one beyond the bin
 				_RadixSort_Unsigned_PowerOf2Radix_L1< _Type, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&a[startOfBin[i]], numberOfElements, bitMask, shiftRightAmount);
 			else if (numberOfElements >= 2)
-				insertionSortSimilarToSTLnoSelfAssignment(&a[startOfBin[i]], numberOfElements);
+				ParallelAlgorithms::small_sort_hybrid(&a[startOfBin[i]], numberOfElements);
 		}
 	}
 }
@@ -78,7 +79,7 @@ inline void hybrid_inplace_msd_radix_sort(unsigned long* a, size_t a_size)
 	if (a_size >= Threshold)
 		_RadixSort_Unsigned_PowerOf2Radix_L1< unsigned long, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, a_size, bitMask, shiftRightAmount);
 	else
-		insertionSortSimilarToSTLnoSelfAssignment( a, a_size );
+		ParallelAlgorithms::small_sort_hybrid( a, a_size );
 		//insertionSortHybrid(a, a_size);
 }
 
@@ -113,7 +114,7 @@ inline void _RadixSort_StableUnsigned_PowerOf2Radix_2(_Type* a, _Type* b, long l
 			if (numOfElements >= Threshold)
 				_RadixSort_StableUnsigned_PowerOf2Radix_2< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&b[startOfBin[i]], &a[startOfBin[i]], numOfElements - 1, bitMask, shiftRightAmount, inputArrayIsDestination);
 			else {
-				insertionSortSimilarToSTLnoSelfAssignment(&b[startOfBin[i]], numOfElements);
+				ParallelAlgorithms::small_sort_hybrid(&b[startOfBin[i]], numOfElements);
 				if (inputArrayIsDestination)
 					for (long j = startOfBin[i]; j < endOfBin[i]; j++)	// copy from external array back into the input array
 						a[j] = b[j];
@@ -141,7 +142,7 @@ inline void RadixSortMSDStablePowerOf2Radix_unsigned(_Type* a, _Type* b, unsigne
 	// they are not pushed on the stack and are treated as constants, but local.
 	if (a_size >= Threshold)	_RadixSort_StableUnsigned_PowerOf2Radix_2< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, b, a_size - 1, bitMask, shiftRightAmount, false);
 	else {
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+		ParallelAlgorithms::small_sort_hybrid(a, a_size);
 		for (unsigned long j = 0; j < a_size; j++)	// copy from input array to the destination array
 			b[j] = a[j];
 	}
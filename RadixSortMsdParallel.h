@@ -3,7 +3,10 @@
 #ifndef _RadixSortMsdParallel_h
 #define _RadixSortMsdParallel_h
 
+#include "ParallelOptions.h"
 #include "InsertionSort.h"
+#include "SortingNetwork.h"
+#include "SmallParallel.h"
 #include "BinarySearch.h"
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
 #include "tbb/tbb.h"
@@ -100,7 +103,7 @@ inline size_t* HistogramOneByteComponentParallel_2(unsigned long inArray[], size
 }
 
 template< unsigned long PowerOfTwoRadix, unsigned long Log2ofPowerOfTwoRadix >
-inline size_t* HistogramOneByteComponentParallel(unsigned long inArray[], size_t l, size_t r, unsigned long shiftRight, size_t parallelThreshold = 64 * 1024)
+inline size_t* HistogramOneByteComponentParallelInner(unsigned long inArray[], size_t l, size_t r, unsigned long shiftRight, size_t parallelThreshold = 64 * 1024)
 {
 	const unsigned long numberOfBins = PowerOfTwoRadix;
 
@@ -129,8 +132,8 @@ inline size_t* HistogramOneByteComponentParallel(unsigned long inArray[], size_t
 #else
 	tbb::parallel_invoke(
 #endif
-		[&] { countLeft  = HistogramOneByteComponentParallel <PowerOfTwoRadix, Log2ofPowerOfTwoRadix>(inArray, l,     m, shiftRight, parallelThreshold); },
-		[&] { countRight = HistogramOneByteComponentParallel <PowerOfTwoRadix, Log2ofPowerOfTwoRadix>(inArray, m + 1, r, shiftRight, parallelThreshold); }
+		[&] { countLeft  = HistogramOneByteComponentParallelInner <PowerOfTwoRadix, Log2ofPowerOfTwoRadix>(inArray, l,     m, shiftRight, parallelThreshold); },
+		[&] { countRight = HistogramOneByteComponentParallelInner <PowerOfTwoRadix, Log2ofPowerOfTwoRadix>(inArray, m + 1, r, shiftRight, parallelThreshold); }
 	);
 	// Combine left and right results
 	for (size_t j = 0; j < numberOfBins; j++)
@@ -141,6 +144,21 @@ inline size_t* HistogramOneByteComponentParallel(unsigned long inArray[], size_t
 	return countLeft;
 }
 
+// Small arrays are counted by a single level of parallel tasks, with counts of each on the stack, larger ones recursively
+// Returns a count array allocated with new[], which the caller deletes
+template< unsigned long PowerOfTwoRadix, unsigned long Log2ofPowerOfTwoRadix >
+inline size_t* HistogramOneByteComponentParallel(unsigned long inArray[], size_t l, size_t r, unsigned long shiftRight, size_t parallelThreshold = 64 * 1024)
+{
+	if (l > r || (r - l + 1) <= ParallelAlgorithms::SmallParallelCutoff)
+	{
+		size_t* count = new size_t[PowerOfTwoRadix]{};
+		if (l <= r)
+			ParallelAlgorithms::HistogramOneByteComponentParallelSmall(inArray, l, r + 1, shiftRight, count);
+		return count;
+	}
+	return HistogramOneByteComponentParallelInner< PowerOfTwoRadix, Log2ofPowerOfTwoRadix >(inArray, l, r, shiftRight, parallelThreshold);
+}
+
 // Simplified the implementation of the inner loop.
 template< class _Type, unsigned long PowerOfTwoRadix, unsigned long Log2ofPowerOfTwoRadix, long Threshold >
 inline void _RadixSort_Unsigned_PowerOf2Radix_Par_L1(_Type* a, size_t a_size, _Type bitMask, unsigned long shiftRightAmount)
@@ -186,7 +204,7 @@ inline void _RadixSort_Unsigned_PowerOf2Radix_Par_L1(_Type* a, size_t a_size, _T
 			if (numberOfElements >= Threshold)
 				_RadixSort_Unsigned_PowerOf2Radix_Par_L1< _Type, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&a[startOfBin[i]], numberOfElements, bitMask, shiftRightAmount);
 			else if (numberOfElements >= 2)
-				insertionSortSimilarToSTLnoSelfAssignment(&a[startOfBin[i]], numberOfElements);
+				ParallelAlgorithms::small_sort_hybrid(&a[startOfBin[i]], numberOfElements);
 		}
 #else
 		// Multi-core version of the algorithm
@@ -203,7 +221,7 @@ inline void _RadixSort_Unsigned_PowerOf2Radix_Par_L1(_Type* a, size_t a_size, _T
 					_RadixSort_Unsigned_PowerOf2Radix_Par_L1< _Type, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&a[startOfBin[i]], numberOfElements, bitMask, shiftRightAmount);
 				});
 			else if (numberOfElements >= 2)
-				insertionSortSimilarToSTLnoSelfAssignment(&a[startOfBin[i]], numberOfElements);
+				ParallelAlgorithms::small_sort_hybrid(&a[startOfBin[i]], numberOfElements);
 		}
 		g.wait();	// TODO: Change this to not wait, as it is not necessary to wait for all tasks to complete
 #endif
@@ -377,7 +395,7 @@ inline void _RadixSort_Unsigned_PowerOf2Radix_Derandomized_Par_L1(unsigned long*
 			if (numberOfElements >= Threshold)
 				_RadixSort_Unsigned_PowerOf2Radix_Derandomized_Par_L1< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&a[startOfBin[i]], numberOfElements, bitMask, shiftRightAmount);
 			else if (numberOfElements >= 2)
-				insertionSortSimilarToSTLnoSelfAssignment(&a[startOfBin[i]], numberOfElements);
+				ParallelAlgorithms::small_sort_hybrid(&a[startOfBin[i]], numberOfElements);
 		}
 #else
 		// Multi-core version of the algorithm
@@ -394,7 +412,7 @@ inline void _RadixSort_Unsigned_PowerOf2Radix_Derandomized_Par_L1(unsigned long*
 				_RadixSort_Unsigned_PowerOf2Radix_Derandomized_Par_L1< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(&a[startOfBin[i]], numberOfElements, bitMask, shiftRightAmount);
 					});
 			else if (numberOfElements >= 2)
-				insertionSortSimilarToSTLnoSelfAssignment(&a[startOfBin[i]], numberOfElements);
+				ParallelAlgorithms::small_sort_hybrid(&a[startOfBin[i]], numberOfElements);
 		}
 		g.wait();	// TODO: Change this to not wait, as it is not necessary to wait for all tasks to complete
 #endif
@@ -421,12 +439,21 @@ inline void parallel_hybrid_inplace_msd_radix_sort(unsigned long* a, size_t a_si
 
 	if (a_size >= Threshold)
 	{
-		_RadixSort_Unsigned_PowerOf2Radix_Par_L1< unsigned long, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, a_size, bitMask, shiftRightAmount);	// same speed as de-randomization on 6-core
-		//_RadixSort_Unsigned_PowerOf2Radix_Derandomized_Par_L1< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, a_size, bitMask, shiftRightAmount);
+		// histogram and in-place permutation are memory-bound, and run on physical cores
+		ParallelAlgorithms::run_kernel(ParallelAlgorithms::KernelBound::Memory, [&] {
+			_RadixSort_Unsigned_PowerOf2Radix_Par_L1< unsigned long, PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, a_size, bitMask, shiftRightAmount);	// same speed as de-randomization on 6-core
+			//_RadixSort_Unsigned_PowerOf2Radix_Derandomized_Par_L1< PowerOfTwoRadix, Log2ofPowerOfTwoRadix, Threshold >(a, a_size, bitMask, shiftRightAmount);
+		});
 	}
 	else
-		insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+		ParallelAlgorithms::small_sort_hybrid(a, a_size);
 		//insertionSortHybrid(a, a_size);
 }
 
+template< class... _Args >
+inline decltype(auto) parallel_hybrid_inplace_msd_radix_sort(const ParallelAlgorithms::ParallelOptions& options, _Args&&... args)
+{
+	return ParallelAlgorithms::run_with_options(options, [&]() -> decltype(auto) { return ::parallel_hybrid_inplace_msd_radix_sort(std::forward<_Args>(args)...); });
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "ParallelMerge.h"
+#include "ParallelRotate.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+extern void check_results(const vector<unsigned long>& reference, const vector<unsigned long>& result);
+
+// Rotations, which the in-place merges spend much of their time in, with the first block of 1/2, 1/3 and 1/100 of the array:
+// std::rotate, the three parallel reversals the in-place merges used before, and the serial and parallel rotations of ParallelRotate.h.
+// Then reversal by std::reverse and by the parallel vectorized reversal
+int RotateBenchmark(vector<unsigned long>& ulongs)
+{
+	vector<unsigned long> ulongsCopy(ulongs.size());
+	vector<unsigned long> reference(ulongs.size());
+	size_t size = ulongs.size();
+	size_t divisors[] = { 2, 3, 100 };
+	char tag[128];
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		for (size_t divisor : divisors)
+		{
+			size_t middle = size / divisor;
+			std::copy(ulongs.begin(), ulongs.end(), reference.begin());
+			std::rotate(reference.begin(), reference.begin() + middle, reference.end());
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			auto startTime = high_resolution_clock::now();
+			std::rotate(ulongsCopy.begin(), ulongsCopy.begin() + middle, ulongsCopy.end());
+			auto endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "std::rotate,                  1/%-3zu ", divisor);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(reference, ulongsCopy);
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			block_exchange_mirror_par(ulongsCopy.data(), 0, middle - 1, size - 1);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "Parallel three reversals,     1/%-3zu ", divisor);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(reference, ulongsCopy);
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::rotate_serial(ulongsCopy.data(), ulongsCopy.data() + middle, ulongsCopy.data() + size);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "rotate_serial,                1/%-3zu ", divisor);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(reference, ulongsCopy);
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			ParallelAlgorithms::rotate_par(ulongsCopy.data(), ulongsCopy.data() + middle, ulongsCopy.data() + size);
+			endTime = high_resolution_clock::now();
+			snprintf(tag, sizeof(tag), "rotate_par,                   1/%-3zu ", divisor);
+			print_results(tag, ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+			check_results(reference, ulongsCopy);
+		}
+
+		std::copy(ulongs.begin(), ulongs.end(), reference.begin());
+		std::reverse(reference.begin(), reference.end());
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		auto startTime = high_resolution_clock::now();
+		std::reverse(ulongsCopy.begin(), ulongsCopy.end());
+		auto endTime = high_resolution_clock::now();
+		print_results("std::reverse                       ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(reference, ulongsCopy);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::reverse_par(ulongsCopy.data(), size);
+		endTime = high_resolution_clock::now();
+		print_results("reverse_par                        ", ulongsCopy.data(), ulongsCopy.size(), startTime, endTime);
+		check_results(reference, ulongsCopy);
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+// Parallel Segmented Sort: sort of many independent arrays (segments) held in one flat buffer, such as a batch of small requests,
+// without the overhead of a parallel sort call and a work buffer allocation per segment
+
+#ifndef _SegmentedSort_h
+#define _SegmentedSort_h
+
+#include <stddef.h>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // Sort the segments [offsets[s], offsets[s + 1]) of data, for s = 0 .. number_of_segments-1, each independently. offsets has number_of_segments + 1 entries, non-decreasing.
+    // Consecutive segments smaller than oversizeThreshold are batched into tasks of about parallelThreshold elements, with each segment sorted serially
+    // by std::sort, which is faster than a parallel sort at these sizes. Oversize segments are sorted one at a time by Parallel Merge Sort,
+    // all using one work buffer sized for the largest, while the tasks of small segments run.
+    template< class _Type >
+    inline void sort_segments_par(_Type* data, const size_t* offsets, size_t number_of_segments, size_t oversizeThreshold = 256 * 1024, size_t parallelThreshold = 64 * 1024)
+    {
+        if (number_of_segments == 0)
+            return;
+        for (size_t s = 0; s < number_of_segments; s++)     // checked before the first task starts, so invalid offsets leave data untouched
+            if (offsets[s + 1] < offsets[s])
+                throw std::invalid_argument("segment offsets must be non-decreasing");
+        std::vector<size_t> oversize_segments;
+        size_t largest_oversize_segment = 0;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        size_t first_segment_of_batch = 0;
+        size_t elements_in_batch = 0;
+        for (size_t s = 0; s < number_of_segments; s++)
+        {
+            size_t segment_size = offsets[s + 1] - offsets[s];
+            if (segment_size >= oversizeThreshold)
+            {
+                oversize_segments.push_back(s);
+                largest_oversize_segment = std::max(largest_oversize_segment, segment_size);
+            }
+            else
+                elements_in_batch += segment_size;
+
+            bool last_segment = s + 1 == number_of_segments;
+            if (elements_in_batch >= parallelThreshold || (last_segment && elements_in_batch > 0))
+            {
+                g.run([=] {
+                    for (size_t b = first_segment_of_batch; b <= s; b++)
+                    {
+                        size_t batch_segment_size = offsets[b + 1] - offsets[b];
+                        if (batch_segment_size > 1 && batch_segment_size < oversizeThreshold)
+                            std::sort(data + offsets[b], data + offsets[b + 1]);
+                    }
+                });
+                first_segment_of_batch = s + 1;
+                elements_in_batch = 0;
+            }
+        }
+
+        if (!oversize_segments.empty())
+        {
+            std::vector<_Type> work_buffer(largest_oversize_segment);
+            for (size_t s : oversize_segments)
+                parallel_merge_sort_hybrid_rh_1(data + offsets[s], (size_t)0, offsets[s + 1] - offsets[s] - 1, work_buffer.data(), false);
+        }
+        g.wait();
+    }
+
+    template< class _Type >
+    inline void sort_segments_par(std::vector<_Type>& data, const std::vector<size_t>& offsets)
+    {
+        if (offsets.size() < 2)
+            return;
+        if (offsets.back() > data.size())
+            throw std::invalid_argument("segment offsets must be within the data");
+        sort_segments_par(data.data(), offsets.data(), offsets.size() - 1);
+    }
+
+    template< class... _Args >
+    inline decltype(auto) sort_segments_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::sort_segments_par(std::forward<_Args>(args)...); });
+    }
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <execution>
+
+#include "SortParallel.h"
+#include "SegmentedSort.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// Batch of segments of 100 to 10,000 elements each, plus one oversize segment: parallel sort per segment, serial sort per segment, and Segmented Sort
+int SegmentedSortBenchmark(vector<unsigned long>& ulongs)
+{
+	std::mt19937_64 generator(42);
+	std::uniform_int_distribution<size_t> segment_size(100, 10000);
+	vector<size_t> offsets{ 0 };
+	size_t oversize_segment = std::min(ulongs.size() / 4, (size_t)1024 * 1024);
+	offsets.push_back(oversize_segment);
+	while (offsets.back() < ulongs.size())
+		offsets.push_back(std::min(offsets.back() + segment_size(generator), ulongs.size()));
+	size_t number_of_segments = offsets.size() - 1;
+	printf("%zu segments, with the first of %zu elements\n", number_of_segments, oversize_segment);
+
+	vector<unsigned long> sorted_reference(ulongs);
+	vector<unsigned long> ulongsCopy(ulongs.size());
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		std::copy(ulongs.begin(), ulongs.end(), sorted_reference.begin());
+		auto startTime = high_resolution_clock::now();
+		for (size_t s = 0; s < number_of_segments; s++)
+			ParallelAlgorithms::sort_par(sorted_reference.data() + offsets[s], offsets[s + 1] - offsets[s]);
+		auto endTime = high_resolution_clock::now();
+		print_results("Parallel Sort per Segment", sorted_reference.data(), ulongs.size(), startTime, endTime);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		for (size_t s = 0; s < number_of_segments; s++)
+			std::sort(ulongsCopy.begin() + offsets[s], ulongsCopy.begin() + offsets[s + 1]);
+		endTime = high_resolution_clock::now();
+		print_results("std::sort per Segment    ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+
+		std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+		startTime = high_resolution_clock::now();
+		ParallelAlgorithms::sort_segments_par(ulongsCopy, offsets);
+		endTime = high_resolution_clock::now();
+		print_results("Parallel Segmented Sort  ", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+		if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+		{
+			printf("Arrays are not equal\n");
+			exit(1);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,189 @@
+// Parallelism for small arrays: a single level of parallel tasks, one per core, with per-task results in an array on the stack,
+// instead of a deep recursive tree of parallel_invoke, whose body nodes and per-node allocations dominate the run time of small arrays
+
+#ifndef _SmallParallel_h
+#define _SmallParallel_h
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <functional>
+
+#include "ParallelOptions.h"
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#endif
+
+namespace ParallelAlgorithms
+{
+    // Arrays of up to this many elements use the single-level engine. Larger arrays use the recursive algorithms
+    const size_t SmallParallelCutoff = 1024 * 1024;
+    // Upper bound on the number of tasks, which sets the size of the per-task result arrays on the stack
+    const size_t SmallParallelMaxChunks = 64;
+
+    // Number of threads of the arena (PPL scheduler) the caller runs in, which is the number of cores unless limited by ParallelOptions
+    inline size_t small_parallel_processor_count()
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        // may return 0 when not able to detect
+        static const size_t processor_count = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+        int scheduler_count = Concurrency::CurrentScheduler::Id() != -1 ? (int)Concurrency::CurrentScheduler::GetNumberOfVirtualProcessors() : -1;
+        return scheduler_count > 0 ? (size_t)scheduler_count : processor_count;
+#else
+        return (size_t)std::max(tbb::this_task_arena::max_concurrency(), 1);
+#endif
+    }
+
+    // Whether a kernel is limited by the cores or by memory bandwidth. Memory-bound kernels, such as fill, sum, histogram, radix permutation
+    // and merge, gain nothing from the second thread of a hyperthreaded core, which only contends for the same bandwidth and caches
+    enum class KernelBound { Compute, Memory };
+
+    // Memory-bound kernels run on one thread per physical core while this is true, which is the default
+    inline std::atomic<bool>& memory_bound_kernels_on_physical_cores()
+    {
+        static std::atomic<bool> enabled(true);
+        return enabled;
+    }
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+    // Arena of one thread per physical core, looked up once, after which memory-bound kernels reach it without a lock
+    inline ParallelArena& physical_core_arena()
+    {
+        static ParallelArena& arena = options_arena([] { ParallelOptions physical_cores; physical_cores.use_hyperthreads = false; return physical_cores; }());
+        return arena;
+    }
+#endif
+
+    // Runs f() as a kernel of the given kind, and returns its result. A memory-bound kernel, which is not called from within a task, nor from
+    // within an arena the caller chose through ParallelOptions, runs in the arena of one thread per physical core, when the caller's arena has
+    // more threads than that. Otherwise, as on machines without hyperthreads, f() runs directly. PPL runs f() directly
+    template< class _Function >
+    inline decltype(auto) run_kernel(KernelBound bound, _Function&& f)
+    {
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+        if (bound == KernelBound::Memory && memory_bound_kernels_on_physical_cores().load(std::memory_order_relaxed) &&
+            options_scope_depth() == 0 && tbb::task::current_context() == nullptr && small_parallel_processor_count() > physical_core_count())
+        {
+            return physical_core_arena().execute([&]() -> decltype(auto) {
+                OptionsScope kernel_scope;          // kernels nested within f() stay in this arena
+                return f();
+            });
+        }
+#endif
+        return f();
+    }
+
+    // One chunk per core, with no chunk smaller than minChunkSize
+    inline size_t small_parallel_number_of_chunks(size_t size, size_t minChunkSize)
+    {
+        size_t number_of_chunks = std::min(small_parallel_processor_count(), SmallParallelMaxChunks);
+        return std::max(std::min(number_of_chunks, size / std::max(minChunkSize, (size_t)1)), (size_t)1);
+    }
+
+    // Runs f(c, startIndex, endIndex) for chunks c = 0 .. numberOfChunks-1 of [l, r), in a single level of parallel tasks.
+    // Chunk 0 runs on the calling thread, and only numberOfChunks-1 tasks are spawned
+    template< class _Function >
+    inline void small_parallel_for_chunks(size_t l, size_t r, size_t numberOfChunks, _Function f)
+    {
+        size_t size = r - l;
+        if (numberOfChunks <= 1)
+        {
+            f((size_t)0, l, r);
+            return;
+        }
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group g;
+#else
+        tbb::task_group g;
+#endif
+        for (size_t c = 1; c < numberOfChunks; c++)
+            g.run([=, &f] { f(c, l + size * c / numberOfChunks, l + size * (c + 1) / numberOfChunks); });
+        f((size_t)0, l, l + size / numberOfChunks);
+        g.wait();
+    }
+
+    // Sum of in_array[l .. r-1], accumulated into _Sum
+    // left (l) boundary is inclusive and right (r) boundary is exclusive
+    template< class _Sum, class _Type >
+    inline _Sum SumParallelSmall(const _Type in_array[], size_t l, size_t r, size_t minChunkSize = 8 * 1024)
+    {
+        if (r <= l)
+            return (_Sum)0;
+        _Sum sum_of_chunk[SmallParallelMaxChunks];
+        size_t number_of_chunks = small_parallel_number_of_chunks(r - l, minChunkSize);
+        small_parallel_for_chunks(l, r, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            _Sum sum = 0;
+            for (size_t current = startIndex; current < endIndex; current++)
+                sum += (_Sum)in_array[current];
+            sum_of_chunk[c] = sum;
+        });
+        _Sum sum = 0;
+        for (size_t c = 0; c < number_of_chunks; c++)
+            sum += sum_of_chunk[c];
+        return sum;
+    }
+
+    // Inclusive-left and exclusive-right boundaries
+    template< class _Type >
+    inline void parallel_fill_small(_Type* src, _Type value, size_t l, size_t r, size_t minChunkSize = 16 * 1024)
+    {
+        if (r <= l)
+            return;
+        small_parallel_for_chunks(l, r, small_parallel_number_of_chunks(r - l, minChunkSize), [&](size_t, size_t startIndex, size_t endIndex) {
+            std::fill(src + startIndex, src + endIndex, value);
+        });
+    }
+
+    // Histogram of one byte (digit) of each element of inArray[l .. r-1], shifted right by shiftRight, added into count[0 .. 255].
+    // Per-chunk counts are 32-bit, on the stack of the caller, as small arrays have fewer than 2^32 elements
+    inline void HistogramOneByteComponentParallelSmall(const unsigned long inArray[], size_t l, size_t r, unsigned long shiftRight, size_t* count, size_t minChunkSize = 8 * 1024)
+    {
+        const size_t numberOfBins = 256;
+        if (r <= l)
+            return;
+        unsigned int count_of_chunk[SmallParallelMaxChunks][numberOfBins];
+        size_t number_of_chunks = small_parallel_number_of_chunks(r - l, minChunkSize);
+        small_parallel_for_chunks(l, r, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            size_t count_local[numberOfBins] = {};     // counting in a local array is faster than in count_of_chunk, which the compiler must assume is shared
+            for (size_t current = startIndex; current < endIndex; current++)
+                count_local[(inArray[current] >> shiftRight) & 0xff]++;
+            std::copy(count_local, count_local + numberOfBins, count_of_chunk[c]);
+        });
+        for (size_t c = 0; c < number_of_chunks; c++)
+            for (size_t b = 0; b < numberOfBins; b++)
+                count[b] += count_of_chunk[c][b];
+    }
+
+    // Merge path split: how many of the first k elements of the stable merge of a[0 .. a_size-1] and b[0 .. b_size-1] come from a.
+    // Equal elements are taken from a first, as std::merge does, with the order given by comp
+    template< class _Type, class _Compare >
+    inline size_t small_parallel_merge_split(const _Type* a, size_t a_size, const _Type* b, size_t b_size, size_t k, _Compare comp)
+    {
+        size_t low  = k > b_size ? k - b_size : 0;
+        size_t high = std::min(k, a_size);
+        while (low < high)
+        {
+            size_t i = low + (high - low) / 2;
+            size_t j = k - i;
+            if (j > 0 && !comp(b[j - 1], a[i]))       // a[i] <= b[j-1], so a[i] is among the first k
+                low = i + 1;
+            else
+                high = i;
+        }
+        return low;
+    }
+
+    template< class _Type >
+    inline size_t small_parallel_merge_split(const _Type* a, size_t a_size, const _Type* b, size_t b_size, size_t k)
+    {
+        return small_parallel_merge_split(a, a_size, b, b_size, k, std::less<>());
+    }
+}
+
+#endif
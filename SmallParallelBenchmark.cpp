@@ -0,0 +1,113 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <functional>
+
+#include "SumParallel.h"
+#include "SortParallel.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::micro;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+// Average time of one call, in microseconds, over enough calls to process about 64M elements. Shared with WorkBufferPoolBenchmark.cpp
+double small_parallel_time_per_call(size_t arraySize, const std::function<void()>& f)
+{
+	size_t number_of_calls = std::max((size_t)(64 * 1024 * 1024) / arraySize, (size_t)1);
+	const auto startTime = high_resolution_clock::now();
+	for (size_t c = 0; c < number_of_calls; c++)
+		f();
+	const auto endTime = high_resolution_clock::now();
+	return duration_cast<duration<double, micro>>(endTime - startTime).count() / number_of_calls;
+}
+
+// Serial, recursive parallel_invoke, and single level of parallel tasks, for arrays of 1K to 1M elements, to show where parallel beats serial
+int SmallParallelBenchmark(vector<unsigned long>& ulongs)
+{
+	const size_t smallSizes[] = { 1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+	size_t largest_size = std::min(ulongs.size(), smallSizes[5]);
+	vector<unsigned long long> u64Array(ulongs.begin(), ulongs.begin() + largest_size);
+	vector<unsigned long> ulongsCopy(largest_size);
+	vector<unsigned long> sorted_reference(largest_size);
+	vector<unsigned long> work(largest_size);
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		printf("%9s | %30s | %30s | %30s | %30s\n", "elements", "Sum: serial recursive single", "Fill: serial recursive single", "Histogram: serial recursive single", "Sort: serial recursive single");
+		for (size_t arraySize : smallSizes)
+		{
+			if (arraySize > largest_size)
+				break;
+			unsigned long long sum_ref = 0, sum_recursive = 0, sum_single = 0;
+			double sum_serial_us    = small_parallel_time_per_call(arraySize, [&] { sum_ref = ParallelAlgorithms::Sum(u64Array.data(), 0, arraySize); });
+			double sum_recursive_us = small_parallel_time_per_call(arraySize, [&] { sum_recursive = ParallelAlgorithms::SumParallelInner(u64Array.data(), 0, arraySize); });
+			double sum_single_us    = small_parallel_time_per_call(arraySize, [&] { sum_single = ParallelAlgorithms::SumParallelSmall<unsigned long long>(u64Array.data(), 0, arraySize); });
+			if (sum_recursive != sum_ref || sum_single != sum_ref)
+			{
+				printf("Sums are not equal\n");
+				exit(1);
+			}
+
+			double fill_serial_us    = small_parallel_time_per_call(arraySize, [&] { std::fill(ulongsCopy.begin(), ulongsCopy.begin() + arraySize, 42UL); });
+			double fill_recursive_us = small_parallel_time_per_call(arraySize, [&] { ParallelAlgorithms::parallel_fill_inner(ulongsCopy.data(), 42UL, 0, arraySize); });
+			double fill_single_us    = small_parallel_time_per_call(arraySize, [&] { ParallelAlgorithms::parallel_fill_small(ulongsCopy.data(), 42UL, 0, arraySize); });
+
+			size_t count_ref[256] = {}, count_single[256] = {};
+			double histogram_serial_us = small_parallel_time_per_call(arraySize, [&] {
+				std::fill(count_ref, count_ref + 256, 0);
+				for (size_t j = 0; j < arraySize; j++)
+					count_ref[ulongs[j] & 0xff]++;
+			});
+			double histogram_recursive_us = small_parallel_time_per_call(arraySize, [&] {
+				delete[] HistogramOneByteComponentParallelInner< 256, 8 >(ulongs.data(), 0, arraySize - 1, 0);
+			});
+			double histogram_single_us = small_parallel_time_per_call(arraySize, [&] {
+				std::fill(count_single, count_single + 256, 0);
+				ParallelAlgorithms::HistogramOneByteComponentParallelSmall(ulongs.data(), 0, arraySize, 0, count_single);
+			});
+			if (!std::equal(count_ref, count_ref + 256, count_single))
+			{
+				printf("Histograms are not equal\n");
+				exit(1);
+			}
+
+			// sorts time the copy of the unsorted input as well, which is the same for all three
+			double sort_serial_us = small_parallel_time_per_call(arraySize, [&] {
+				std::copy(ulongs.begin(), ulongs.begin() + arraySize, sorted_reference.begin());
+				ParallelAlgorithms::merge_sort_hybrid(sorted_reference.data(), 0, arraySize - 1, work.data(), false);
+			});
+			double sort_recursive_us = small_parallel_time_per_call(arraySize, [&] {
+				std::copy(ulongs.begin(), ulongs.begin() + arraySize, ulongsCopy.begin());
+				ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(ulongsCopy.data(), 0, arraySize - 1, work.data(), false);
+			});
+			double sort_single_us = small_parallel_time_per_call(arraySize, [&] {
+				std::copy(ulongs.begin(), ulongs.begin() + arraySize, ulongsCopy.begin());
+				ParallelAlgorithms::parallel_merge_sort_small(ulongsCopy.data(), 0, arraySize - 1, work.data(), false);
+			});
+			if (!std::equal(sorted_reference.begin(), sorted_reference.begin() + arraySize, ulongsCopy.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+
+			printf("%9zu | %9.2f %9.2f %9.2fus | %9.2f %9.2f %9.2fus | %9.2f %9.2f %9.2fus | %9.2f %9.2f %9.2fus\n", arraySize,
+				sum_serial_us,       sum_recursive_us,       sum_single_us,
+				fill_serial_us,      fill_recursive_us,      fill_single_us,
+				histogram_serial_us, histogram_recursive_us, histogram_single_us,
+				sort_serial_us,      sort_recursive_us,      sort_single_us);
+		}
+	}
+	return 0;
+}
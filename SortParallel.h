@@ -17,13 +17,204 @@
 #include <execution>
 #endif
 
+#include <type_traits>
+#include <limits>
+
 #include "ParallelMergeSort.h"
+#include "NaturalMergeSort.h"
+#include "SmallParallel.h"
+#include "WorkBufferPool.h"
+#include "MemoryBudget.h"
+#include "ParallelOptions.h"
+
+extern unsigned long long physical_memory_used_in_megabytes();
+extern unsigned long long physical_memory_total_in_megabytes();
 
 namespace ParallelAlgorithms
 {
+    // Algorithms the adaptive sort_par chooses from
+    enum class SortAlgorithm { None, MergeSort, NaturalMergeSort, LsdRadixSort, MsdRadixSort, CountingSort, StdParallelSort };
+
+    inline const char* sort_algorithm_name(SortAlgorithm algorithm)
+    {
+        switch (algorithm)
+        {
+        case SortAlgorithm::MergeSort:        return "Parallel Merge Sort";
+        case SortAlgorithm::NaturalMergeSort: return "Parallel Natural Merge Sort";
+        case SortAlgorithm::LsdRadixSort:     return "Parallel LSD Radix Sort";
+        case SortAlgorithm::MsdRadixSort:     return "Parallel In-Place MSD Radix Sort";
+        case SortAlgorithm::CountingSort:     return "Parallel Counting Sort";
+        case SortAlgorithm::StdParallelSort:  return "std::sort(par_unseq)";
+        default:                              return "none";
+        }
+    }
+
+    // What the adaptive sort_par found in a sample of its input, and which algorithm it chose
+    struct SortDecision
+    {
+        SortAlgorithm algorithm           = SortAlgorithm::None;
+        size_t        size                = 0;
+        size_t        number_of_samples   = 0;
+        double        sorted_fraction     = 0.0;    // of sampled adjacent pairs, which are in order
+        double        descending_fraction = 0.0;    // of sampled adjacent pairs, which are strictly descending
+        double        distinct_fraction   = 0.0;    // of sampled values, which are distinct
+        unsigned      key_bits            = 0;      // bits spanned by the range of sampled values, for integer types
+        bool          enough_memory       = false;  // for a work buffer the size of the input
+    };
+
+    // Decision of the last adaptive sort_par on the calling thread
+    inline SortDecision& last_sort_decision()
+    {
+        static thread_local SortDecision decision;
+        return decision;
+    }
+
+    const size_t SortSampleSize = 1024;             // adjacent pairs sampled evenly across the input
+    const size_t CountingSortMaxValues = 64 * 1024;  // integer inputs spanning at most this many values are counting sorted
+
+    // Samples src[l .. r-1], which must have at least two elements, by a single level of parallel tasks
+    template< class _Type >
+    inline void sort_par_sample(const _Type* src, size_t l, size_t r, SortDecision& decision)
+    {
+        size_t number_of_samples = std::min(SortSampleSize, r - l - 1);
+        size_t stride = (r - l - 1) / number_of_samples;
+        std::vector<_Type> samples(number_of_samples);
+        size_t in_order_of_chunk[SmallParallelMaxChunks], descending_of_chunk[SmallParallelMaxChunks];
+        size_t number_of_chunks = small_parallel_number_of_chunks(number_of_samples, 256);
+        small_parallel_for_chunks(0, number_of_samples, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            size_t in_order = 0, descending = 0;
+            for (size_t k = startIndex; k < endIndex; k++)
+            {
+                size_t i = l + k * stride;
+                samples[k] = src[i];
+                if (src[i + 1] < src[i])
+                    descending++;
+                else
+                    in_order++;
+            }
+            in_order_of_chunk[c]   = in_order;
+            descending_of_chunk[c] = descending;
+        });
+        size_t in_order = 0, descending = 0;
+        for (size_t c = 0; c < number_of_chunks; c++)
+        {
+            in_order   += in_order_of_chunk[c];
+            descending += descending_of_chunk[c];
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t number_of_distinct = std::unique(samples.begin(), samples.end(), [](const _Type& a, const _Type& b) { return !(a < b) && !(b < a); }) - samples.begin();
+
+        decision.number_of_samples   = number_of_samples;
+        decision.sorted_fraction     = (double)in_order   / number_of_samples;
+        decision.descending_fraction = (double)descending / number_of_samples;
+        decision.distinct_fraction   = (double)number_of_distinct / number_of_samples;
+        if constexpr (std::is_integral<_Type>::value)
+        {
+            typedef typename std::make_unsigned<_Type>::type _Unsigned;
+            _Unsigned range = (_Unsigned)((_Unsigned)samples[number_of_distinct - 1] - (_Unsigned)samples[0]);
+            for (decision.key_bits = 0; range != 0; range >>= 1)
+                decision.key_bits++;
+        }
+    }
+
+    const size_t SortMemoryQuerySize = 1024 * 1024;    // work buffers smaller than this many bytes always fit, without querying the system
+
+    // Whether a work buffer of buffer_size elements fits in the memory budget
+    template< class _Type >
+    inline bool sort_par_enough_memory(size_t buffer_size, const MemoryBudget& budget)
+    {
+        return budget.fits(buffer_size * sizeof(_Type));
+    }
+
+    // Whether a work buffer of buffer_size elements fits, with the physical memory in use, or the memory in use by the cgroup of the process
+    // when its limit is lower, staying below physical_memory_threshold
+    template< class _Type >
+    inline bool sort_par_enough_memory(size_t buffer_size, double physical_memory_threshold = 0.75)
+    {
+        if (buffer_size * sizeof(_Type) < SortMemoryQuerySize)
+            return true;
+        return sort_par_enough_memory<_Type>(buffer_size, system_memory_budget(physical_memory_threshold));
+    }
+
+    // Minimum and maximum of src[l .. r-1], which must not be empty
+    template< class _Type >
+    inline void min_max_par(const _Type* src, size_t l, size_t r, _Type& min_value, _Type& max_value)
+    {
+        _Type min_of_chunk[SmallParallelMaxChunks], max_of_chunk[SmallParallelMaxChunks];
+        size_t number_of_chunks = small_parallel_number_of_chunks(r - l, 64 * 1024);
+        small_parallel_for_chunks(l, r, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            auto min_max = std::minmax_element(src + startIndex, src + endIndex);
+            min_of_chunk[c] = *min_max.first;
+            max_of_chunk[c] = *min_max.second;
+        });
+        min_value = *std::min_element(min_of_chunk, min_of_chunk + number_of_chunks);
+        max_value = *std::max_element(max_of_chunk, max_of_chunk + number_of_chunks);
+    }
+
+    // Parallel Counting Sort of integers src[l .. r-1], which are all in [min_value, min_value + number_of_values).
+    // Each task counts its chunk, then each task fills its chunk of the output from the combined counts.
+    template< class _Type >
+    inline void counting_sort_range_par(_Type* src, size_t l, size_t r, _Type min_value, size_t number_of_values)
+    {
+        typedef typename std::make_unsigned<_Type>::type _Unsigned;
+        if (r <= l)
+            return;
+        // chunks at least 4 times the number of values, to keep the count arrays smaller than the input
+        size_t number_of_chunks = small_parallel_number_of_chunks(r - l, std::max((size_t)64 * 1024, 4 * number_of_values));
+        std::vector<size_t> count_of_chunk(number_of_chunks * number_of_values);
+        small_parallel_for_chunks(l, r, number_of_chunks, [&](size_t c, size_t startIndex, size_t endIndex) {
+            size_t* count = count_of_chunk.data() + c * number_of_values;
+            for (size_t i = startIndex; i < endIndex; i++)
+                count[(_Unsigned)((_Unsigned)src[i] - (_Unsigned)min_value)]++;
+        });
+        std::vector<size_t> start_of_value(number_of_values + 1);
+        for (size_t c = 1; c < number_of_chunks; c++)
+            for (size_t v = 0; v < number_of_values; v++)
+                count_of_chunk[v] += count_of_chunk[c * number_of_values + v];
+        start_of_value[0] = l;
+        for (size_t v = 0; v < number_of_values; v++)
+            start_of_value[v + 1] = start_of_value[v] + count_of_chunk[v];
+
+        small_parallel_for_chunks(l, r, small_parallel_number_of_chunks(r - l, 64 * 1024), [&](size_t, size_t startIndex, size_t endIndex) {
+            size_t v = std::upper_bound(start_of_value.begin(), start_of_value.end(), startIndex) - start_of_value.begin() - 1;
+            for (size_t i = startIndex; i < endIndex; v++)
+            {
+                size_t end_of_value = std::min(start_of_value[v + 1], endIndex);
+                std::fill(src + i, src + end_of_value, (_Type)((_Unsigned)min_value + (_Unsigned)v));
+                i = end_of_value;
+            }
+        });
+    }
+
+    // Sorts src[l .. r-1] without a work buffer. Internal to sort_par, which is the in-place interface, when a work buffer does not fit
+    template< class _Type >
+    inline void sort_par_in_place(_Type* src, size_t l, size_t r, SortDecision& decision)
+    {
+        if constexpr (std::is_same<_Type, unsigned long>::value && sizeof(unsigned long) == 4)     // MSD Radix Sort handles 32-bit keys
+        {
+            decision.algorithm = SortAlgorithm::MsdRadixSort;
+            parallel_hybrid_inplace_msd_radix_sort(src + l, r - l);
+        }
+        else
+        {
+            decision.algorithm = SortAlgorithm::StdParallelSort;
+            std::sort(std::execution::par_unseq, src + l, src + r);
+        }
+    }
+
+    // Declared ahead, since the simpler interfaces below are implemented in terms of these
+    template< class _Type > inline void sort_par(_Type* src, size_t l, size_t r);
+    template< class _Type > inline void sort_par(_Type* src, size_t l, size_t r, const MemoryBudget& budget);
+    template< class _Type > inline void sort_par(std::vector<_Type>& src, size_t l, size_t r);
+    template< class _Type > inline void sort_par(_Type* src, size_t l, size_t r, _Type* dst, size_t dst_size, bool srcToDst = false);
+
     // Sort the entire array of any data type with comparable elements
-    // Adaptive algorithm: if enough memory to allocate a temporary working buffer, then faster not-in-place parallel merge sort is used.
-    //                     if not enough memory, then the standard C++ in-place parallel sort is used, which is slower.
+    // Adaptive algorithm, which chooses by the element type, the size, the available memory, and a sample of the input:
+    //   - integers spanning a small range of values use Counting Sort
+    //   - mostly presorted or mostly descending input uses Natural Merge Sort, which merges the runs already there
+    //   - if not enough memory for a work buffer, then an in-place sort is used: MSD Radix Sort for 32-bit unsigned, otherwise the standard C++ parallel sort
+    //   - otherwise, large arrays of unsigned long use LSD Radix Sort, and everything else uses the faster not-in-place Parallel Merge Sort
+    // The decision is available from last_sort_decision()
     template< class _Type >
     inline void sort_par(_Type* src, size_t src_size)
     {
@@ -37,19 +228,86 @@ namespace ParallelAlgorithms
     }
 
     // Array bounds includes l/left, but does not include r/right
+    // The memory budget is that of the process, from the physical memory and the cgroup memory limit, taken once for the sort
     template< class _Type >
     inline void sort_par(_Type* src, size_t l, size_t r)
     {
-        size_t src_size = r;
-        _Type* sorted = new(std::nothrow) _Type[src_size];
+        size_t buffer_in_bytes = r > l ? (r - l) * sizeof(_Type) : 0;
+        if (buffer_in_bytes < SortMemoryQuerySize)
+            ParallelAlgorithms::sort_par(src, l, r, MemoryBudget(buffer_in_bytes));
+        else
+            ParallelAlgorithms::sort_par(src, l, r, system_memory_budget());
+    }
+
+    // Array bounds includes l/left, but does not include r/right
+    // A work buffer is used only when it fits in the memory budget, such as an explicit one from an application which knows its own limits
+    template< class _Type >
+    inline void sort_par(_Type* src, size_t l, size_t r, const MemoryBudget& budget)
+    {
+        SortDecision& decision = last_sort_decision();
+        decision = SortDecision{};
+        decision.size = r > l ? r - l : 0;
+        if (r <= l + 1)
+            return;
+        sort_par_sample(src, l, r, decision);
+        decision.enough_memory = sort_par_enough_memory<_Type>(r - l, budget);
+
+        if constexpr (std::is_integral<_Type>::value && !std::is_same<_Type, bool>::value)
+        {
+            typedef typename std::make_unsigned<_Type>::type _Unsigned;
+            if (sizeof(_Type) <= 2 || decision.key_bits <= 16)     // narrow range in the sample, which a scan confirms for the whole array
+            {
+                _Type min_value = std::numeric_limits<_Type>::min(), max_value = std::numeric_limits<_Type>::max();
+                if (sizeof(_Type) > 1)
+                    min_max_par(src, l, r, min_value, max_value);
+                _Unsigned range = (_Unsigned)((_Unsigned)max_value - (_Unsigned)min_value);
+                if (range < CountingSortMaxValues && (size_t)range < r - l)     // no more counts than elements
+                {
+                    decision.algorithm = SortAlgorithm::CountingSort;
+                    counting_sort_range_par(src, l, r, min_value, (size_t)range + 1);
+                    return;
+                }
+            }
+        }
+        if (!decision.enough_memory)
+        {
+            sort_par_in_place(src, l, r, decision);
+            return;
+        }
+        if (decision.sorted_fraction >= 0.9 || decision.descending_fraction >= 0.9)
+        {
+            decision.algorithm = SortAlgorithm::NaturalMergeSort;
+            try
+            {
+                parallel_natural_merge_sort(src, l, r);      // allocates its work buffer only when there are runs to merge
+            }
+            catch (std::bad_alloc&)
+            {
+                sort_par_in_place(src, l, r, decision);
+            }
+            return;
+        }
+
+        WorkBuffer<_Type> sorted(r - l);        // uninitialized and reused across calls, sized for src[l to r-1] only
 
         if (!sorted)
-            sort(std::execution::par_unseq, src + l, src + r);
+            sort_par_in_place(src, l, r, decision);
         else
         {
-            ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(src, l, r - 1, sorted, false);    // r - 1 because this algorithm wants inclusive bounds
-
-            delete[] sorted;
+            decision.algorithm = SortAlgorithm::MergeSort;
+            if constexpr (std::is_same<_Type, unsigned long>::value)
+            {
+                if ((r - l) > SmallParallelCutoff)
+                {
+                    decision.algorithm = SortAlgorithm::LsdRadixSort;
+                    SortRadixPar(src + l, sorted.data(), r - l);
+                    return;
+                }
+            }
+            if ((r - l) <= SmallParallelCutoff)
+                ParallelAlgorithms::parallel_merge_sort_small(src + l, 0, r - l - 1, sorted.data(), false);      // single level of parallel tasks
+            else
+                ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(src + l, 0, r - l - 1, sorted.data(), false);    // inclusive bounds, of src + l to use all of the buffer
         }
     }
 
@@ -57,16 +315,7 @@ namespace ParallelAlgorithms
     template< class _Type >
     inline void sort_par(std::vector<_Type>& src, size_t l, size_t r)
     {
-        try
-        {
-            size_t src_size = r;
-            std::vector<_Type> sorted(src_size);
-            ParallelAlgorithms::parallel_merge_sort_hybrid_rh_1(src.data(), l, r - 1, sorted.data(), false);    // r - 1 because this algorithm wants inclusive bounds
-        }
-        catch (std::bad_alloc& ba)
-        {
-            sort(std::execution::par_unseq, src.begin() + l, src.begin() + r);
-        }
+        ParallelAlgorithms::sort_par(src.data(), l, r);
     }
 
     // dst buffer must be the same or larger in size than the src
@@ -85,7 +334,7 @@ namespace ParallelAlgorithms
     //   -     in-place interface, where the dst buffer is a temporary work buffer
     //   - not-in-place interface, where the dst buffer is the destination memory buffer
     template< class _Type >
-    inline void sort_par(_Type* src, size_t l, size_t r, _Type* dst, size_t dst_size, bool srcToDst = false)
+    inline void sort_par(_Type* src, size_t l, size_t r, _Type* dst, size_t dst_size, bool srcToDst)
     {
         if (!dst)
             throw std::invalid_argument("dst is null, which is not supported");
@@ -93,6 +342,19 @@ namespace ParallelAlgorithms
         if (dst_size < src_size)
             throw std::invalid_argument("dst_size must be larger or equal to r, to be able to return dst[l to r-1]");
 
-        ParallelAlgorithms::parallel_merge_sort_hybrid_rh_2(src, l, r - 1, dst, srcToDst);    // r - 1 because this algorithm wants inclusive bounds
+        if (r <= l)
+            return;
+        if ((r - l) <= SmallParallelCutoff)
+            ParallelAlgorithms::parallel_merge_sort_small(src, l, r - 1, dst, srcToDst);      // single level of parallel tasks
+        else
+            ParallelAlgorithms::parallel_merge_sort_hybrid_rh_2(src, l, r - 1, dst, false, srcToDst);    // r - 1 because this algorithm wants inclusive bounds
+    }
+
+    // sort_par(options, ...) runs any of the overloads above within the arena, and on the threads, that options give.
+    // Default options run in the caller's arena
+    template< class... _Args >
+    inline decltype(auto) sort_par(const ParallelOptions& options, _Args&&... args)
+    {
+        return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::sort_par(std::forward<_Args>(args)...); });
     }
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+// Leaf and parallel thresholds of the in-place merge sorts, derived from the number of cores, the cache sizes and the element size,
+// in place of fixed thresholds which spawned parallel tasks all the way down to sub-arrays of 48 elements
+
+#ifndef _SortThresholds_h
+#define _SortThresholds_h
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#ifndef NOMINMAX
+#define NOMINMAX        // keeps std::min and std::max usable after windows.h
+#endif
+#include "windows.h"
+#else
+#include <unistd.h>
+#endif
+
+#include "SmallParallel.h"
+
+namespace ParallelAlgorithms
+{
+    const size_t DefaultL1CacheSize = 32 * 1024;       // used when the cache size can not be detected
+    const size_t DefaultL2CacheSize = 256 * 1024;
+    const size_t InplaceSortsPerCore = 4;              // serial sub-sorts per core at the bottom of the parallel recursion, for load balance
+
+    // Size in bytes of the level 1 or 2 data cache of a core, or 0 when it can not be detected
+    inline size_t detect_cache_size(unsigned level)
+    {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        DWORD length = 0;
+        GetLogicalProcessorInformation(nullptr, &length);
+        size_t count = length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+        if (count == 0)
+            return 0;
+        SYSTEM_LOGICAL_PROCESSOR_INFORMATION* info = new SYSTEM_LOGICAL_PROCESSOR_INFORMATION[count];
+        size_t size = 0;
+        if (GetLogicalProcessorInformation(info, &length))
+        {
+            for (size_t i = 0; i < count && size == 0; i++)
+                if (info[i].Relationship == RelationCache && info[i].Cache.Level == level &&
+                    (info[i].Cache.Type == CacheData || info[i].Cache.Type == CacheUnified))
+                    size = info[i].Cache.Size;
+        }
+        delete[] info;
+        return size;
+#else
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE)
+        long size = sysconf(level == 1 ? _SC_LEVEL1_DCACHE_SIZE : _SC_LEVEL2_CACHE_SIZE);
+        if (size > 0)
+            return (size_t)size;
+#endif
+        // sysconf returns 0 in some containers and on some architectures, where sysfs still has the cache description
+        for (unsigned index = 0; index < 8; index++)
+        {
+            char file_name[128], type[32] = {};
+            unsigned cache_level = 0, size_in_kb = 0;
+            snprintf(file_name, sizeof(file_name), "/sys/devices/system/cpu/cpu0/cache/index%u/level", index);
+            FILE* file = fopen(file_name, "r");
+            if (!file)
+                break;
+            bool read = fscanf(file, "%u", &cache_level) == 1;
+            fclose(file);
+            snprintf(file_name, sizeof(file_name), "/sys/devices/system/cpu/cpu0/cache/index%u/type", index);
+            if (!read || cache_level != level || !(file = fopen(file_name, "r")))
+                continue;
+            read = fscanf(file, "%31s", type) == 1;
+            fclose(file);
+            snprintf(file_name, sizeof(file_name), "/sys/devices/system/cpu/cpu0/cache/index%u/size", index);
+            if (!read || strcmp(type, "Instruction") == 0 || !(file = fopen(file_name, "r")))
+                continue;
+            read = fscanf(file, "%uK", &size_in_kb) == 1;
+            fclose(file);
+            if (read && size_in_kb > 0)
+                return (size_t)size_in_kb * 1024;
+        }
+        return 0;
+#endif
+    }
+
+    // Detected once, with the defaults when the cache sizes are not known
+    inline size_t l1_cache_size()
+    {
+        static const size_t size = detect_cache_size(1) > 0 ? detect_cache_size(1) : DefaultL1CacheSize;
+        return size;
+    }
+
+    inline size_t l2_cache_size()
+    {
+        static const size_t size = detect_cache_size(2) > 0 ? detect_cache_size(2) : DefaultL2CacheSize;
+        return size;
+    }
+
+    // Sub-arrays of up to this many elements are sorted by small_sort_hybrid_stable. For integers, the sorting networks and their merges
+    // in a stack buffer handle up to 128 elements in O(n log n). Other types use Insertion Sort, which moves O(n^2) bytes, so fewer larger
+    // elements are sorted at the leaves, keeping the leaf within a fraction of the L1 cache
+    template< class _Type >
+    inline size_t inplace_merge_sort_leaf_threshold()
+    {
+        if constexpr (std::is_integral<_Type>::value)
+            return 64;
+        else
+            return std::min(std::max(l1_cache_size() / (32 * sizeof(_Type)), (size_t)8), (size_t)48);
+    }
+
+    // Sub-arrays smaller than this many elements are sorted and merged serially. Each serial sub-sort is at least the size of the L2 cache,
+    // which amortizes the cost of its task, while there are InplaceSortsPerCore of them per core, for load balance when they take unequal time
+    template< class _Type >
+    inline size_t inplace_merge_sort_parallel_threshold(size_t size)
+    {
+        return std::max(l2_cache_size() / sizeof(_Type), size / (InplaceSortsPerCore * small_parallel_processor_count()));
+    }
+}
+
+#endif
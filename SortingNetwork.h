@@ -0,0 +1,503 @@
+// Sorting Networks for small arrays: compile-time generated networks of branchless min/max compare-exchanges for up to 32 elements,
+// and SIMD in-register networks, used in place of Insertion Sort at the leaves of the recursive sorting algorithms
+
+#ifndef _SortingNetwork_h
+#define _SortingNetwork_h
+
+#include <stddef.h>
+#include <array>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__AVX__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86_FP)
+#include <emmintrin.h>
+#endif
+
+#include "InsertionSort.h"
+#include "ProjectedCompare.h"
+
+namespace ParallelAlgorithms
+{
+    struct NetworkComparator
+    {
+        unsigned char i, j;
+    };
+
+    // Optimal networks, with the fewest compare-exchanges possible, for 2 to 8 elements
+    constexpr std::array<NetworkComparator, 1>  OptimalNetwork2 = { { {0,1} } };
+    constexpr std::array<NetworkComparator, 3>  OptimalNetwork3 = { { {0,2},{0,1},{1,2} } };
+    constexpr std::array<NetworkComparator, 5>  OptimalNetwork4 = { { {0,2},{1,3},{0,1},{2,3},{1,2} } };
+    constexpr std::array<NetworkComparator, 9>  OptimalNetwork5 = { { {0,3},{1,4},{0,2},{1,3},{0,1},{2,4},{1,2},{3,4},{2,3} } };
+    constexpr std::array<NetworkComparator, 12> OptimalNetwork6 = { { {0,5},{1,3},{2,4},{1,2},{3,4},{0,3},{2,5},{0,1},{2,3},{4,5},{1,2},{3,4} } };
+    constexpr std::array<NetworkComparator, 16> OptimalNetwork7 = { { {0,6},{2,3},{4,5},{0,2},{1,4},{3,6},{0,1},{2,5},{3,4},{1,2},{4,6},{2,3},{4,5},{1,2},{3,4},{5,6} } };
+    constexpr std::array<NetworkComparator, 19> OptimalNetwork8 = { { {0,2},{1,3},{4,6},{5,7},{0,4},{1,5},{2,6},{3,7},{0,1},{2,3},{4,5},{6,7},{2,4},{3,5},{1,4},{3,6},{1,2},{3,4},{5,6} } };
+
+    // Batcher's merge-exchange network for any number of elements (Knuth, TAOCP Vol. 3, Algorithm 5.2.2M). When comparators is null, only counts them.
+    constexpr size_t batcher_network(size_t n, NetworkComparator* comparators)
+    {
+        size_t count = 0;
+        size_t t = 0;
+        while (((size_t)1 << t) < n)
+            t++;
+        for (size_t p = t > 0 ? (size_t)1 << (t - 1) : 0; p > 0; p >>= 1)
+        {
+            size_t q = (size_t)1 << (t - 1), r = 0, d = p;
+            while (true)
+            {
+                for (size_t i = 0; i + d < n; i++)
+                {
+                    if ((i & p) == r)
+                    {
+                        if (comparators)
+                            comparators[count] = NetworkComparator{ (unsigned char)i, (unsigned char)(i + d) };
+                        count++;
+                    }
+                }
+                if (q == p)
+                    break;
+                d = q - p;
+                q >>= 1;
+                r = p;
+            }
+        }
+        return count;
+    }
+
+    template< size_t N >
+    constexpr std::array<NetworkComparator, batcher_network(N, nullptr)> make_batcher_network()
+    {
+        std::array<NetworkComparator, batcher_network(N, nullptr)> comparators{};
+        batcher_network(N, comparators.data());
+        return comparators;
+    }
+
+    template< size_t N > struct SortingNetworkOf      { static constexpr auto comparators = make_batcher_network<N>(); };
+    template<> struct SortingNetworkOf<2>              { static constexpr auto comparators = OptimalNetwork2; };
+    template<> struct SortingNetworkOf<3>              { static constexpr auto comparators = OptimalNetwork3; };
+    template<> struct SortingNetworkOf<4>              { static constexpr auto comparators = OptimalNetwork4; };
+    template<> struct SortingNetworkOf<5>              { static constexpr auto comparators = OptimalNetwork5; };
+    template<> struct SortingNetworkOf<6>              { static constexpr auto comparators = OptimalNetwork6; };
+    template<> struct SortingNetworkOf<7>              { static constexpr auto comparators = OptimalNetwork7; };
+    template<> struct SortingNetworkOf<8>              { static constexpr auto comparators = OptimalNetwork8; };
+
+    // Branchless compare-exchange, which compiles to min/max or conditional moves for arithmetic types
+    template< class _Type >
+    inline void network_compare_exchange(_Type& x, _Type& y)
+    {
+        _Type a = x, b = y;
+        x = b < a ? b : a;
+        y = b < a ? a : b;
+    }
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86_FP)
+    // Compilers branch on the shared comparison for floating-point, instead of using min/max. minsd(b, a) and maxsd(a, b) keep both values, even NaN
+    template<>
+    inline void network_compare_exchange<double>(double& x, double& y)
+    {
+        __m128d a = _mm_set_sd(x), b = _mm_set_sd(y);
+        x = _mm_cvtsd_f64(_mm_min_sd(b, a));
+        y = _mm_cvtsd_f64(_mm_max_sd(a, b));
+    }
+
+    template<>
+    inline void network_compare_exchange<float>(float& x, float& y)
+    {
+        __m128 a = _mm_set_ss(x), b = _mm_set_ss(y);
+        x = _mm_cvtss_f32(_mm_min_ss(b, a));
+        y = _mm_cvtss_f32(_mm_max_ss(a, b));
+    }
+#endif
+
+    template< class _Type, size_t N, size_t... C >
+    inline void sorting_network_apply(_Type (&v)[N], std::index_sequence<C...>)
+    {
+        (network_compare_exchange(v[SortingNetworkOf<N>::comparators[C].i], v[SortingNetworkOf<N>::comparators[C].j]), ...);
+    }
+
+    // Elements are loaded into locals, so that the fully unrolled network works in registers
+    template< class _Type, size_t N >
+    inline void sorting_network(_Type* a)
+    {
+        _Type v[N];
+        for (size_t i = 0; i < N; i++)
+            v[i] = a[i];
+        sorting_network_apply(v, std::make_index_sequence< SortingNetworkOf<N>::comparators.size() >());
+        for (size_t i = 0; i < N; i++)
+            a[i] = v[i];
+    }
+
+    template< class _Type, size_t... N >
+    inline void sorting_network_dispatch(_Type* a, size_t a_size, std::index_sequence<N...>)
+    {
+        typedef void (*NetworkFunction)(_Type*);
+        static constexpr NetworkFunction networks[] = { &sorting_network<_Type, N + 2>... };     // jump table by size
+        networks[a_size - 2](a);
+    }
+
+    // Scalar network sort of 0 to 32 elements
+    template< class _Type >
+    inline void sorting_network_scalar(_Type* a, size_t a_size)
+    {
+        if (a_size >= 2)
+            sorting_network_dispatch(a, a_size, std::make_index_sequence<31>());
+    }
+
+    // Lane partners and min/max selection of one step of the bitonic sorting network, across the lanes of a SIMD register
+    template< unsigned Lanes, unsigned J, unsigned K >
+    struct BitonicStep
+    {
+        static constexpr std::array<int, Lanes> partner()
+        {
+            std::array<int, Lanes> p{};
+            for (unsigned i = 0; i < Lanes; i++)
+                p[i] = (int)(i ^ J);
+            return p;
+        }
+        static constexpr unsigned take_min_bits()        // lane takes the min when it is the lower lane of an ascending pair, or the upper lane of a descending pair
+        {
+            unsigned bits = 0;
+            for (unsigned i = 0; i < Lanes; i++)
+                if (((i & J) == 0) == ((i & K) == 0))
+                    bits |= 1u << i;
+            return bits;
+        }
+    };
+
+    // Bitonic sort of all lanes of one SIMD register. _Ops provides Vector, Lanes, and step<J, K>(v) for one compare-exchange step
+    template< class _Ops, unsigned K = 2, unsigned J = 1 >
+    inline typename _Ops::Vector bitonic_sort_register(typename _Ops::Vector v)
+    {
+        v = _Ops::template step<J, K>(v);
+        if constexpr (J > 1)
+            return bitonic_sort_register<_Ops, K, J / 2>(v);
+        else if constexpr (K < _Ops::Lanes)
+            return bitonic_sort_register<_Ops, K * 2, K>(v);
+        else
+            return v;
+    }
+
+    // Sort of up to Lanes elements in one SIMD register, with the unused lanes padded by the largest value, which sort to the end
+    template< class _Ops >
+    inline void sorting_network_register(typename _Ops::Element* a, size_t a_size)
+    {
+        typedef typename _Ops::Element _Element;
+        alignas(64) _Element buffer[_Ops::Lanes];
+        const _Element padding = std::numeric_limits<_Element>::has_infinity ? std::numeric_limits<_Element>::infinity() : std::numeric_limits<_Element>::max();
+        for (size_t i = 0; i < _Ops::Lanes; i++)
+            buffer[i] = i < a_size ? a[i] : padding;
+        _Ops::store(buffer, bitonic_sort_register<_Ops>(_Ops::load(buffer)));
+        for (size_t i = 0; i < a_size; i++)
+            a[i] = buffer[i];
+    }
+
+#if defined(__AVX512F__)
+    struct SimdNetworkU32x16
+    {
+        typedef unsigned int Element;
+        typedef __m512i Vector;
+        static const unsigned Lanes = 16;
+        static Vector load(const Element* a)    { return _mm512_load_si512((const void*)a); }
+        static void store(Element* a, Vector v) { _mm512_store_si512((void*)a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(64) static constexpr std::array<int, Lanes> partner = BitonicStep<Lanes, J, K>::partner();
+            Vector p = _mm512_permutexvar_epi32(_mm512_load_si512((const void*)partner.data()), v);
+            return _mm512_mask_blend_epi32((__mmask16)BitonicStep<Lanes, J, K>::take_min_bits(), _mm512_max_epu32(v, p), _mm512_min_epu32(v, p));
+        }
+    };
+    struct SimdNetworkF32x16
+    {
+        typedef float Element;
+        typedef __m512 Vector;
+        static const unsigned Lanes = 16;
+        static Vector load(const Element* a)    { return _mm512_load_ps(a); }
+        static void store(Element* a, Vector v) { _mm512_store_ps(a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(64) static constexpr std::array<int, Lanes> partner = BitonicStep<Lanes, J, K>::partner();
+            Vector p = _mm512_permutexvar_ps(_mm512_load_si512((const void*)partner.data()), v);
+            return _mm512_mask_blend_ps((__mmask16)BitonicStep<Lanes, J, K>::take_min_bits(), _mm512_max_ps(v, p), _mm512_min_ps(v, p));
+        }
+    };
+    struct SimdNetworkU64x8
+    {
+        typedef unsigned long long Element;
+        typedef __m512i Vector;
+        static const unsigned Lanes = 8;
+        static Vector load(const Element* a)    { return _mm512_load_si512((const void*)a); }
+        static void store(Element* a, Vector v) { _mm512_store_si512((void*)a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(64) static constexpr std::array<long long, Lanes> partner = to_64(BitonicStep<Lanes, J, K>::partner());
+            Vector p = _mm512_permutexvar_epi64(_mm512_load_si512((const void*)partner.data()), v);
+            return _mm512_mask_blend_epi64((__mmask8)BitonicStep<Lanes, J, K>::take_min_bits(), _mm512_max_epu64(v, p), _mm512_min_epu64(v, p));
+        }
+        static constexpr std::array<long long, Lanes> to_64(std::array<int, Lanes> p)
+        {
+            std::array<long long, Lanes> p64{};
+            for (unsigned i = 0; i < Lanes; i++)
+                p64[i] = p[i];
+            return p64;
+        }
+    };
+    struct SimdNetworkF64x8
+    {
+        typedef double Element;
+        typedef __m512d Vector;
+        static const unsigned Lanes = 8;
+        static Vector load(const Element* a)    { return _mm512_load_pd(a); }
+        static void store(Element* a, Vector v) { _mm512_store_pd(a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(64) static constexpr std::array<long long, Lanes> partner = SimdNetworkU64x8::to_64(BitonicStep<Lanes, J, K>::partner());
+            Vector p = _mm512_permutexvar_pd(_mm512_load_si512((const void*)partner.data()), v);
+            return _mm512_mask_blend_pd((__mmask8)BitonicStep<Lanes, J, K>::take_min_bits(), _mm512_max_pd(v, p), _mm512_min_pd(v, p));
+        }
+    };
+#endif
+
+#if defined(__AVX2__)
+    // Lane selection mask of all ones or all zeros per lane, for the blendv instructions, from the bits of lanes that take the min
+    template< unsigned Lanes, class _MaskElement >
+    constexpr std::array<_MaskElement, Lanes> bitonic_blend_mask(unsigned take_min_bits)
+    {
+        std::array<_MaskElement, Lanes> mask{};
+        for (unsigned i = 0; i < Lanes; i++)
+            mask[i] = (take_min_bits >> i) & 1 ? (_MaskElement)-1 : 0;
+        return mask;
+    }
+
+    struct SimdNetworkU32x8
+    {
+        typedef unsigned int Element;
+        typedef __m256i Vector;
+        static const unsigned Lanes = 8;
+        static Vector load(const Element* a)    { return _mm256_load_si256((const __m256i*)a); }
+        static void store(Element* a, Vector v) { _mm256_store_si256((__m256i*)a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(32) static constexpr std::array<int, Lanes> partner = BitonicStep<Lanes, J, K>::partner();
+            alignas(32) static constexpr std::array<int, Lanes> mask = bitonic_blend_mask<Lanes, int>(BitonicStep<Lanes, J, K>::take_min_bits());
+            Vector p = _mm256_permutevar8x32_epi32(v, _mm256_load_si256((const __m256i*)partner.data()));
+            return _mm256_blendv_epi8(_mm256_max_epu32(v, p), _mm256_min_epu32(v, p), _mm256_load_si256((const __m256i*)mask.data()));
+        }
+    };
+    struct SimdNetworkF32x8
+    {
+        typedef float Element;
+        typedef __m256 Vector;
+        static const unsigned Lanes = 8;
+        static Vector load(const Element* a)    { return _mm256_load_ps(a); }
+        static void store(Element* a, Vector v) { _mm256_store_ps(a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(32) static constexpr std::array<int, Lanes> partner = BitonicStep<Lanes, J, K>::partner();
+            alignas(32) static constexpr std::array<int, Lanes> mask = bitonic_blend_mask<Lanes, int>(BitonicStep<Lanes, J, K>::take_min_bits());
+            Vector p = _mm256_permutevar8x32_ps(v, _mm256_load_si256((const __m256i*)partner.data()));
+            return _mm256_blendv_ps(_mm256_max_ps(v, p), _mm256_min_ps(v, p), _mm256_castsi256_ps(_mm256_load_si256((const __m256i*)mask.data())));
+        }
+    };
+    // 64-bit lanes are permuted as pairs of 32-bit lanes. AVX2 has no unsigned 64-bit min/max, so the signed compare is used with the sign bits flipped
+    template< unsigned Lanes, unsigned J >
+    constexpr std::array<int, 2 * Lanes> bitonic_partner_pairs()
+    {
+        std::array<int, 2 * Lanes> p{};
+        for (unsigned i = 0; i < Lanes; i++)
+        {
+            p[2 * i]     = (int)(2 * (i ^ J));
+            p[2 * i + 1] = (int)(2 * (i ^ J) + 1);
+        }
+        return p;
+    }
+    struct SimdNetworkU64x4
+    {
+        typedef unsigned long long Element;
+        typedef __m256i Vector;
+        static const unsigned Lanes = 4;
+        static Vector load(const Element* a)    { return _mm256_load_si256((const __m256i*)a); }
+        static void store(Element* a, Vector v) { _mm256_store_si256((__m256i*)a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(32) static constexpr std::array<int, 2 * Lanes> partner = bitonic_partner_pairs<Lanes, J>();
+            alignas(32) static constexpr std::array<long long, Lanes> mask = bitonic_blend_mask<Lanes, long long>(BitonicStep<Lanes, J, K>::take_min_bits());
+            Vector p = _mm256_permutevar8x32_epi32(v, _mm256_load_si256((const __m256i*)partner.data()));
+            const Vector sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+            Vector p_greater = _mm256_cmpgt_epi64(_mm256_xor_si256(p, sign), _mm256_xor_si256(v, sign));
+            Vector mn = _mm256_blendv_epi8(p, v, p_greater);
+            Vector mx = _mm256_blendv_epi8(v, p, p_greater);
+            return _mm256_blendv_epi8(mx, mn, _mm256_load_si256((const __m256i*)mask.data()));
+        }
+    };
+    struct SimdNetworkF64x4
+    {
+        typedef double Element;
+        typedef __m256d Vector;
+        static const unsigned Lanes = 4;
+        static Vector load(const Element* a)    { return _mm256_load_pd(a); }
+        static void store(Element* a, Vector v) { _mm256_store_pd(a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(32) static constexpr std::array<int, 2 * Lanes> partner = bitonic_partner_pairs<Lanes, J>();
+            alignas(32) static constexpr std::array<long long, Lanes> mask = bitonic_blend_mask<Lanes, long long>(BitonicStep<Lanes, J, K>::take_min_bits());
+            Vector p = _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(v), _mm256_load_si256((const __m256i*)partner.data())));
+            return _mm256_blendv_pd(_mm256_max_pd(v, p), _mm256_min_pd(v, p), _mm256_castsi256_pd(_mm256_load_si256((const __m256i*)mask.data())));
+        }
+    };
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+    // Lanes permuted by byte shuffle, as SSE has no variable 32-bit lane permute
+    template< unsigned J >
+    constexpr std::array<char, 16> bitonic_partner_bytes()
+    {
+        std::array<char, 16> p{};
+        for (unsigned i = 0; i < 4; i++)
+            for (unsigned b = 0; b < 4; b++)
+                p[4 * i + b] = (char)(4 * (i ^ J) + b);
+        return p;
+    }
+    struct SimdNetworkU32x4
+    {
+        typedef unsigned int Element;
+        typedef __m128i Vector;
+        static const unsigned Lanes = 4;
+        static Vector load(const Element* a)    { return _mm_load_si128((const __m128i*)a); }
+        static void store(Element* a, Vector v) { _mm_store_si128((__m128i*)a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(16) static constexpr std::array<char, 16> partner = bitonic_partner_bytes<J>();
+            alignas(16) static constexpr std::array<int, Lanes> mask = bitonic_blend_mask_sse(BitonicStep<Lanes, J, K>::take_min_bits());
+            Vector p = _mm_shuffle_epi8(v, _mm_load_si128((const __m128i*)partner.data()));
+            return _mm_blendv_epi8(_mm_max_epu32(v, p), _mm_min_epu32(v, p), _mm_load_si128((const __m128i*)mask.data()));
+        }
+        static constexpr std::array<int, Lanes> bitonic_blend_mask_sse(unsigned take_min_bits)
+        {
+            std::array<int, Lanes> mask{};
+            for (unsigned i = 0; i < Lanes; i++)
+                mask[i] = (take_min_bits >> i) & 1 ? -1 : 0;
+            return mask;
+        }
+    };
+    struct SimdNetworkF32x4
+    {
+        typedef float Element;
+        typedef __m128 Vector;
+        static const unsigned Lanes = 4;
+        static Vector load(const Element* a)    { return _mm_load_ps(a); }
+        static void store(Element* a, Vector v) { _mm_store_ps(a, v); }
+        template< unsigned J, unsigned K > static Vector step(Vector v)
+        {
+            alignas(16) static constexpr std::array<char, 16> partner = bitonic_partner_bytes<J>();
+            alignas(16) static constexpr std::array<int, Lanes> mask = SimdNetworkU32x4::bitonic_blend_mask_sse(BitonicStep<Lanes, J, K>::take_min_bits());
+            Vector p = _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(v), _mm_load_si128((const __m128i*)partner.data())));
+            return _mm_blendv_ps(_mm_max_ps(v, p), _mm_min_ps(v, p), _mm_castsi128_ps(_mm_load_si128((const __m128i*)mask.data())));
+        }
+    };
+#endif
+
+    template< class _Type >
+    inline bool network_has_nan(const _Type* a, size_t a_size)
+    {
+        bool has_nan = false;
+        for (size_t i = 0; i < a_size; i++)
+            has_nan |= a[i] != a[i];
+        return has_nan;
+    }
+
+    // Sort of 0 to 32 elements by a sorting network: in one SIMD register when the elements fit, otherwise by the scalar network.
+    // SIMD min/max swap a NaN with the value it is compared to, where the scalar network leaves both in place, so floating-point
+    // arrays with a NaN use the scalar network, for the same order with or without SIMD
+    template< class _Type >
+    inline void sorting_network_sort(_Type* a, size_t a_size)
+    {
+        [[maybe_unused]] constexpr bool is_u32 = std::is_integral<_Type>::value && std::is_unsigned<_Type>::value && sizeof(_Type) == 4;
+        [[maybe_unused]] constexpr bool is_u64 = std::is_integral<_Type>::value && std::is_unsigned<_Type>::value && sizeof(_Type) == 8;
+        [[maybe_unused]] constexpr bool is_f32 = std::is_same<_Type, float>::value;
+        [[maybe_unused]] constexpr bool is_f64 = std::is_same<_Type, double>::value;
+#if defined(__AVX512F__)
+        if constexpr (is_u32) { if (a_size <= SimdNetworkU32x16::Lanes) { sorting_network_register<SimdNetworkU32x16>((unsigned int*      )a, a_size); return; } }
+        if constexpr (is_f32) { if (a_size <= SimdNetworkF32x16::Lanes && !network_has_nan(a, a_size)) { sorting_network_register<SimdNetworkF32x16>(a, a_size); return; } }
+        if constexpr (is_u64) { if (a_size <= SimdNetworkU64x8::Lanes)  { sorting_network_register<SimdNetworkU64x8 >((unsigned long long*)a, a_size); return; } }
+        if constexpr (is_f64) { if (a_size <= SimdNetworkF64x8::Lanes  && !network_has_nan(a, a_size)) { sorting_network_register<SimdNetworkF64x8 >(a, a_size); return; } }
+#elif defined(__AVX2__)
+        if constexpr (is_u32) { if (a_size <= SimdNetworkU32x8::Lanes)  { sorting_network_register<SimdNetworkU32x8 >((unsigned int*      )a, a_size); return; } }
+        if constexpr (is_f32) { if (a_size <= SimdNetworkF32x8::Lanes  && !network_has_nan(a, a_size)) { sorting_network_register<SimdNetworkF32x8 >(a, a_size); return; } }
+        if constexpr (is_u64) { if (a_size <= SimdNetworkU64x4::Lanes)  { sorting_network_register<SimdNetworkU64x4 >((unsigned long long*)a, a_size); return; } }
+        if constexpr (is_f64) { if (a_size <= SimdNetworkF64x4::Lanes  && !network_has_nan(a, a_size)) { sorting_network_register<SimdNetworkF64x4 >(a, a_size); return; } }
+#elif defined(__SSE4_1__) || defined(__AVX__)
+        if constexpr (is_u32) { if (a_size <= SimdNetworkU32x4::Lanes)  { sorting_network_register<SimdNetworkU32x4 >((unsigned int*      )a, a_size); return; } }
+        if constexpr (is_f32) { if (a_size <= SimdNetworkF32x4::Lanes  && !network_has_nan(a, a_size)) { sorting_network_register<SimdNetworkF32x4 >(a, a_size); return; } }
+#endif
+        sorting_network_scalar(a, a_size);
+    }
+
+    // Size dispatcher, for use in place of Insertion Sort at the leaves of recursive sorting algorithms.
+    // Arithmetic types: up to 32 elements are sorted by a sorting network. Up to 128 elements are sorted in groups of 32 by sorting networks,
+    // which are then merged. Other types, and larger arrays, are sorted by Insertion Sort.
+    // Not stable, which only matters for floating-point values that compare equal but differ, such as -0.0 and +0.0
+    template< class _Type >
+    inline void small_sort_hybrid(_Type* a, size_t a_size)
+    {
+        const size_t NetworkSize = 32;
+        const size_t MergedNetworksSize = 128;
+        if constexpr (!std::is_arithmetic<_Type>::value)
+        {
+            insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+            return;
+        }
+        else
+        {
+            if (a_size <= NetworkSize)
+            {
+                sorting_network_sort(a, a_size);
+                return;
+            }
+            if (a_size > MergedNetworksSize)
+            {
+                insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+                return;
+            }
+            for (size_t i = 0; i < a_size; i += NetworkSize)
+                sorting_network_sort(a + i, std::min(NetworkSize, a_size - i));
+            _Type buffer[MergedNetworksSize];
+            _Type* src = a;
+            _Type* dst = buffer;
+            for (size_t width = NetworkSize; width < a_size; width *= 2)
+            {
+                for (size_t i = 0; i < a_size; i += 2 * width)
+                {
+                    size_t m = std::min(i + width, a_size), r = std::min(i + 2 * width, a_size);
+                    std::merge(src + i, src + m, src + m, src + r, dst + i);
+                }
+                std::swap(src, dst);
+            }
+            if (src != a)
+                std::copy(src, src + a_size, a);
+        }
+    }
+
+    // Stable size dispatcher: sorting networks only for integer types, where equal elements are indistinguishable, and Insertion Sort otherwise
+    template< class _Type >
+    inline void small_sort_hybrid_stable(_Type* a, size_t a_size)
+    {
+        if constexpr (std::is_integral<_Type>::value)
+            small_sort_hybrid(a, a_size);
+        else
+            insertionSortSimilarToSTLnoSelfAssignment(a, a_size);
+    }
+
+    // Stable size dispatcher for the order given by comp: the sorting networks for operator<, and Insertion Sort with comp otherwise
+    template< class _Type, class _Compare >
+    inline void small_sort_hybrid_stable(_Type* a, size_t a_size, _Compare comp)
+    {
+        if constexpr (is_default_less<_Compare, _Type>())
+            small_sort_hybrid_stable(a, a_size);
+        else
+            insertionSortSimilarToSTLnoSelfAssignment(a, a_size, comp);
+    }
+}
+
+#endif
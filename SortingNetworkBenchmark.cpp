@@ -0,0 +1,60 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include "SortingNetwork.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern void print_results(const char* const tag, const unsigned long* sorted, size_t sortedLength,
+	                      high_resolution_clock::time_point startTime, high_resolution_clock::time_point endTime);
+
+// The array is cut into many small arrays, as at the leaves of recursive sorting algorithms, each sorted by Insertion Sort, versus Sorting Networks
+int SortingNetworkBenchmark(vector<unsigned long>& ulongs)
+{
+	const size_t smallSizes[] = { 8, 16, 32, 49, 99 };
+	vector<unsigned long> sorted_reference(ulongs.size());
+	vector<unsigned long> ulongsCopy(ulongs.size());
+
+	for (size_t smallSize : smallSizes)
+	{
+		size_t number_of_small_arrays = ulongs.size() / smallSize;
+		printf("%zu arrays of %zu elements\n", number_of_small_arrays, smallSize);
+
+		for (int i = 0; i < iterationCount; ++i)
+		{
+			std::copy(ulongs.begin(), ulongs.end(), sorted_reference.begin());
+			auto startTime = high_resolution_clock::now();
+			for (size_t j = 0; j < number_of_small_arrays; j++)
+				insertionSortSimilarToSTLnoSelfAssignment(sorted_reference.data() + j * smallSize, smallSize);
+			auto endTime = high_resolution_clock::now();
+			print_results("Insertion Sort  ", sorted_reference.data(), ulongs.size(), startTime, endTime);
+
+			std::copy(ulongs.begin(), ulongs.end(), ulongsCopy.begin());
+			startTime = high_resolution_clock::now();
+			for (size_t j = 0; j < number_of_small_arrays; j++)
+				ParallelAlgorithms::small_sort_hybrid(ulongsCopy.data() + j * smallSize, smallSize);
+			endTime = high_resolution_clock::now();
+			print_results("Sorting Networks", ulongsCopy.data(), ulongs.size(), startTime, endTime);
+			if (!std::equal(sorted_reference.begin(), sorted_reference.end(), ulongsCopy.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,227 @@
+// TODO: Merge completed runs in the background as well, instead of merging all of them in finish()
+
+// Streaming sort, which accepts input incrementally (e.g. from a pipe or a socket), and sorts it in the background while more input arrives
+
+#ifndef _StreamingSort_h
+#define _StreamingSort_h
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <type_traits>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+#include <ppl.h>
+#else
+#include <tbb/task_group.h>
+#endif
+
+#include "ParallelMergeSort.h"
+#include "BoundedBufferMergeSort.h"
+#include "ParallelStdAlgorithms.h"
+#include "WorkBufferPool.h"
+#include "ParallelOptions.h"
+
+namespace ParallelAlgorithms
+{
+    // Push-style sort: append() input as it arrives, then finish() to get all of it sorted.
+    // Input is gathered into runs of run_size elements. Each full run is sorted by a background task, while append() goes on
+    // gathering the next run, so that sorting overlaps with ingest. finish() sorts the last partial run and merges all of the runs.
+    // unsigned long runs are sorted with LSD Radix Sort, all other types with Parallel Merge Sort, or with the stable bounded buffer
+    // Parallel Merge Sort when stable is set. The runs are merged by a stable merge, so that equal elements keep the order they were appended in.
+    // append() and finish() are meant to be called from a single producer thread. The background tasks run within the arena given by options.
+    template< class _Type >
+    class StreamingSort
+    {
+    public:
+        StreamingSort(size_t run_size = 4 * 1024 * 1024, bool stable = false, const ParallelOptions& options = ParallelOptions())
+            : m_run_size(std::max(run_size, (size_t)1)), m_stable(stable), m_size(0), m_options(options)
+        {
+            m_runs.emplace_back();
+            m_runs.back().reserve(m_run_size);
+        }
+
+        ~StreamingSort()
+        {
+            wait_for_tasks();           // background tasks reference the runs, which are about to be destroyed
+        }
+
+        void append(const _Type* chunk, size_t chunk_size)
+        {
+            while (chunk_size > 0)
+            {
+                std::vector<_Type>& run = m_runs.back();
+                size_t to_copy = std::min(chunk_size, m_run_size - run.size());
+                run.insert(run.end(), chunk, chunk + to_copy);
+                chunk      += to_copy;
+                chunk_size -= to_copy;
+                m_size     += to_copy;
+                if (run.size() == m_run_size)
+                {
+                    sort_run_in_background(run);
+                    m_runs.emplace_back();
+                    m_runs.back().reserve(m_run_size);
+                }
+            }
+        }
+
+        void append(const std::vector<_Type>& chunk)
+        {
+            append(chunk.data(), chunk.size());
+        }
+
+        // Read fixed-width elements from a stream, such as a pipe, until end of stream. A trailing partial element is discarded.
+        // Returns the number of elements read.
+        size_t append(FILE* stream, size_t read_size = 64 * 1024)
+        {
+            std::vector<_Type> chunk(read_size);
+            size_t total_read = 0;
+            size_t count;
+            while ((count = fread(chunk.data(), sizeof(_Type), chunk.size(), stream)) > 0)
+            {
+                append(chunk.data(), count);
+                total_read += count;
+            }
+            return total_read;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        // Sort what remains and merge all of the sorted runs. The StreamingSort is empty afterwards, and is ready to accept new input.
+        std::vector<_Type> finish()
+        {
+            if (m_runs.back().empty())
+                m_runs.pop_back();
+            else
+                sort_run_in_background(m_runs.back());
+            wait_for_tasks();
+
+            std::vector<_Type> sorted;
+            if (m_runs.size() == 1)
+                sorted.swap(m_runs.front());
+            else if (m_runs.size() > 1)
+                sorted = run_kernel(KernelBound::Memory, [&] { return merge_runs(); });     // copying and merging the runs are memory-bound
+
+            m_runs.clear();
+            m_size = 0;
+            m_runs.emplace_back();
+            m_runs.back().reserve(m_run_size);
+            return sorted;
+        }
+
+    private:
+        // Tasks are spawned into, and waited for within, the arena given by the options
+        template< class _Function >
+        void run_task(_Function&& f)
+        {
+            run_with_options(m_options, [&] { m_sort_tasks.run(std::forward<_Function>(f)); });
+        }
+
+        void wait_for_tasks()
+        {
+            run_with_options(m_options, [&] { m_sort_tasks.wait(); });
+        }
+
+        void sort_run_in_background(std::vector<_Type>& run)
+        {
+            std::vector<_Type>* run_ptr = &run;     // std::deque does not move its elements when growing at the end
+            bool stable = m_stable;
+            run_task([run_ptr, stable] {
+                std::vector<_Type>& a = *run_ptr;
+                if (a.size() < 2)
+                    return;
+                WorkBuffer<_Type> work_buffer(a.size());       // uninitialized and reused across runs
+                if constexpr (std::is_same<_Type, unsigned long>::value)
+                {
+                    if (work_buffer)
+                        SortRadixPar(a.data(), work_buffer.data(), a.size());
+                    else
+                        std::sort(a.begin(), a.end());          // equal integers are indistinguishable, so stability does not matter
+                }
+                else if (stable)
+                    parallel_bounded_buffer_merge_sort(a.data(), (size_t)0, a.size() - 1, work_buffer.data(), work_buffer ? a.size() : (size_t)0);
+                else if (work_buffer)
+                    parallel_merge_sort_hybrid_rh_2(a.data(), (size_t)0, a.size() - 1, work_buffer.data(), false, false);  // result in a
+                else
+                    parallel_inplace_merge_sort_hybrid(a.data(), (size_t)0, a.size() - 1);
+            });
+        }
+
+        // Merges pairs of neighboring runs in parallel, until a single run is left. The first round merges straight out of the sorted runs,
+        // freeing each pair once it is merged, and later rounds go back and forth between two arrays
+        std::vector<_Type> merge_runs()
+        {
+            size_t number_of_runs = m_runs.size();
+            std::vector<size_t> start_of_run(number_of_runs + 1, 0);
+            for (size_t i = 0; i < number_of_runs; i++)
+                start_of_run[i + 1] = start_of_run[i] + m_runs[i].size();
+
+            std::vector<_Type> dst(m_size);
+            for (size_t i = 0; i < number_of_runs; i += 2)
+            {
+                _Type* a = dst.data() + start_of_run[i];
+                std::vector<_Type>* run_0 = &m_runs[i];
+                std::vector<_Type>* run_1 = i + 1 < number_of_runs ? &m_runs[i + 1] : nullptr;      // last run without a pair is copied as is
+                run_task([a, run_0, run_1] {
+                    if (run_1)
+                        merge_parallel_ptr(run_0->data(), run_0->size(), run_1->data(), run_1->size(), a, std::less<>());
+                    else
+                        std::copy(run_0->begin(), run_0->end(), a);
+                    std::vector<_Type>().swap(*run_0);
+                    if (run_1)
+                        std::vector<_Type>().swap(*run_1);
+                });
+            }
+            wait_for_tasks();
+            std::vector<size_t> start_of_merged_run;
+            for (size_t i = 0; i < number_of_runs; i += 2)
+                start_of_merged_run.push_back(start_of_run[i]);
+            start_of_merged_run.push_back(m_size);
+            start_of_run.swap(start_of_merged_run);
+
+            std::vector<_Type> src;
+            if (start_of_run.size() > 2)
+                src.resize(m_size);
+            src.swap(dst);
+            while (start_of_run.size() > 2)         // more than one run left
+            {
+                start_of_merged_run.clear();
+                size_t number_of_runs_left = start_of_run.size() - 1;
+                for (size_t i = 0; i < number_of_runs_left; i += 2)
+                {
+                    start_of_merged_run.push_back(start_of_run[i]);
+                    _Type* t = src.data();
+                    _Type* a = dst.data();
+                    size_t l = start_of_run[i];
+                    size_t m = start_of_run[i + 1];
+                    size_t r = i + 2 <= number_of_runs_left ? start_of_run[i + 2] : m;     // last run without a pair is copied as is
+                    run_task([t, a, l, m, r] {
+                        if (r > m) merge_parallel_ptr(t + l, m - l, t + m, r - m, a + l, std::less<>());
+                        else       std::copy(t + l, t + m, a + l);
+                    });
+                }
+                wait_for_tasks();
+                start_of_merged_run.push_back(m_size);
+                start_of_run.swap(start_of_merged_run);
+                src.swap(dst);
+            }
+            return src;
+        }
+
+        size_t                           m_run_size;
+        bool                             m_stable;
+        size_t                           m_size;
+        ParallelOptions                  m_options;
+        std::deque< std::vector<_Type> > m_runs;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+        Concurrency::task_group          m_sort_tasks;
+#else
+        tbb::task_group                  m_sort_tasks;
+#endif
+    };
+}
+
+#endif
@@ -24,11 +24,10 @@
 #include <tbb/parallel_invoke.h>
 //#endif
 
-#define __TBB_PREVIEW_TASK_ARENA_CONSTRAINTS_EXTENSION_PRESENT 1
-#include <oneapi/tbb/task_arena.h>
-
 #include "RadixSortMsdParallel.h"
 #include "FillParallel.h"
+#include "SmallParallel.h"
+#include "ParallelOptions.h"
 
 using std::chrono::duration;
 using std::chrono::duration_cast;
@@ -39,7 +38,7 @@ using std::sort;
 using std::vector;
 
 
-void print_results(const char* const tag, const unsigned long long sum, size_t sum_array_length,
+inline void print_results(const char* const tag, const unsigned long long sum, size_t sum_array_length,
 	high_resolution_clock::time_point startTime,
 	high_resolution_clock::time_point endTime) {
 	printf("%s: Sum: %llu   Array Length: %llu    Time: %fms\n", tag, sum, sum_array_length,
@@ -59,7 +58,7 @@ namespace ParallelAlgorithms
 	}
 
 	// left (l) boundary is inclusive and right (r) boundary is exclusive
-	inline unsigned long long SumParallel(unsigned long long in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
+	inline unsigned long long SumParallelInner(unsigned long long in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
 	{
 		//if (((unsigned long long)(in_array + l) & 0x7) != 0)
 		//	printf("Memory alignment is not on 8-byte boundary\n");
@@ -76,8 +75,8 @@ namespace ParallelAlgorithms
 #else
 		tbb::parallel_invoke(
 #endif
-			[&] { sum_left  = SumParallel(in_array, l, m, parallelThreshold); },
-			[&] { sum_right = SumParallel(in_array, m, r, parallelThreshold); }
+			[&] { sum_left  = SumParallelInner(in_array, l, m, parallelThreshold); },
+			[&] { sum_right = SumParallelInner(in_array, m, r, parallelThreshold); }
 		);
 		// Combine left and right results
 		sum_left += sum_right;
@@ -87,7 +86,7 @@ namespace ParallelAlgorithms
 	// Sum of an arbitrary numerical type to a 64-bit sum
 	// left (l) boundary is inclusive and right (r) boundary is exclusive
 	template< class _Type >
-	inline long long SumParallel(_Type in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
+	inline long long SumParallelInner(_Type in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
 	{
 		//if (((unsigned long long)(in_array + l) & 0x7) != 0)
 		//	printf("Memory alignment is not on 8-byte boundary\n");
@@ -109,14 +108,40 @@ namespace ParallelAlgorithms
 #else
 		tbb::parallel_invoke(
 #endif
-			[&] { sum_left  = SumParallel(in_array, l, m, parallelThreshold); },
-			[&] { sum_right = SumParallel(in_array, m, r, parallelThreshold); }
+			[&] { sum_left  = SumParallelInner(in_array, l, m, parallelThreshold); },
+			[&] { sum_right = SumParallelInner(in_array, m, r, parallelThreshold); }
 		);
 		// Combine left and right results
 		sum_left += sum_right;
 
 		return sum_left;
 	}
+	// Small arrays are summed by a single level of parallel tasks, with the sum of each in an array on the stack, larger ones recursively
+	// left (l) boundary is inclusive and right (r) boundary is exclusive
+	// Memory-bound, and run on physical cores
+	inline unsigned long long SumParallel(unsigned long long in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
+	{
+		if (r <= l)
+			return 0;
+		return run_kernel(KernelBound::Memory, [&] {
+			if ((r - l) <= SmallParallelCutoff)
+				return SumParallelSmall<unsigned long long>(in_array, l, r);
+			return SumParallelInner(in_array, l, r, parallelThreshold);
+		});
+	}
+	// Sum of an arbitrary numerical type to a 64-bit sum
+	// left (l) boundary is inclusive and right (r) boundary is exclusive
+	template< class _Type >
+	inline long long SumParallel(_Type in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
+	{
+		if (r <= l)
+			return 0;
+		return run_kernel(KernelBound::Memory, [&] {
+			if ((r - l) <= SmallParallelCutoff)
+				return SumParallelSmall<long long>(in_array, l, r);
+			return SumParallelInner(in_array, l, r, parallelThreshold);
+		});
+	}
 	// Non-recursive Sum
 	// left (l) boundary is inclusive and right (r) boundary is exclusive
 	inline unsigned long long SumNonRecursive(unsigned long long in_array[], size_t l, size_t r, size_t parallelThreshold = 128 * 1024)
@@ -162,18 +187,16 @@ namespace ParallelAlgorithms
 		return sum;
 	}
 
-	// Non-recursive Parallel Sum without Hyperthreading
+	// Non-recursive Parallel Sum without Hyperthreading, in the cached arena of one thread per physical core
 	// left (l) boundary is inclusive and right (r) boundary is exclusive
 	inline unsigned long long SumParallelNonRecursiveNoHyperthreading(unsigned long long in_array[], size_t l, size_t r, size_t parallelThreshold = 16 * 1024)
 	{
 		size_t num_tasks = (r - l + (parallelThreshold - 1)) / parallelThreshold;
 		unsigned long long* sum_array = new unsigned long long[num_tasks] {};
 
-		int no_ht_concurrency = tbb::info::default_concurrency(
-			tbb::task_arena::constraints{}.set_max_threads_per_core(1)
-		);
-		tbb::task_arena arena(no_ht_concurrency);
-		arena.execute([=] {
+		ParallelOptions physical_cores;
+		physical_cores.use_hyperthreads = false;
+		run_with_options(physical_cores, [=] {
 			tbb::task_group g;
 			size_t i = 0;
 			for (; i < (num_tasks - 1); i++)
@@ -191,6 +214,13 @@ namespace ParallelAlgorithms
 		delete[] sum_array;
 		return sum;
 	}
+
+	// Sum using the threads given by options, such as one per physical core
+	template< class... _Args >
+	inline decltype(auto) SumParallel(const ParallelOptions& options, _Args&&... args)
+	{
+		return run_with_options(options, [&]() -> decltype(auto) { return ParallelAlgorithms::SumParallel(std::forward<_Args>(args)...); });
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,296 @@
+// Pool of work buffers for the not-in-place sorts: uninitialized, 64-byte aligned storage, which is kept after use and handed out again,
+// so repeated sorts do not pay for the allocation, the page faults and the value-initialization of a new buffer on every call.
+// New buffers are pre-faulted in parallel, or populated by the kernel, instead of being faulted in page by page inside the sort.
+
+#ifndef _WorkBufferPool_h
+#define _WorkBufferPool_h
+
+#include <stddef.h>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+#include <sys/mman.h>
+#endif
+
+#include "SmallParallel.h"
+#include "HugePages.h"
+
+namespace ParallelAlgorithms
+{
+    const size_t WorkBufferAlignment = 64;      // cache line
+    const size_t WorkBufferPageSize  = 4096;
+
+    // How the pages of a new buffer are faulted in before it is handed out:
+    //   None     - on first use, inside the algorithm, which is serial for the parts of the algorithms that are serial
+    //   Touch    - one byte of each page written by a single level of parallel tasks, one contiguous chunk per core, the same split the parallel
+    //              algorithms use, so that on NUMA systems first-touch places each part of the buffer on the node of the core that will use it
+    //   Populate - mmap with MAP_POPULATE on Linux, where the kernel maps all of the pages at allocation without taking page faults,
+    //              all on the node of the calling thread. Touch elsewhere
+    enum class Prefault { None, Touch, Populate };
+
+    // Faults in the pages of buffer[0 .. size_in_bytes-1] by writing one byte of each, by a single level of parallel tasks.
+    // Usable on buffers from anywhere, such as the input of a sort that has just been allocated and not yet been written
+    inline void prefault_par(void* buffer, size_t size_in_bytes)
+    {
+        unsigned char* bytes = (unsigned char*)buffer;
+        size_t number_of_pages = (size_in_bytes + WorkBufferPageSize - 1) / WorkBufferPageSize;
+        small_parallel_for_chunks(0, number_of_pages, small_parallel_number_of_chunks(number_of_pages, 256), [&](size_t, size_t startPage, size_t endPage) {
+            for (size_t p = startPage; p < endPage; p++)
+                bytes[p * WorkBufferPageSize] = 0;
+        });
+    }
+
+    // Thread-safe cache of aligned, uninitialized blocks. A request is served by the smallest free block that fits and is no more than
+    // twice the size requested, or by a new allocation. Released blocks are kept while the free blocks total no more than max_cached_bytes.
+    // New blocks of at least huge_pages_min_bytes are backed by huge pages, when set_huge_pages() has turned them on.
+    class WorkBufferPool
+    {
+    public:
+        WorkBufferPool(size_t max_cached_bytes = (size_t)1024 * 1024 * 1024)
+            : m_max_cached_bytes(max_cached_bytes), m_cached_bytes(0), m_huge_pages(HugePages::None), m_huge_pages_min_bytes(0)
+        {}
+
+        ~WorkBufferPool()
+        {
+            trim();
+        }
+
+        WorkBufferPool(const WorkBufferPool&) = delete;
+        WorkBufferPool& operator=(const WorkBufferPool&) = delete;
+
+        // Storage of at least size_in_bytes, or nullptr when it can not be allocated. A new allocation is pre-faulted by the prefault method
+        void* acquire(size_t size_in_bytes, Prefault prefault = Prefault::Touch)
+        {
+            size_in_bytes = std::max((size_in_bytes + WorkBufferAlignment - 1) / WorkBufferAlignment * WorkBufferAlignment, WorkBufferAlignment);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                size_t best = m_free_blocks.size();
+                for (size_t b = 0; b < m_free_blocks.size(); b++)
+                    if (m_free_blocks[b].capacity >= size_in_bytes && m_free_blocks[b].capacity / 2 <= size_in_bytes &&
+                        (best == m_free_blocks.size() || m_free_blocks[b].capacity < m_free_blocks[best].capacity))
+                        best = b;
+                if (best < m_free_blocks.size())
+                {
+                    Block block = m_free_blocks[best];
+                    m_free_blocks.erase(m_free_blocks.begin() + best);
+                    m_cached_bytes -= block.capacity;
+                    m_used_blocks.push_back(block);
+                    return block.data;
+                }
+            }
+            HugePages huge_pages;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                huge_pages = size_in_bytes >= m_huge_pages_min_bytes ? m_huge_pages : HugePages::None;
+            }
+            Block block = allocate(size_in_bytes, prefault, huge_pages);
+            if (!block.data)
+            {
+                trim();                 // the cached blocks may be what is in the way
+                block = allocate(size_in_bytes, prefault, huge_pages);
+                if (!block.data)
+                    return nullptr;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_used_blocks.push_back(block);
+            return block.data;
+        }
+
+        // Returns storage from acquire() to the pool
+        void release(void* data)
+        {
+            if (!data)
+                return;
+            std::vector<Block> to_free;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (size_t b = 0; b < m_used_blocks.size(); b++)
+                {
+                    if (m_used_blocks[b].data == data)
+                    {
+                        m_free_blocks.push_back(m_used_blocks[b]);
+                        m_cached_bytes += m_used_blocks[b].capacity;
+                        m_used_blocks.erase(m_used_blocks.begin() + b);
+                        break;
+                    }
+                }
+                evict(to_free);
+            }
+            free_blocks(to_free);
+        }
+
+        // Frees all of the free blocks
+        void trim()
+        {
+            std::vector<Block> to_free;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                to_free.swap(m_free_blocks);
+                m_cached_bytes = 0;
+            }
+            free_blocks(to_free);
+        }
+
+        // 0 turns caching off, with each block freed on release
+        void set_max_cached_bytes(size_t max_cached_bytes)
+        {
+            std::vector<Block> to_free;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_max_cached_bytes = max_cached_bytes;
+                evict(to_free);
+            }
+            free_blocks(to_free);
+        }
+
+        size_t cached_bytes()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_cached_bytes;
+        }
+
+        // Huge pages for new blocks of at least min_bytes, such as the work buffers of large sorts. Smaller ones gain little, as they need few TLB entries
+        void set_huge_pages(HugePages hugePages, size_t min_bytes = 16 * HugePageSize)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_huge_pages = hugePages;
+            m_huge_pages_min_bytes = min_bytes;
+        }
+
+    private:
+        enum class BlockMemory { New, Mapped, HugePages };
+
+        struct Block
+        {
+            void*       data;
+            size_t      capacity;       // in bytes
+            BlockMemory memory;         // how it was allocated, which is how it is freed
+        };
+
+        static Block allocate(size_t size_in_bytes, Prefault prefault, HugePages hugePages)
+        {
+            if (hugePages != HugePages::None)
+            {
+                void* data = huge_pages_allocate(size_in_bytes, hugePages);
+                if (data && prefault != Prefault::None)
+                    prefault_par(data, size_in_bytes);     // faults in a whole huge page at a time
+                return Block{ data, size_in_bytes, BlockMemory::HugePages };
+            }
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)) && defined(MAP_POPULATE)
+            if (prefault == Prefault::Populate)
+            {
+                void* data = mmap(nullptr, size_in_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+                if (data == MAP_FAILED)
+                    return Block{ nullptr, 0, BlockMemory::Mapped };
+                return Block{ data, size_in_bytes, BlockMemory::Mapped };
+            }
+#endif
+            void* data = ::operator new(size_in_bytes, std::align_val_t(WorkBufferAlignment), std::nothrow);
+            if (data && prefault != Prefault::None)
+                prefault_par(data, size_in_bytes);
+            return Block{ data, size_in_bytes, BlockMemory::New };
+        }
+
+        // Largest free blocks first, until within m_max_cached_bytes. Called with m_mutex held, and the blocks are freed after it is released
+        void evict(std::vector<Block>& to_free)
+        {
+            while (m_cached_bytes > m_max_cached_bytes)
+            {
+                size_t largest = 0;
+                for (size_t b = 1; b < m_free_blocks.size(); b++)
+                    if (m_free_blocks[b].capacity > m_free_blocks[largest].capacity)
+                        largest = b;
+                to_free.push_back(m_free_blocks[largest]);
+                m_cached_bytes -= m_free_blocks[largest].capacity;
+                m_free_blocks.erase(m_free_blocks.begin() + largest);
+            }
+        }
+
+        static void free_blocks(const std::vector<Block>& blocks)
+        {
+            for (const Block& block : blocks)
+            {
+                if (block.memory == BlockMemory::HugePages)
+                    huge_pages_free(block.data, block.capacity);
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__))
+                else if (block.memory == BlockMemory::Mapped)
+                    munmap(block.data, block.capacity);
+#endif
+                else
+                    ::operator delete(block.data, std::align_val_t(WorkBufferAlignment));
+            }
+        }
+
+        std::mutex         m_mutex;
+        std::vector<Block> m_free_blocks;
+        std::vector<Block> m_used_blocks;
+        size_t             m_max_cached_bytes;
+        size_t             m_cached_bytes;     // total capacity of m_free_blocks
+        HugePages          m_huge_pages;
+        size_t             m_huge_pages_min_bytes;
+    };
+
+    // The pool shared by all of the algorithms
+    inline WorkBufferPool& work_buffer_pool()
+    {
+        static WorkBufferPool pool;
+        return pool;
+    }
+
+    // Work buffer of size elements from the pool, returned to it on destruction. Elements of trivial types are left uninitialized,
+    // and other types are default-constructed. data() is nullptr when the storage can not be allocated.
+    template< class _Type >
+    class WorkBuffer
+    {
+    public:
+        explicit WorkBuffer(size_t size, Prefault prefault = Prefault::Touch, WorkBufferPool& pool = work_buffer_pool())
+            : m_pool(pool), m_size(size), m_data(nullptr)
+        {
+            static_assert(alignof(_Type) <= WorkBufferAlignment, "work buffer alignment is too small for the type");
+            if (size == 0 || size > (size_t)-1 / sizeof(_Type))
+                return;
+            m_data = (_Type*)m_pool.acquire(size * sizeof(_Type), prefault);
+            if constexpr (!std::is_trivial<_Type>::value)
+            {
+                if (m_data)
+                {
+                    try
+                    {
+                        std::uninitialized_default_construct_n(m_data, size);
+                    }
+                    catch (...)
+                    {
+                        m_pool.release(m_data);
+                        throw;
+                    }
+                }
+            }
+        }
+
+        ~WorkBuffer()
+        {
+            if (!m_data)
+                return;
+            if constexpr (!std::is_trivially_destructible<_Type>::value)
+                std::destroy_n(m_data, m_size);
+            m_pool.release(m_data);
+        }
+
+        WorkBuffer(const WorkBuffer&) = delete;
+        WorkBuffer& operator=(const WorkBuffer&) = delete;
+
+        _Type* data() const             { return m_data; }
+        size_t size() const             { return m_size; }
+        explicit operator bool() const  { return m_data != nullptr; }
+
+    private:
+        WorkBufferPool& m_pool;
+        size_t          m_size;
+        _Type*          m_data;
+    };
+}
+
+#endif
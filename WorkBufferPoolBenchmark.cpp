@@ -0,0 +1,79 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <ratio>
+#include <vector>
+#include <functional>
+
+#include "WorkBufferPool.h"
+#include "SortParallel.h"
+
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::high_resolution_clock;
+using std::milli;
+using std::random_device;
+using std::sort;
+using std::vector;
+
+const int iterationCount = 5;
+
+extern double small_parallel_time_per_call(size_t arraySize, const std::function<void()>& f);
+
+// Repeated Parallel Merge Sort of small arrays, as sort_par does, with the work buffer from the pool, where it is reused across calls, with caching
+// in the pool turned off, where each call allocates and page-faults a new buffer, and with a value-initialized buffer from new[], as sort_par used to
+int WorkBufferPoolBenchmark(vector<unsigned long>& ulongs)
+{
+	const size_t smallSizes[] = { 1024, 4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+	size_t largest_size = std::min(ulongs.size(), smallSizes[5]);
+	vector<unsigned long> ulongsCopy(largest_size);
+	vector<unsigned long> sorted_reference(largest_size);
+	ParallelAlgorithms::WorkBufferPool& pool = ParallelAlgorithms::work_buffer_pool();
+
+	for (int i = 0; i < iterationCount; ++i)
+	{
+		printf("%9s | %12s %12s %12s\n", "elements", "pooled", "not cached", "new[]");
+		for (size_t arraySize : smallSizes)
+		{
+			if (arraySize > largest_size)
+				break;
+			std::copy(ulongs.begin(), ulongs.begin() + arraySize, sorted_reference.begin());
+			sort(sorted_reference.begin(), sorted_reference.begin() + arraySize);
+
+			// sorts time the copy of the unsorted input as well, which is the same for all three
+			double pooled_us = small_parallel_time_per_call(arraySize, [&] {
+				std::copy(ulongs.begin(), ulongs.begin() + arraySize, ulongsCopy.begin());
+				ParallelAlgorithms::WorkBuffer<unsigned long> work(arraySize);
+				ParallelAlgorithms::parallel_merge_sort_small(ulongsCopy.data(), 0, arraySize - 1, work.data(), false);
+			});
+			pool.set_max_cached_bytes(0);
+			double not_cached_us = small_parallel_time_per_call(arraySize, [&] {
+				std::copy(ulongs.begin(), ulongs.begin() + arraySize, ulongsCopy.begin());
+				ParallelAlgorithms::WorkBuffer<unsigned long> work(arraySize);
+				ParallelAlgorithms::parallel_merge_sort_small(ulongsCopy.data(), 0, arraySize - 1, work.data(), false);
+			});
+			pool.set_max_cached_bytes((size_t)1024 * 1024 * 1024);
+			if (!std::equal(sorted_reference.begin(), sorted_reference.begin() + arraySize, ulongsCopy.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+			double new_us = small_parallel_time_per_call(arraySize, [&] {
+				std::copy(ulongs.begin(), ulongs.begin() + arraySize, ulongsCopy.begin());
+				unsigned long* work = new unsigned long[arraySize]();
+				ParallelAlgorithms::parallel_merge_sort_small(ulongsCopy.data(), 0, arraySize - 1, work, false);
+				delete[] work;
+			});
+			if (!std::equal(sorted_reference.begin(), sorted_reference.begin() + arraySize, ulongsCopy.begin()))
+			{
+				printf("Arrays are not equal\n");
+				exit(1);
+			}
+			printf("%9zu | %10.2fus %10.2fus %10.2fus\n", arraySize, pooled_us, not_cached_us, new_us);
+		}
+	}
+	return 0;
+}